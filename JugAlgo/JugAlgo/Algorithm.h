@@ -5,12 +5,16 @@
 #include <type_traits>
 
 #include <algorithms/algorithm.h>
+#include <algorithms/random.h>
 #include <algorithms/type_traits.h>
 
 #include <GaudiAlg/GaudiAlgorithm.h>
+#include <GaudiKernel/EventContext.h>
 #include <GaudiKernel/Service.h>
 #include <JugAlgo/IAlgoServiceSvc.h>
+#include <JugAlgo/detail/InputEntry.h>
 #include <JugAlgo/detail/DataProxy.h>
+#include <JugAlgo/detail/PropertyProxy.h>
 
 #define JUGALGO_DEFINE_ALGORITHM(algorithm, impl, ns)                                              \
   using algorithm##Base = Jug::Algo::Algorithm<impl>;                                              \
@@ -35,9 +39,8 @@ public:
       : GaudiAlgorithm(name, svcLoc)
       , m_algo{name}
       , m_output{this, m_algo.outputNames()}
-      , m_input{this, m_algo.inputNames()} {
-    defineProperties();
-  }
+      , m_input{this, m_algo.inputNames()}
+      , m_props{this, m_algo} {}
 
   StatusCode initialize() override {
     debug() << "Initializing " << name() << endmsg;
@@ -51,6 +54,9 @@ public:
         return StatusCode::FAILURE;
       }
 
+      // Input entries of the events, for the random streams
+      m_entry.init(evtSvc());
+
       // Forward the log level of this algorithm
       const algorithms::LogLevel level{
           static_cast<algorithms::LogLevel>(msgLevel() > 0 ? msgLevel() - 1 : 0)};
@@ -64,7 +70,7 @@ public:
 
       // configure properties
       debug() << "Configuring properties" << endmsg;
-      initProperties();
+      m_props.apply(m_algo);
 
       // validate properties
       debug() << "Validating properties" << endmsg;
@@ -82,6 +88,9 @@ public:
 
   StatusCode execute() override {
     try {
+      // Key the counter-based random streams to the input entry of the current event
+      const EventContext& ctx = getContext();
+      algorithms::RandomSvc::context({ctx.eventID().run_number(), m_entry(ctx)});
       m_algo.process(m_input.get(), m_output.get());
     } catch (const std::exception& e) {
       error() << e.what() << endmsg;
@@ -100,38 +109,12 @@ protected:
   bool hasAlgoProp(std::string_view name) const { return m_algo.hasProperty(name); }
 
 private:
-  // to be called during construction (before init())
-  void defineProperties() {
-    for (const auto& [key, prop] : m_algo.getProperties()) {
-      std::visit(
-          [this, key = key](auto&& val) {
-            using T = std::decay_t<decltype(val)>;
-            this->m_props.emplace(
-                key, std::make_unique<Gaudi::Property<T>>(this, std::string(key), val));
-          },
-          prop.get());
-    }
-  }
-
-  // to be called during init() --> will actually set the underlying alo properties
-  void initProperties() {
-    for (const auto& [key, prop] : m_algo.getProperties()) {
-      std::visit(
-          [this, key = key](auto&& val) {
-            using T                = std::decay_t<decltype(val)>;
-            const auto* gaudi_prop = static_cast<Gaudi::Property<T>*>(this->m_props.at(key).get());
-            const auto prop_val    = gaudi_prop->value();
-            this->m_algo.setProperty(key, prop_val);
-          },
-          prop.get());
-    }
-  }
-
   algo_type m_algo;
   SmartIF<IAlgoServiceSvc> m_algo_svc;
+  detail::InputEntry m_entry;
   detail::DataProxy<output_type> m_output;
   detail::DataProxy<input_type> m_input;
-  std::map<std::string_view, std::unique_ptr<Gaudi::Details::PropertyBase>> m_props;
+  detail::PropertyProxy m_props;
 };
 
 } // namespace Jug::Algo
@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Sylvester Joosten
+
+// Reentrant counterpart of Jug::Algo::Algorithm, based on Gaudi::Algorithm instead of the
+// legacy GaudiAlgorithm. A single instance is shared by all event slots when running with
+// the AvalancheScheduler (Gaudi Hive): execute() is const, and all per-event state (input
+// pointers, newly created output collections) lives on the stack of the calling thread.
+// This relies on algorithms::Algorithm::process() being const and free of side effects.
+//
+// Note that the rest of the job (event data service, input and output) needs to support
+// multiple events in flight as well for this to be useful.
+#pragma once
+
+#include <string>
+#include <type_traits>
+
+#include <algorithms/algorithm.h>
+#include <algorithms/random.h>
+#include <algorithms/type_traits.h>
+
+#include <Gaudi/Algorithm.h>
+#include <GaudiKernel/EventContext.h>
+#include <GaudiKernel/Service.h>
+#include <JugAlgo/IAlgoServiceSvc.h>
+#include <JugAlgo/detail/InputEntry.h>
+#include <JugAlgo/detail/PropertyProxy.h>
+#include <JugAlgo/detail/ReentrantDataProxy.h>
+
+#define JUGALGO_DEFINE_REENTRANT_ALGORITHM(algorithm, impl, ns)                                    \
+  using algorithm##Base = Jug::Algo::ReentrantAlgorithm<impl>;                                     \
+  namespace ns {                                                                                   \
+  struct algorithm : algorithm##Base {                                                             \
+    algorithm(const std::string& name, ISvcLocator* svcLoc) : algorithm##Base(name, svcLoc) {}     \
+  };                                                                                               \
+  DECLARE_COMPONENT(algorithm)                                                                     \
+  }
+
+namespace Jug::Algo {
+
+template <class AlgoImpl> class ReentrantAlgorithm : public Gaudi::Algorithm {
+public:
+  using algo_type   = AlgoImpl;
+  using input_type  = typename algo_type::input_type;
+  using output_type = typename algo_type::output_type;
+  using Input       = typename algo_type::Input;
+  using Output      = typename algo_type::Output;
+
+  ReentrantAlgorithm(const std::string& name, ISvcLocator* svcLoc)
+      : Gaudi::Algorithm(name, svcLoc)
+      , m_algo{name}
+      , m_output{this, m_algo.outputNames()}
+      , m_input{this, m_algo.inputNames()}
+      , m_props{this, m_algo} {}
+
+  StatusCode initialize() override {
+    StatusCode sc = Gaudi::Algorithm::initialize();
+    if (sc.isFailure()) {
+      return sc;
+    }
+    debug() << "Initializing " << name() << endmsg;
+
+    // Algorithms uses exceptions, Gaudi uses StatusCode --> catch and propagate
+    try {
+      // Grab the AlgoServiceSvc
+      m_algo_svc = service("AlgoServiceSvc");
+      if (!m_algo_svc) {
+        error() << "Unable to get an instance of the AlgoServiceSvc" << endmsg;
+        return StatusCode::FAILURE;
+      }
+
+      // Input entries of the events, for the random streams
+      m_entry.init(evtSvc());
+
+      // Forward the log level of this algorithm
+      const algorithms::LogLevel level{
+          static_cast<algorithms::LogLevel>(msgLevel() > 0 ? msgLevel() - 1 : 0)};
+      debug() << "Setting the logger level to " << algorithms::logLevelName(level) << endmsg;
+      m_algo.level(level);
+
+      // Init our data structures (declares the data dependencies for the scheduler)
+      debug() << "Initializing data structures" << endmsg;
+      m_input.init();
+      m_output.init();
+
+      // configure properties
+      debug() << "Configuring properties" << endmsg;
+      m_props.apply(m_algo);
+
+      // validate properties
+      debug() << "Validating properties" << endmsg;
+      m_algo.validate();
+
+      // call the internal algorithm init
+      debug() << "Initializing underlying algorithm " << m_algo.name() << endmsg;
+      m_algo.init();
+    } catch (const std::exception& e) {
+      fatal() << e.what() << endmsg;
+      return StatusCode::FAILURE;
+    }
+    return StatusCode::SUCCESS;
+  }
+
+  StatusCode execute(const EventContext& ctx) const override {
+    try {
+      // Key the random streams to the input entry of the current event (thread-local)
+      algorithms::RandomSvc::context({ctx.eventID().run_number(), m_entry(ctx)});
+      detail::OutputBuffer buffer;
+      const auto output = m_output.create(buffer);
+      m_algo.process(m_input.get(), output);
+      // only publish the outputs once they are complete
+      m_output.put(buffer);
+    } catch (const std::exception& e) {
+      error() << e.what() << endmsg;
+      return StatusCode::FAILURE;
+    }
+    return StatusCode::SUCCESS;
+  }
+
+  bool isReEntrant() const override { return true; }
+
+private:
+  algo_type m_algo;
+  SmartIF<IAlgoServiceSvc> m_algo_svc;
+  detail::InputEntry m_entry;
+  detail::ReentrantDataProxy<output_type> m_output;
+  detail::ReentrantDataProxy<input_type> m_input;
+  detail::PropertyProxy m_props;
+};
+
+} // namespace Jug::Algo
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+#include <GaudiKernel/EventContext.h>
+#include <GaudiKernel/IDataProviderSvc.h>
+
+#include <JugBase/PodioDataSvc.h>
+
+namespace Jug::Algo::detail {
+
+// Input entry of the events, to key the per-event random streams: the event counter of the
+// context starts at 0 in every job (and every shard), so it is offset by the first entry the
+// job reads (FirstEventEntry, plus the entry range of the shard). Without a PodioDataSvc the
+// events are counted from 0.
+class InputEntry {
+public:
+  void init(IDataProviderSvc* evtSvc) {
+    m_podioDataSvc = dynamic_cast<const PodioDataSvc*>(evtSvc);
+  }
+  // the first entry is read for every event, the entry range can still be set after initialize
+  uint64_t operator()(const EventContext& ctx) const {
+    return (m_podioDataSvc != nullptr ? m_podioDataSvc->firstEntry() : 0) + ctx.evt();
+  }
+
+private:
+  const PodioDataSvc* m_podioDataSvc{nullptr};
+};
+
+} // namespace Jug::Algo::detail
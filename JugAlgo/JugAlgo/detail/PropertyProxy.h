@@ -0,0 +1,49 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+
+#include <Gaudi/Property.h>
+
+namespace Jug::Algo::detail {
+
+// Mirror all properties of an algorithms:: algorithm as Gaudi properties of the owner
+// (using the algorithm defaults), and forward the configured values to the algorithm.
+class PropertyProxy {
+public:
+  // to be called during construction of the owner (before init())
+  template <class Owner, class Algo> PropertyProxy(Owner* owner, const Algo& algo) {
+    for (const auto& [key, prop] : algo.getProperties()) {
+      std::visit(
+          [this, owner, key = key](auto&& val) {
+            using T = std::decay_t<decltype(val)>;
+            this->m_props.emplace(
+                key, std::make_unique<Gaudi::Property<T>>(owner, std::string(key), val));
+          },
+          prop.get());
+    }
+  }
+
+  // to be called during init() --> will actually set the underlying algo properties
+  template <class Algo> void apply(Algo& algo) const {
+    for (const auto& [key, prop] : algo.getProperties()) {
+      std::visit(
+          [this, &algo, key = key](auto&& val) {
+            using T                = std::decay_t<decltype(val)>;
+            const auto* gaudi_prop = static_cast<Gaudi::Property<T>*>(this->m_props.at(key).get());
+            const auto prop_val    = gaudi_prop->value();
+            algo.setProperty(key, prop_val);
+          },
+          prop.get());
+    }
+  }
+
+private:
+  std::map<std::string_view, std::unique_ptr<Gaudi::Details::PropertyBase>> m_props;
+};
+
+} // namespace Jug::Algo::detail
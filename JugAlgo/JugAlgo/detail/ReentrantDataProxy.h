@@ -0,0 +1,176 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <algorithms/algorithm.h>
+#include <algorithms/type_traits.h>
+
+#include <Gaudi/Algorithm.h>
+#include <GaudiKernel/DataObjectHandle.h>
+#include <GaudiKernel/GaudiException.h>
+#include <JugAlgo/detail/DataProxy.h>
+#include <JugBase/DataWrapper.h>
+
+namespace Jug::Algo::detail {
+
+// Output collections of a single event, owned by the caller until they are put in the
+// event store
+using OutputBuffer = std::vector<std::unique_ptr<DataObject>>;
+
+// Thread-safe counterpart of DataElement, for use with reentrant algorithms. All
+// per-event state lives on the caller's stack:
+//  - inputs are read through plain Gaudi read handles (any podio collection wrapper)
+//  - outputs are created in an OutputBuffer and only put in the store by put(), after the
+//    algorithm is done with them
+template <class T, DataMode kMode> class ReentrantDataElement {
+public:
+  using value_type  = std::conditional_t<kMode == DataMode::kInput, algorithms::input_type_t<T>,
+                                         algorithms::output_type_t<T>>;
+  using data_type   = algorithms::data_type_t<T>;
+  using names_type  =
+      std::conditional_t<algorithms::is_vector_v<T>, std::vector<std::string>, std::string>;
+  using handle_type = std::conditional_t<kMode == DataMode::kInput,
+                                         DataObjectReadHandle<DataWrapperBase>,
+                                         DataObjectWriteHandle<DataWrapper<data_type>>>;
+  constexpr static const bool kIsOptional = algorithms::is_optional_v<T>;
+  constexpr static const bool kIsVector   = algorithms::is_vector_v<T>;
+
+  template <class Owner>
+  ReentrantDataElement(Owner* owner, std::string_view name)
+      : m_data_names{std::make_unique<Gaudi::Property<names_type>>(owner, std::string(name),
+                                                                   names_type{})}
+      , m_owner{owner} {}
+  void init() {
+    std::vector<std::string> names;
+    if constexpr (kIsVector) {
+      names = m_data_names->value();
+    } else {
+      names.push_back(m_data_names->value());
+    }
+    for (const auto& name : names) {
+      if (!name.empty()) {
+        m_handles.emplace_back(std::make_unique<handle_type>(name, m_owner));
+      }
+    }
+    if (!kIsVector && !kIsOptional && m_handles.empty()) {
+      throw GaudiException("No collection name given for " + m_data_names->name(),
+                           "ReentrantDataElement", StatusCode::FAILURE);
+    }
+  }
+
+  // Input access
+  value_type get() const {
+    if constexpr (kIsVector) {
+      std::remove_const_t<value_type> ret;
+      for (const auto& handle : m_handles) {
+        ret.emplace_back(collection(*handle));
+      }
+      return ret;
+    } else {
+      if constexpr (kIsOptional) {
+        if (m_handles.empty()) {
+          return nullptr;
+        }
+      }
+      return collection(*m_handles.front());
+    }
+  }
+
+  // Output access: create new collections owned by the buffer
+  value_type create(OutputBuffer& buffer) const {
+    const auto make = [&buffer]() {
+      auto wrapper    = std::make_unique<DataWrapper<data_type>>();
+      data_type* coll = new data_type();
+      wrapper->setData(coll);
+      buffer.push_back(std::move(wrapper));
+      return coll;
+    };
+    if constexpr (kIsVector) {
+      std::remove_const_t<value_type> ret;
+      for (size_t i = 0; i < m_handles.size(); ++i) {
+        ret.emplace_back(make());
+      }
+      return ret;
+    } else {
+      if constexpr (kIsOptional) {
+        if (m_handles.empty()) {
+          return nullptr;
+        }
+      }
+      return make();
+    }
+  }
+  // Put the collections created by create() in the store, starting at buffer[offset]
+  void put(OutputBuffer& buffer, size_t& offset) const {
+    for (const auto& handle : m_handles) {
+      handle->put(std::unique_ptr<DataWrapper<data_type>>(
+          static_cast<DataWrapper<data_type>*>(buffer[offset++].release())));
+    }
+  }
+
+private:
+  static const data_type* collection(const DataObjectReadHandle<DataWrapperBase>& handle) {
+    const auto* coll = dynamic_cast<const data_type*>(handle.get()->collectionBase());
+    if (!coll) {
+      throw GaudiException("The type provided for " + handle.pythonRepr() +
+                               " is different from the one of the object in the store.",
+                           "wrong product type", StatusCode::FAILURE);
+    }
+    return coll;
+  }
+
+  std::unique_ptr<Gaudi::Property<names_type>> m_data_names;
+  std::vector<std::unique_ptr<handle_type>> m_handles;
+  gsl::not_null<Gaudi::Algorithm*> m_owner;
+};
+
+template <DataMode kMode, class Owner, class NamesArray, class Tuple, size_t... I>
+auto createReentrantElements(Owner* owner, const NamesArray& names, const Tuple&,
+                             std::index_sequence<I...>)
+    -> std::tuple<ReentrantDataElement<std::tuple_element_t<I, Tuple>, kMode>...> {
+  return {
+      ReentrantDataElement<std::tuple_element_t<I, Tuple>, kMode>(owner, std::get<I>(names))...};
+}
+
+template <class Data> class ReentrantDataProxy {
+public:
+  static constexpr DataMode kMode =
+      (algorithms::is_input_v<Data> ? DataMode::kInput : DataMode::kOutput);
+  using value_type              = typename Data::value_type;
+  using data_type               = typename Data::data_type;
+  constexpr static size_t kSize = Data::kSize;
+  using names_type              = typename Data::key_type;
+  using elements_type =
+      decltype(createReentrantElements<kMode>(std::declval<Gaudi::Algorithm*>(), names_type(),
+                                              data_type(), std::make_index_sequence<kSize>()));
+
+  template <class Owner>
+  ReentrantDataProxy(Owner* owner, const names_type& names)
+      : m_elements{createReentrantElements<kMode>(owner, names, data_type(),
+                                                  std::make_index_sequence<kSize>())} {}
+  void init() {
+    std::apply([](auto&&... el) { (el.init(), ...); }, m_elements);
+  }
+  // Inputs
+  value_type get() const {
+    return std::apply([](const auto&... el) { return value_type{el.get()...}; }, m_elements);
+  }
+  // Outputs (braced initialization guarantees the elements are created in order)
+  value_type create(OutputBuffer& buffer) const {
+    return std::apply([&buffer](const auto&... el) { return value_type{el.create(buffer)...}; },
+                      m_elements);
+  }
+  void put(OutputBuffer& buffer) const {
+    size_t offset = 0;
+    std::apply([&](const auto&... el) { (el.put(buffer, offset), ...); }, m_elements);
+  }
+
+private:
+  elements_type m_elements;
+};
+
+} // namespace Jug::Algo::detail
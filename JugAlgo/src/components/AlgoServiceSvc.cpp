@@ -19,11 +19,14 @@ public:
   virtual ~AlgoServiceSvc() = default;
 
   virtual StatusCode initialize() final;
-  virtual StatusCode finalize() final { return StatusCode::SUCCESS; }
+  virtual StatusCode finalize() final;
 
 private:
   SmartIF<IGeoSvc> m_geoSvc;
   Gaudi::Property<size_t> m_randomSeed{this, "randomSeed", 1};
+  Gaudi::Property<bool> m_asyncLogging{this, "asyncLogging", false,
+                                       "Hand algorithms messages to Gaudi from a background thread"};
+  Gaudi::Property<size_t> m_logQueueSize{this, "logQueueSize", 8192};
 };
 
 DECLARE_COMPONENT(AlgoServiceSvc)
@@ -45,10 +48,12 @@ StatusCode AlgoServiceSvc::initialize() {
     const algorithms::LogLevel level{
         static_cast<algorithms::LogLevel>(msgLevel() > 0 ? msgLevel() - 1 : 0)};
     info() << "Setting up algorithms::LogSvc with default level " << algorithms::logLevelName(level)
-           << endmsg;
+           << (m_asyncLogging ? " (asynchronous)" : "") << endmsg;
     serviceSvc.setInit<algorithms::LogSvc>([=](auto&& logger) {
       this->info() << "Initializing the algorithms::LogSvc using the Gaudi logger" << endmsg;
       logger.defaultLevel(level);
+      logger.setProperty("async", m_asyncLogging.value());
+      logger.setProperty("queueSize", m_logQueueSize.value());
       logger.init(
           [this](const algorithms::LogLevel l, std::string_view caller, std::string_view msg) {
             const std::string text = fmt::format("[{}] {}", caller, msg);
@@ -82,6 +87,7 @@ StatusCode AlgoServiceSvc::initialize() {
     // setup random service
     info() << "Setting up algorithms::RandomSvc\n"
            << "  --> using internal STL 64-bit MT engine\n"
+           << "  --> per-event streams using Philox4x64-10 keyed by (seed, run, event, algorithm)\n"
            << "  --> seed set to" << m_randomSeed << endmsg;
     serviceSvc.setInit<algorithms::RandomSvc>([=](auto&& r) {
       this->info() << "Initializing the algorithms::RandomSvc" << endmsg;
@@ -105,3 +111,9 @@ StatusCode AlgoServiceSvc::initialize() {
   info() << "AlgoServiceSvc initialized successfully" << endmsg;
   return StatusCode::SUCCESS;
 }
+
+StatusCode AlgoServiceSvc::finalize() {
+  // flush any queued messages while our MsgStream is still around
+  algorithms::LogSvc::instance().stop();
+  return Service::finalize();
+}
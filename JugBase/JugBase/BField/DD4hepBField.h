@@ -8,7 +8,10 @@
 
 #pragma once
 
+#include <array>
+#include <string>
 #include <variant>
+#include <vector>
 
 #include "Acts/Definitions/Algebra.hpp"
 #include "Acts/MagneticField/MagneticFieldContext.hpp"
@@ -27,6 +30,12 @@ namespace Jug::BField {
   //};
 
   /** Use the dd4hep magnetic field in acts.
+   *
+   * By default every query goes to the DD4hep field. Optionally, the field can be sampled once
+   * on a regular (r, z) or (x, y, z) grid (see sampleGrid()), after which queries inside the
+   * grid are interpolated (bi- or trilinear), and only queries outside the grid still go to
+   * DD4hep. The grid cell of the last query is memoized in the Cache, as consecutive stepper
+   * queries mostly fall in the same cell.
    *
    * \ingroup magnets
    * \ingroup magsvc
@@ -35,9 +44,25 @@ namespace Jug::BField {
   public:
     std::shared_ptr<dd4hep::Detector> m_det;
 
+    /// Layout of the optional field grid
+    struct GridConfig {
+      /// (r, z) assumes a rotationally symmetric field
+      enum class Type { kRZ, kXYZ };
+      Type type = Type::kRZ;
+      /// Grid range and number of nodes along (r, z) or (x, y, z), in Acts units
+      std::vector<double> min;
+      std::vector<double> max;
+      std::vector<size_t> nodes;
+    };
+
   public:
     struct Cache {
       Cache(const Acts::MagneticFieldContext& /*mcfg*/) { }
+      /// Grid cell of the previous query (in grid coordinates) and its corner values
+      bool valid = false;
+      std::array<double, 3> lower{};
+      std::array<double, 3> upper{};
+      std::array<Acts::Vector3, 8> corners;
     };
 
     Acts::MagneticFieldProvider::Cache makeCache(const Acts::MagneticFieldContext& mctx) const override
@@ -54,11 +79,8 @@ namespace Jug::BField {
     /**  retrieve magnetic field value.
      *
      *  @param [in] position global position
-     *  @param [in] cache Cache object (is ignored)
+     *  @param [in] cache Cache object (memoizes the grid cell)
      *  @return magnetic field vector
-     *
-     *  @note The @p position is ignored and only kept as argument to provide
-     *        a consistent interface with other magnetic field services.
      */
     Acts::Result<Acts::Vector3> getField(const Acts::Vector3& position, Acts::MagneticFieldProvider::Cache& cache) const override;
 
@@ -67,16 +89,55 @@ namespace Jug::BField {
      * @param [in]  position   global position
      * @param [out] derivative gradient of magnetic field vector as (3x3)
      * matrix
-     * @param [in] cache Cache object (is ignored)
+     * @param [in] cache Cache object
      * @return magnetic field vector
      *
-     * @note The @p position is ignored and only kept as argument to provide
-     *       a consistent interface with other magnetic field services.
      * @note currently the derivative is not calculated
      * @todo return derivative
      */
     Acts::Result<Acts::Vector3> getFieldGradient(const Acts::Vector3& position, Acts::ActsMatrix<3, 3>& /*derivative*/,
                                                  Acts::MagneticFieldProvider::Cache& cache) const override;
+
+    /// Field straight from DD4hep, bypassing the grid
+    Acts::Vector3 directField(const Acts::Vector3& position) const;
+
+    /** Sample the DD4hep field on a grid, to be interpolated from then on.
+     *  Throws std::invalid_argument for an invalid configuration.
+     */
+    void sampleGrid(const GridConfig& config);
+
+    /** Load a grid stored with saveGrid().
+     *  Returns false if the file is missing, has a different layout, or no longer agrees with
+     *  the DD4hep field (checked at a few nodes).
+     */
+    bool loadGrid(const std::string& fname, const GridConfig& config);
+
+    /// Store the grid, returns false on failure
+    bool saveGrid(const std::string& fname) const;
+
+    bool hasGrid() const { return !m_grid.values.empty(); }
+    size_t gridSize() const { return m_grid.values.size(); }
+
+  private:
+    struct Grid {
+      GridConfig::Type type = GridConfig::Type::kRZ;
+      std::array<double, 3> min{};
+      std::array<double, 3> step{};
+      std::array<size_t, 3> nodes{1, 1, 1};
+      /// (Br, Bphi, Bz) for (r, z) grids, (Bx, By, Bz) otherwise, first axis running fastest
+      std::vector<Acts::Vector3> values;
+    };
+
+    /// Grid layout for a configuration (without values)
+    static Grid layout(const GridConfig& config);
+    /// Grid coordinates of a position
+    std::array<double, 3> gridCoordinates(const Acts::Vector3& position) const;
+    /// Global position of a grid node
+    Acts::Vector3 nodePosition(const std::array<size_t, 3>& idx) const;
+    /// Find the cell containing q and store it in the cache, false if q is outside the grid
+    bool locate(const std::array<double, 3>& q, Cache& cache) const;
+
+    Grid m_grid;
   };
 
   using BFieldVariant = std::variant<std::shared_ptr<const DD4hepBField>>;
@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Whitney Armstrong, Wouter Deconinck
+
+#ifndef JUGBASE_BRANCHSETTINGS_H
+#define JUGBASE_BRANCHSETTINGS_H
+
+#include <optional>
+#include <string>
+#include <vector>
+
+/** Per-branch output settings.
+ *
+ *  Settings are given as lines "<pattern> key=value ...", with the same wildcard patterns
+ *  as the keep/drop commands (see KeepDropSwitch), matched against the collection name. When
+ *  several lines match, later lines take precedence (per key). Keys:
+ *   - compression=<algorithm>[:<level>], with algorithm ZLIB, LZMA, LZ4 or ZSTD
+ *   - basket=<basket size in bytes>
+ *   - split=<split level>
+ *
+ * \ingroup base
+ */
+class BranchSettings {
+public:
+  struct Settings {
+    /// ROOT compression settings (100 * algorithm + level), -1 to use the file default
+    int compression = -1;
+    int basketSize  = 32000;
+    int splitLevel  = 99;
+  };
+  typedef std::vector<std::string> CommandLines;
+
+  BranchSettings() {}
+  /// Throws std::invalid_argument for malformed lines
+  explicit BranchSettings(const CommandLines& lines);
+
+  Settings get(const std::string& name) const;
+
+  /// Human readable compression settings, e.g. "ZSTD:5"
+  static std::string compressionName(int compression);
+
+private:
+  struct Rule {
+    std::string pattern;
+    std::optional<int> compression;
+    std::optional<int> basketSize;
+    std::optional<int> splitLevel;
+  };
+  std::vector<Rule> m_rules;
+};
+
+#endif
@@ -16,6 +16,7 @@
 
 #include <TTree.h>
 
+#include <cstdint>
 #include <type_traits>
 
 namespace Jug {
@@ -59,10 +60,19 @@ public:
   T* createAndPut();
 
 private:
+  /// The event data service if it is a PodioDataSvc, nullptr otherwise
+  PodioDataSvc* podioDataSvc();
+
   ServiceHandle<IDataProviderSvc> m_eds;
   bool m_isGoodType{false};
   bool m_isCollection{false};
   T* m_dataPtr;
+  /// The event data service, if it is a PodioDataSvc (resolved on the first get)
+  PodioDataSvc* m_pds{nullptr};
+  bool m_pdsChecked{false};
+  /// Object found by the last get, valid as long as the event generation did not change
+  const T* m_cached{nullptr};
+  uint64_t m_cachedGeneration{0};
 };
 
 template <typename T>
@@ -131,11 +141,17 @@ DataHandle<T>::DataHandle(const std::string& descriptor, Gaudi::DataHandle::Mode
  * object. Then finally set the handle as Read.
  * If this is not the first time we cast and the cast worked, just use the
  * static cast: we do not need the checks of the dynamic cast for every access!
+ * With a PodioDataSvc, the object is only looked up in the store once per event
+ * (the data service counts the events with its generation).
  */
 template <typename T>
 const T* DataHandle<T>::get() {
+  if (LIKELY(m_pds != nullptr && m_cachedGeneration == m_pds->generation())) {
+    return m_cached;
+  }
   DataObject* dataObjectp = nullptr;
   auto sc = m_eds->retrieveObject(DataObjectHandle<DataWrapper<T>>::fullKey().key(), dataObjectp);
+  podioDataSvc(); // for the cache below
 
   if (LIKELY(sc.isSuccess())) {
     if (UNLIKELY(!m_isGoodType && !m_isCollection)) {
@@ -148,23 +164,39 @@ const T* DataHandle<T>::get() {
         }
       }
     }
+    const T* data = nullptr;
     if (LIKELY(m_isGoodType)) {
-      return static_cast<DataWrapper<T>*>(dataObjectp)->getData();
+      data = static_cast<DataWrapper<T>*>(dataObjectp)->getData();
     } else if (m_isCollection) {
       // The reader does not know the specific type of the collection. So we need a reinterpret_cast if the handle was
       // created by the reader.
       DataWrapper<podio::CollectionBase>* tmp = static_cast<DataWrapper<podio::CollectionBase>*>(dataObjectp);
-      return reinterpret_cast<const T*>(tmp->collectionBase());
+      data = reinterpret_cast<const T*>(tmp->collectionBase());
     } else {
       std::string errorMsg("The type provided for " + DataObjectHandle<DataWrapper<T>>::pythonRepr() +
                            " is different from the one of the object in the store.");
       throw GaudiException(errorMsg, "wrong product type", StatusCode::FAILURE);
     }
+    if (m_pds != nullptr) {
+      m_cached           = data;
+      m_cachedGeneration = m_pds->generation();
+    }
+    return data;
   }
   std::string msg("Could not retrieve product " + DataObjectHandle<DataWrapper<T>>::pythonRepr());
   throw GaudiException(msg, "wrong product name", StatusCode::FAILURE);
 }
 
+template <typename T>
+PodioDataSvc* DataHandle<T>::podioDataSvc() {
+  if (UNLIKELY(!m_pdsChecked)) {
+    // (retrieves the service if needed)
+    m_pdsChecked = m_eds.isValid();
+    m_pds        = dynamic_cast<PodioDataSvc*>(m_eds.get());
+  }
+  return m_pds;
+}
+
 //---------------------------------------------------------------------------
 template <typename T>
 void DataHandle<T>::put(T* objectp) {
@@ -185,10 +217,21 @@ void DataHandle<T>::put(T* objectp) {
  * Create the collection, put it in the DataObjectHandle and return the
  * pointer to the data. Call this function if you create a collection and
  * want to save it.
+ * With collectionPoolSize set on the data service, the collection may be a
+ * cleared collection of an earlier event, which keeps its allocated capacity.
  */
 template <typename T>
 T* DataHandle<T>::createAndPut() {
-  T* objectp = new T();
+  T* objectp = nullptr;
+  if constexpr (std::is_base_of_v<podio::CollectionBase, T>) {
+    // reuse the (cleared) collection of an earlier event if the data service pools them
+    if (auto* pds = podioDataSvc(); pds != nullptr) {
+      objectp = static_cast<T*>(pds->reuseCollection(typeid(T)));
+    }
+  }
+  if (objectp == nullptr) {
+    objectp = new T();
+  }
   this->put(objectp);
   return objectp;
 }
@@ -19,6 +19,8 @@ public:
   // ugly hack to circumvent the usage of boost::any yet
   // DataSvc would need a templated register method
   virtual podio::CollectionBase* collectionBase() = 0;
+  /// give up the ownership of the collection (e.g. to a podio::Frame), keeps pointing to it
+  virtual podio::CollectionBase* releaseCollection() = 0;
   virtual ~DataWrapperBase(){};
 };
 
@@ -36,14 +38,25 @@ public:
   void setData(T* data) { m_data = data; }
   /// try to cast to collectionBase; may return nullptr;
   virtual podio::CollectionBase* collectionBase();
+  virtual podio::CollectionBase* releaseCollection();
 
 private:
   T* m_data;
+  bool m_owned{true};
 };
 
 template <class T>
 DataWrapper<T>::~DataWrapper() {
-  if (m_data != nullptr) delete m_data;
+  if (m_owned && m_data != nullptr) delete m_data;
+}
+
+template <class T>
+podio::CollectionBase* DataWrapper<T>::releaseCollection() {
+  podio::CollectionBase* collection = collectionBase();
+  if (collection != nullptr) {
+    m_owned = false;
+  }
+  return collection;
 }
 
 template <class T>
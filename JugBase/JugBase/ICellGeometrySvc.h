@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Whitney Armstrong, Sylvester Joosten
+
+#ifndef ICELLGEOMETRYSVC_H
+#define ICELLGEOMETRYSVC_H
+
+#include <GaudiKernel/IService.h>
+
+#include <array>
+#include <cstdint>
+
+#include "DD4hep/DetElement.h"
+#include "DD4hep/Objects.h"
+
+class TGeoHMatrix;
+
+namespace Acts {
+  class Surface;
+}
+
+namespace Jug::Base {
+
+  /** Geometry information for a single readout cell.
+   *
+   *  All lengths are in DD4hep units.
+   */
+  struct CellGeometry {
+    /// Identifier of the sensitive volume (the cellID without the segmentation bits)
+    uint64_t volumeID = 0;
+    /// Global cell position
+    dd4hep::Position position;
+    /// Cell position in the frame of the lowest-level DetElement of the cell
+    dd4hep::Position localPosition;
+    /// Position of the sensitive volume placement within its mother volume
+    dd4hep::Position placementPosition;
+    /// Cell dimensions from the segmentation, or the full bounding box of the sensitive
+    /// volume if the readout has no segmentation
+    std::array<double, 3> dimensions{};
+    size_t nDimensions = 0;
+    /// Lowest-level DetElement of the cell
+    dd4hep::DetElement detElement;
+    /// Local-to-global transform of detElement (owned by DD4hep)
+    const TGeoHMatrix* localToGlobal = nullptr;
+    /// ACTS tracking surface of the sensitive volume (nullptr if not a tracking surface)
+    const Acts::Surface* surface = nullptr;
+  };
+} // namespace Jug::Base
+
+/** Cell geometry lookup service.
+ *
+ *  Caches the DD4hep geometry lookups (CellIDPositionConverter, VolumeManager) for the
+ *  cells that were seen, so they only need to be done once per cell and job.
+ *
+ * \ingroup base
+ * \ingroup geosvc
+ */
+class GAUDI_API ICellGeometrySvc : virtual public IService {
+public:
+  using CellGeometry = Jug::Base::CellGeometry;
+
+public:
+  /// InterfaceID
+  DeclareInterfaceID(ICellGeometrySvc, 1, 0);
+  virtual ~ICellGeometrySvc() {}
+
+  /// Geometry information for a cell, thread-safe
+  virtual CellGeometry cell(uint64_t cellID) const = 0;
+};
+
+#endif // ICELLGEOMETRYSVC_H
@@ -0,0 +1,34 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Whitney Armstrong, Wouter Deconinck
+
+#ifndef ISHARDINGSVC_H
+#define ISHARDINGSVC_H
+
+#include <GaudiKernel/IService.h>
+
+#include <string>
+
+/** Multi-process (sharded) execution.
+ *
+ *  The input entries are split in contiguous ranges, one per worker process. Every worker
+ *  writes its own output files, which are merged in entry order at the end of the job.
+ *
+ * \ingroup base
+ */
+class GAUDI_API IShardingSvc : virtual public IService {
+public:
+  /// InterfaceID
+  DeclareInterfaceID(IShardingSvc, 1, 0);
+  virtual ~IShardingSvc() {}
+
+  /// Number of worker processes (1 if not sharding)
+  virtual size_t nShards() const = 0;
+  /// Index of this worker process (0 for the main process)
+  virtual size_t shard() const = 0;
+  /** File this process should write instead of filename. The file is registered to be
+   *  merged into filename at the end of the job.
+   */
+  virtual std::string outputFile(const std::string& filename) = 0;
+};
+
+#endif // ISHARDINGSVC_H
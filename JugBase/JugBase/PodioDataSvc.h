@@ -12,8 +12,17 @@
 #include <podio/EventStore.h>
 #include <podio/ROOTReader.h>
 
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 // Forward declarations
+class DataWrapperBase;
+class PrefetchReader;
 
 /** @class PodioEvtSvc EvtDataSvc.h
  *
@@ -28,6 +37,18 @@ public:
   using CollRegistry = std::vector<std::pair<std::string, podio::CollectionBase*>>;
   using CollectionIDTable_ptr = decltype(std::declval<podio::ROOTReader>().getCollectionIDTable());
 
+  /// Input collection that is only read when it is first retrieved
+  struct LazyCollection {
+    std::string name;
+    int id;
+    /// Registered for the current event, but not read yet
+    bool pending{false};
+    /// Number of events it was read on demand (retrieved by an algorithm)
+    size_t nOnDemand{0};
+    /// Number of events it was only read to be written to the output
+    size_t nForOutput{0};
+  };
+
   /** Initialize the service.
    *  - attaches data loader
    *  - registers input filenames  
@@ -41,10 +62,14 @@ public:
   PodioDataSvc(const std::string& name, ISvcLocator* svc);
 
   /// Standard Destructor
-  virtual ~PodioDataSvc() { };
+  virtual ~PodioDataSvc();
 
   // Use DataSvc functionality except where we override
   using DataSvc::registerObject;
+  using DataSvc::retrieveObject;
+  /// Retrieve an object, reading it from the input first if it is a pending lazy collection
+  virtual StatusCode retrieveObject(IRegistry* pDirectory, std::string_view path,
+                                    DataObject*& pObject) override;
   /// Overriding standard behaviour of evt service
   /// Register object with the data store.
   virtual StatusCode registerObject(std::string_view parentPath,
@@ -53,6 +78,31 @@ public:
 
   StatusCode readCollection(const std::string& collectionName, int collectionID);
 
+  /// Number of input entries to process (-1 without input)
+  int inputEntries() const { return m_eventMax; }
+  /// Input entry of the first event (FirstEventEntry plus the entry range)
+  unsigned firstEntry() const { return m_1stEvtEntry; }
+  /// The input files (empty without input)
+  const std::vector<std::string>& inputFiles() const { return m_filenames; }
+  /** Only process the entries [first, first + count) of the input (counting from
+   *  FirstEventEntry). With reopen, the input files are opened again, e.g. so processes forked
+   *  after initialization do not share file offsets. Call before the first event is read.
+   */
+  StatusCode setEntryRange(unsigned first, unsigned count, bool reopen);
+
+  /** Read the given collections of the next prefetchDepth entries in the background (no-op
+   *  if prefetchDepth is 0 or there is no input). Call before the first event is read.
+   */
+  void startPrefetch(const std::vector<std::string>& collections);
+
+  /// Set the input collections that are read on demand
+  void setLazyCollections(const std::vector<std::string>& names, const std::vector<int>& ids);
+  /// Register the lazy collections for the current event, without reading them
+  void registerLazyCollections();
+  /// Read the pending lazy collections that pass the selection (e.g. to write them out)
+  StatusCode readPendingCollections(const std::function<bool(const std::string&)>& select);
+  const std::vector<LazyCollection>& lazyCollections() const { return m_lazyCollections; }
+
   virtual const CollRegistry& getCollections() const { return m_collections; }
   virtual const CollRegistry& getReadCollections() const { return m_readCollections; }
   podio::EventStore& getProvider() { return m_provider; }
@@ -62,10 +112,28 @@ public:
   void setCollectionIDs(CollectionIDTable_ptr collectionIds);
   /// Resets caches of reader and event store, increases event counter
   void endOfRead();
+  /// Move the reader to the next event (deferred to clearStore with pending lazy collections)
+  void advanceReader();
+  /** Hand the collections of the current event (created and read) over to an asynchronous
+   *  writer. They are no longer cleared with the store, the caller needs to keep their
+   *  wrappers alive until it is done with them.
+   */
+  CollRegistry releaseCollections();
 
 
+  /** Get an empty collection of this type that was created in an earlier event, and keeps
+   *  the capacity of its storage (nullptr if there is none). Ownership goes to the caller.
+   *  Only collections that were registered with collectionPoolSize > 0 end up in the pool.
+   */
+  podio::CollectionBase* reuseCollection(const std::type_info& type);
+
   TTree* eventDataTree() {return m_eventDataTree;}
 
+  /** Changes whenever the objects in the store may have changed (with every event), so
+   *  objects that were found in the store can be reused as long as it stays the same.
+   */
+  uint64_t generation() const { return m_generation; }
+
 
 private:
 
@@ -73,12 +141,18 @@ private:
   TTree* m_eventDataTree;
   /// PODIO reader for ROOT files
   podio::ROOTReader m_reader;
+  /// Read-ahead wrapper around m_reader (if prefetching)
+  std::unique_ptr<PrefetchReader> m_prefetch;
+  /// The reader used by the EventStore
+  podio::IReader* m_input{&m_reader};
   /// PODIO EventStore, used to initialise collections
   podio::EventStore m_provider;
   /// Counter of the event number
   int m_eventNum{0};
   /// Number of events in the file / to process
   int m_eventMax{-1};
+  /// Store generation, see generation()
+  uint64_t m_generation{1};
 
 
   SmartIF<IConversionSvc> m_cnvSvc;
@@ -88,6 +162,23 @@ private:
   std::vector<std::pair<std::string, podio::CollectionBase*>> m_readCollections;
   CollectionIDTable_ptr m_collectionIDs;
 
+  /// Lazy input collections, and their index by name
+  std::vector<LazyCollection> m_lazyCollections;
+  std::unordered_map<std::string, size_t> m_lazyIndex;
+  /// The reader is still on the current event, for the lazy collections
+  bool m_advanceReader{false};
+
+  /// Collections created in this event (if pooling), and the pool of cleared collections
+  std::vector<DataWrapperBase*> m_createdWrappers;
+  std::unordered_map<std::type_index, std::vector<std::unique_ptr<podio::CollectionBase>>>
+      m_collectionPool;
+  size_t m_nReused{0};
+  size_t m_nCreated{0};
+
+  StatusCode readLazyCollection(LazyCollection& lazy);
+  /// Move the collections created in this event to the pool (before the store is cleared)
+  void recycleCollections();
+
 protected:
   /// ROOT file name the input is read from. Set by option filename
   std::vector<std::string> m_filenames;
@@ -95,5 +186,13 @@ protected:
   /// Jump to nth events at the beginning. Set by option FirstEventEntry
   /// This option is helpful when we want to debug an event in the middle of a file
   unsigned m_1stEvtEntry{0};
+  /// Number of entries to read ahead in the background (0: no prefetching)
+  unsigned m_prefetchDepth{0};
+  /// TTreeCache size, as a multiple of the cluster size of the input tree (0: ROOT default)
+  double m_treeCacheSize{0};
+  /// Number of entries the TTreeCache uses to learn the branches that are read (0: ROOT default)
+  int m_treeCacheLearnEntries{0};
+  /// Maximum number of cleared collections kept per type for the next events (0: no pooling)
+  unsigned m_collectionPoolSize{0};
 };
 #endif  
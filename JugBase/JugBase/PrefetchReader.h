@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Whitney Armstrong, Wouter Deconinck
+
+#ifndef JUGBASE_PREFETCHREADER_H
+#define JUGBASE_PREFETCHREADER_H
+
+#include <podio/IReader.h>
+#include <podio/ROOTReader.h>
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+/** Read-ahead wrapper around a podio::ROOTReader.
+ *
+ *  A background thread reads (and decompresses) the selected collections of the next `depth`
+ *  entries, while the current event is processed. Collections that were not selected (e.g.
+ *  pulled in through relations) are read from the current entry with a second reader on the
+ *  event thread, and are prefetched from then on.
+ *
+ *  The wrapped reader must not be used by anyone else once prefetching has started.
+ *
+ * \ingroup base
+ */
+class PrefetchReader : public podio::IReader {
+public:
+  /// Start reading ahead from the current entry of reader
+  PrefetchReader(podio::ROOTReader& reader, std::vector<std::string> filenames,
+                 const std::vector<std::string>& collections, unsigned firstEntry, size_t depth);
+  ~PrefetchReader() override;
+
+  PrefetchReader(const PrefetchReader&) = delete;
+  PrefetchReader& operator=(const PrefetchReader&) = delete;
+
+  podio::CollectionBase* readCollection(const std::string& name) override;
+  std::shared_ptr<podio::CollectionIDTable> getCollectionIDTable() override { return m_table; }
+  podio::GenericParameters* readEventMetaData() override;
+  std::map<int, podio::GenericParameters>* readCollectionMetaData() override;
+  std::map<int, podio::GenericParameters>* readRunMetaData() override;
+  unsigned getEntries() const override { return m_entries; }
+  void endOfEvent() override;
+  bool isValid() const override { return m_valid; }
+  /// Files cannot be changed while prefetching
+  void openFile(const std::string& filename) override;
+  void closeFile() override;
+  /// All selected collections are read in the background anyway
+  void readEvent() override {}
+  void goToEvent(unsigned iEvent) override;
+  podio::version::Version currentFileVersion() const override { return m_version; }
+
+  /// Collections that were read on the event thread (not prefetched), and how often
+  const std::map<std::string, size_t>& misses() const { return m_misses; }
+  /// Number of times the event thread had to wait for the prefetch thread
+  size_t stalls() const { return m_stalls; }
+
+private:
+  struct Entry {
+    unsigned entry;
+    std::map<std::string, podio::CollectionBase*> collections;
+    std::unique_ptr<podio::GenericParameters> evtMD;
+  };
+
+  void run();
+  void stop();
+  /// Wait for the current entry, returns nullptr past the end of the input
+  Entry* current();
+  static void release(Entry& entry);
+
+  podio::IReader& m_reader;
+  std::vector<std::string> m_filenames;
+  /// Reader for the collections that were not prefetched (opened on first use)
+  std::unique_ptr<podio::ROOTReader> m_fallback;
+
+  std::shared_ptr<podio::CollectionIDTable> m_table;
+  std::map<int, podio::GenericParameters> m_colMD;
+  std::map<int, podio::GenericParameters> m_runMD;
+  podio::version::Version m_version;
+  unsigned m_entries;
+  bool m_valid;
+  size_t m_depth;
+
+  std::thread m_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  /// Collections to prefetch (may grow with misses)
+  std::set<std::string> m_collections;
+  std::deque<std::unique_ptr<Entry>> m_staged;
+  /// Next entry to prefetch
+  unsigned m_next;
+  bool m_done{false};
+  bool m_stop{false};
+
+  std::map<std::string, size_t> m_misses;
+  size_t m_stalls{0};
+};
+
+#endif
@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Whitney Armstrong, Wouter Deconinck
+
+#include "JugBase/BranchSettings.h"
+#include "JugBase/KeepDropSwitch.h"
+
+#include <algorithm>
+#include <array>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#include "Compression.h"
+
+namespace {
+// name, ROOT algorithm and default level
+struct Algorithm {
+  const char* name;
+  ROOT::RCompressionSetting::EAlgorithm::EValues algorithm;
+  int level;
+};
+const std::array<Algorithm, 4> kAlgorithms = {{
+    {"ZLIB", ROOT::RCompressionSetting::EAlgorithm::kZLIB, 1},
+    {"LZMA", ROOT::RCompressionSetting::EAlgorithm::kLZMA, 7},
+    {"LZ4", ROOT::RCompressionSetting::EAlgorithm::kLZ4, 4},
+    {"ZSTD", ROOT::RCompressionSetting::EAlgorithm::kZSTD, 5},
+}};
+
+int toInt(const std::string& value, const std::string& line) {
+  try {
+    size_t pos    = 0;
+    const int ret = std::stoi(value, &pos);
+    if (pos == value.size()) {
+      return ret;
+    }
+  } catch (const std::logic_error&) {
+  }
+  throw std::invalid_argument("malformed number '" + value + "' in branch settings : " + line);
+}
+
+int toCompression(const std::string& value, const std::string& line) {
+  const auto colon     = value.find(':');
+  const auto algorithm = value.substr(0, colon);
+  for (const auto& alg : kAlgorithms) {
+    if (algorithm == alg.name) {
+      const int level =
+          (colon == std::string::npos) ? alg.level : toInt(value.substr(colon + 1), line);
+      if (level < 0 || level > 9) {
+        throw std::invalid_argument("compression level should be 0-9 in branch settings : " + line);
+      }
+      return ROOT::CompressionSettings(alg.algorithm, level);
+    }
+  }
+  throw std::invalid_argument("unknown compression algorithm '" + algorithm +
+                              "' (ZLIB, LZMA, LZ4 or ZSTD) in branch settings : " + line);
+}
+} // namespace
+
+BranchSettings::BranchSettings(const CommandLines& lines) {
+  for (const auto& line : lines) {
+    auto words = split(line, ' ');
+    words.erase(std::remove(words.begin(), words.end(), std::string()), words.end());
+    if (words.size() < 2) {
+      throw std::invalid_argument("malformed branch settings : " + line);
+    }
+    Rule rule;
+    rule.pattern = words[0];
+    for (size_t i = 1; i < words.size(); ++i) {
+      const auto eq = words[i].find('=');
+      if (eq == std::string::npos) {
+        throw std::invalid_argument("expected key=value in branch settings : " + line);
+      }
+      const auto key   = words[i].substr(0, eq);
+      const auto value = words[i].substr(eq + 1);
+      if (key == "compression") {
+        rule.compression = toCompression(value, line);
+      } else if (key == "basket") {
+        rule.basketSize = toInt(value, line);
+      } else if (key == "split") {
+        rule.splitLevel = toInt(value, line);
+      } else {
+        throw std::invalid_argument("unknown key '" + key +
+                                    "' (compression, basket or split) in branch settings : " + line);
+      }
+    }
+    m_rules.push_back(std::move(rule));
+  }
+}
+
+BranchSettings::Settings BranchSettings::get(const std::string& name) const {
+  Settings settings;
+  for (const auto& rule : m_rules) {
+    if (wildcmp(rule.pattern.c_str(), name.c_str()) == 0) {
+      continue;
+    }
+    settings.compression = rule.compression.value_or(settings.compression);
+    settings.basketSize  = rule.basketSize.value_or(settings.basketSize);
+    settings.splitLevel  = rule.splitLevel.value_or(settings.splitLevel);
+  }
+  return settings;
+}
+
+std::string BranchSettings::compressionName(const int compression) {
+  if (compression < 0) {
+    return "default";
+  }
+  for (const auto& alg : kAlgorithms) {
+    if (compression / 100 == static_cast<int>(alg.algorithm)) {
+      return std::string(alg.name) + ":" + std::to_string(compression % 100);
+    }
+  }
+  return std::to_string(compression);
+}
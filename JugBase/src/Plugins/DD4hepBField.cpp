@@ -4,6 +4,12 @@
 #include "JugBase/BField/DD4hepBField.h"
 
 #include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <unistd.h>
 #include "Acts/Definitions/Units.hpp"
 #include "Acts/Definitions/Algebra.hpp"
 #include "DD4hep/DD4hepUnits.h"
@@ -14,14 +20,67 @@
 //using Vec        = Jug::Helpers::VectorToActs<ROOT::Math::XYZVector>;
 //using Vec2DD4hep = Jug::Helpers::ArrayToRoot<Acts::Vector3>;
 
+namespace {
+  // bump the version whenever the file layout changes
+  constexpr std::array<char, 8> kGridMagic = {'J', 'U', 'G', 'B', 'G', 'R', 'I', 'D'};
+  constexpr uint32_t kGridVersion           = 1;
+
+  struct GridHeader {
+    std::array<char, 8> magic;
+    uint32_t version;
+    uint32_t type;
+    std::array<uint64_t, 3> nodes;
+    std::array<double, 3> min;
+    std::array<double, 3> step;
+  };
+} // namespace
+
 namespace Jug::BField {
 
-  Acts::Result<Acts::Vector3> DD4hepBField::getField(const Acts::Vector3& position,
-                                                     Acts::MagneticFieldProvider::Cache& /*cache*/) const
+  Acts::Vector3 DD4hepBField::directField(const Acts::Vector3& position) const
   {
     dd4hep::Position pos(position[0]/10.0,position[1]/10.0,position[2]/10.0);
-    auto field = m_det->field().magneticField(pos) * (Acts::UnitConstants::T / dd4hep::tesla); 
-    return Acts::Result<Acts::Vector3>::success({field.x(), field.y(),field.z()});
+    auto field = m_det->field().magneticField(pos) * (Acts::UnitConstants::T / dd4hep::tesla);
+    return {field.x(), field.y(), field.z()};
+  }
+
+  Acts::Result<Acts::Vector3> DD4hepBField::getField(const Acts::Vector3& position,
+                                                     Acts::MagneticFieldProvider::Cache& gcache) const
+  {
+    if (!hasGrid()) {
+      return Acts::Result<Acts::Vector3>::success(directField(position));
+    }
+    Cache& cache = gcache.as<Cache>();
+    const auto q = gridCoordinates(position);
+    bool inCell  = cache.valid;
+    for (size_t d = 0; d < 3 && inCell; ++d) {
+      inCell = (q[d] >= cache.lower[d] && q[d] <= cache.upper[d]);
+    }
+    if (!inCell && !locate(q, cache)) {
+      // outside of the grid
+      return Acts::Result<Acts::Vector3>::success(directField(position));
+    }
+
+    // (bi/tri)linear interpolation between the cell corners
+    std::array<double, 3> t{};
+    for (size_t d = 0; d < 3; ++d) {
+      t[d] = (m_grid.nodes[d] > 1) ? (q[d] - cache.lower[d]) / m_grid.step[d] : 0.;
+    }
+    Acts::Vector3 field = Acts::Vector3::Zero();
+    for (size_t c = 0; c < 8; ++c) {
+      const double w = ((c & 1) ? t[0] : 1. - t[0]) * ((c & 2) ? t[1] : 1. - t[1]) *
+                       ((c & 4) ? t[2] : 1. - t[2]);
+      field += w * cache.corners[c];
+    }
+    if (m_grid.type == GridConfig::Type::kRZ) {
+      // (Br, Bphi, Bz) --> (Bx, By, Bz)
+      const double r    = q[0];
+      const double cphi = (r > 0) ? position.x() / r : 1.;
+      const double sphi = (r > 0) ? position.y() / r : 0.;
+      return Acts::Result<Acts::Vector3>::success({field.x() * cphi - field.y() * sphi,
+                                                   field.x() * sphi + field.y() * cphi, field.z()});
+    }
+    return Acts::Result<Acts::Vector3>::success(field);
   }
 
   Acts::Result<Acts::Vector3> DD4hepBField::getFieldGradient(const Acts::Vector3& position,
@@ -30,4 +89,176 @@ namespace Jug::BField {
   {
     return this->getField(position, cache);
   }
+
+  DD4hepBField::Grid DD4hepBField::layout(const GridConfig& config)
+  {
+    const size_t ndim = (config.type == GridConfig::Type::kRZ) ? 2 : 3;
+    if (config.min.size() != ndim || config.max.size() != ndim || config.nodes.size() != ndim) {
+      throw std::invalid_argument("Field grid needs " + std::to_string(ndim) +
+                                  " values for the minimum, maximum and number of nodes");
+    }
+    Grid grid;
+    grid.type = config.type;
+    for (size_t d = 0; d < ndim; ++d) {
+      if (config.nodes[d] < 2 || !(config.max[d] > config.min[d])) {
+        throw std::invalid_argument("Field grid needs max > min and at least 2 nodes per axis");
+      }
+      grid.min[d]   = config.min[d];
+      grid.step[d]  = (config.max[d] - config.min[d]) / static_cast<double>(config.nodes[d] - 1);
+      grid.nodes[d] = config.nodes[d];
+    }
+    if (config.type == GridConfig::Type::kRZ && config.min[0] < 0) {
+      throw std::invalid_argument("Field grid cannot have negative r");
+    }
+    return grid;
+  }
+
+  std::array<double, 3> DD4hepBField::gridCoordinates(const Acts::Vector3& position) const
+  {
+    if (m_grid.type == GridConfig::Type::kRZ) {
+      return {std::hypot(position.x(), position.y()), position.z(), 0.};
+    }
+    return {position.x(), position.y(), position.z()};
+  }
+
+  Acts::Vector3 DD4hepBField::nodePosition(const std::array<size_t, 3>& idx) const
+  {
+    std::array<double, 3> q{};
+    for (size_t d = 0; d < 3; ++d) {
+      q[d] = m_grid.min[d] + static_cast<double>(idx[d]) * m_grid.step[d];
+    }
+    // (r, z) nodes are sampled at phi = 0, where (Bx, By) = (Br, Bphi)
+    if (m_grid.type == GridConfig::Type::kRZ) {
+      return {q[0], 0., q[1]};
+    }
+    return {q[0], q[1], q[2]};
+  }
+
+  bool DD4hepBField::locate(const std::array<double, 3>& q, Cache& cache) const
+  {
+    std::array<size_t, 3> idx{};
+    for (size_t d = 0; d < 3; ++d) {
+      if (m_grid.nodes[d] == 1) {
+        // unused axis
+        cache.lower[d] = -std::numeric_limits<double>::infinity();
+        cache.upper[d] = std::numeric_limits<double>::infinity();
+        continue;
+      }
+      const double u = (q[d] - m_grid.min[d]) / m_grid.step[d];
+      if (!(u >= 0.) || u > static_cast<double>(m_grid.nodes[d] - 1)) {
+        return false;
+      }
+      idx[d]         = std::min(static_cast<size_t>(u), m_grid.nodes[d] - 2);
+      cache.lower[d] = m_grid.min[d] + static_cast<double>(idx[d]) * m_grid.step[d];
+      cache.upper[d] = cache.lower[d] + m_grid.step[d];
+    }
+    for (size_t c = 0; c < 8; ++c) {
+      std::array<size_t, 3> node{};
+      for (size_t d = 0; d < 3; ++d) {
+        node[d] = idx[d] + ((m_grid.nodes[d] > 1 && (c & (1U << d))) ? 1 : 0);
+      }
+      cache.corners[c] =
+          m_grid.values[node[0] + m_grid.nodes[0] * (node[1] + m_grid.nodes[1] * node[2])];
+    }
+    cache.valid = true;
+    return true;
+  }
+
+  void DD4hepBField::sampleGrid(const GridConfig& config)
+  {
+    Grid grid = layout(config);
+    m_grid    = grid;
+    m_grid.values.clear();
+    std::vector<Acts::Vector3> values;
+    values.reserve(grid.nodes[0] * grid.nodes[1] * grid.nodes[2]);
+    for (size_t k = 0; k < grid.nodes[2]; ++k) {
+      for (size_t j = 0; j < grid.nodes[1]; ++j) {
+        for (size_t i = 0; i < grid.nodes[0]; ++i) {
+          values.push_back(directField(nodePosition({i, j, k})));
+        }
+      }
+    }
+    m_grid.values = std::move(values);
+  }
+
+  bool DD4hepBField::loadGrid(const std::string& fname, const GridConfig& config)
+  {
+    const Grid grid = layout(config);
+    std::ifstream is{fname, std::ios::binary};
+    if (!is) {
+      return false;
+    }
+    GridHeader header{};
+    is.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!is || header.magic != kGridMagic || header.version != kGridVersion ||
+        header.type != static_cast<uint32_t>(grid.type)) {
+      return false;
+    }
+    for (size_t d = 0; d < 3; ++d) {
+      if (header.nodes[d] != grid.nodes[d] || header.min[d] != grid.min[d] ||
+          header.step[d] != grid.step[d]) {
+        return false;
+      }
+    }
+    std::vector<Acts::Vector3> values(grid.nodes[0] * grid.nodes[1] * grid.nodes[2]);
+    for (auto& v : values) {
+      is.read(reinterpret_cast<char*>(v.data()), 3 * sizeof(double));
+    }
+    if (!is) {
+      return false;
+    }
+
+    // Spot check the nodes on a coarse 3x3x3 sub-grid against the DD4hep field, to catch
+    // files written for a different field
+    Grid saved = std::move(m_grid);
+    m_grid     = grid;
+    bool valid = true;
+    for (size_t c = 0; c < 27 && valid; ++c) {
+      std::array<size_t, 3> idx{};
+      size_t rem = c;
+      for (size_t d = 0; d < 3; ++d, rem /= 3) {
+        idx[d] = (rem % 3) * (grid.nodes[d] - 1) / 2;
+      }
+      const auto& v  = values[idx[0] + grid.nodes[0] * (idx[1] + grid.nodes[1] * idx[2])];
+      const auto ref = directField(nodePosition(idx));
+      valid          = (v - ref).norm() <= 1e-9 * Acts::UnitConstants::T + 1e-6 * ref.norm();
+    }
+    if (!valid) {
+      m_grid = std::move(saved);
+      return false;
+    }
+    m_grid.values = std::move(values);
+    return true;
+  }
+
+  bool DD4hepBField::saveGrid(const std::string& fname) const
+  {
+    if (!hasGrid()) {
+      return false;
+    }
+    GridHeader header{kGridMagic, kGridVersion, static_cast<uint32_t>(m_grid.type), {}, {}, {}};
+    for (size_t d = 0; d < 3; ++d) {
+      header.nodes[d] = m_grid.nodes[d];
+      header.min[d]   = m_grid.min[d];
+      header.step[d]  = m_grid.step[d];
+    }
+    // write to a temporary file first, so concurrent jobs never see a partial file
+    const std::string tmp = fname + "." + std::to_string(::getpid()) + ".tmp";
+    {
+      std::ofstream os{tmp, std::ios::binary | std::ios::trunc};
+      os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      for (const auto& v : m_grid.values) {
+        os.write(reinterpret_cast<const char*>(v.data()), 3 * sizeof(double));
+      }
+      if (!os.flush()) {
+        std::remove(tmp.c_str());
+        return false;
+      }
+    }
+    if (std::rename(tmp.c_str(), fname.c_str()) != 0) {
+      std::remove(tmp.c_str());
+      return false;
+    }
+    return true;
+  }
 } // namespace Jug::BField
@@ -7,8 +7,14 @@
 #include "GaudiKernel/ISvcLocator.h"
 
 #include "JugBase/DataWrapper.h"
+#include "JugBase/PrefetchReader.h"
 
+#include "TEnv.h"
+#include "TROOT.h"
 #include "TTree.h"
+#include "TTreeCache.h"
+
+#include <algorithm>
 
 /// Service initialization
 StatusCode PodioDataSvc::initialize() {
@@ -24,6 +30,14 @@ StatusCode PodioDataSvc::initialize() {
     m_filenames.push_back(m_filename);
   }
 
+  // the input tree picks up the cache settings when it is opened
+  if (m_treeCacheSize > 0) {
+    gEnv->SetValue("TTreeCache.Size", m_treeCacheSize);
+  }
+  if (m_treeCacheLearnEntries > 0) {
+    TTreeCache::SetLearnEntries(m_treeCacheLearnEntries);
+  }
+
   if (!m_filenames.empty()) {
     if (!m_filenames[0].empty()) {
       m_reader.openFiles(m_filenames);
@@ -46,12 +60,35 @@ StatusCode PodioDataSvc::reinitialize() {
 }
 /// Service finalization
 StatusCode PodioDataSvc::finalize() {
+  if (m_prefetch) {
+    info() << "Prefetching: waited for the input " << m_prefetch->stalls() << " times" << endmsg;
+    for (const auto& [name, count] : m_prefetch->misses()) {
+      warning() << "Collection " << name << " was not prefetched in " << count
+                << " events (add it to the input collections)" << endmsg;
+    }
+    m_prefetch.reset();
+    m_input = &m_reader;
+    m_provider.setReader(m_input);
+  }
+  if (m_collectionPoolSize > 0) {
+    info() << "Collection pool: " << m_nReused << " of " << m_nReused + m_nCreated
+           << " created collections were reused" << endmsg;
+  }
+  m_collectionPool.clear();
   m_cnvSvc = nullptr; // release
   DataSvc::finalize().ignore();
   return StatusCode::SUCCESS;
 }
 
 StatusCode PodioDataSvc::clearStore() {
+  ++m_generation;
+  // lazy collections that were never retrieved are dropped with the event
+  for (auto& lazy : m_lazyCollections) {
+    lazy.pending = false;
+  }
+  if (m_advanceReader) {
+    advanceReader();
+  }
   for (auto& collNamePair : m_collections) {
     if (collNamePair.second != nullptr) {
       collNamePair.second->clear();
@@ -62,6 +99,7 @@ StatusCode PodioDataSvc::clearStore() {
       collNamePair.second->clear();
     }
   }
+  recycleCollections();
   DataSvc::clearStore().ignore();
   m_collections.clear();
   m_readCollections.clear();
@@ -70,8 +108,14 @@ StatusCode PodioDataSvc::clearStore() {
 
 void PodioDataSvc::endOfRead() {
   if (m_eventMax != -1) {
-    m_provider.clearCaches();
-    m_reader.endOfEvent();
+    // the lazy collections still need to be read from the current entry
+    const bool pending = std::any_of(m_lazyCollections.begin(), m_lazyCollections.end(),
+                                     [](const auto& lazy) { return lazy.pending; });
+    if (pending) {
+      m_advanceReader = true;
+    } else {
+      advanceReader();
+    }
     if (m_eventNum++ > m_eventMax) {
       info() << "Reached end of file with event " << m_eventMax << endmsg;
       IEventProcessor* eventProcessor = nullptr;
@@ -83,6 +127,139 @@ void PodioDataSvc::endOfRead() {
   }
 }
 
+void PodioDataSvc::advanceReader() {
+  m_provider.clearCaches();
+  m_input->endOfEvent();
+  m_advanceReader = false;
+}
+
+StatusCode PodioDataSvc::setEntryRange(const unsigned first, const unsigned count,
+                                       const bool reopen) {
+  if (m_eventMax == -1 || m_prefetch || first + count > static_cast<unsigned>(m_eventMax)) {
+    return StatusCode::FAILURE;
+  }
+  if (reopen) {
+    m_reader.closeFile();
+    m_reader.openFiles(m_filenames);
+    setCollectionIDs(m_reader.getCollectionIDTable());
+  }
+  m_1stEvtEntry += first;
+  m_reader.goToEvent(m_1stEvtEntry);
+  m_eventMax = count;
+  return StatusCode::SUCCESS;
+}
+
+void PodioDataSvc::startPrefetch(const std::vector<std::string>& collections) {
+  if (m_prefetchDepth == 0 || m_eventMax == -1 || m_prefetch) {
+    return;
+  }
+  // the prefetch thread and the event loop both use ROOT
+  ROOT::EnableThreadSafety();
+  m_prefetch = std::make_unique<PrefetchReader>(m_reader, m_filenames, collections, m_1stEvtEntry,
+                                                m_prefetchDepth);
+  m_input    = m_prefetch.get();
+  m_provider.setReader(m_input);
+  info() << "Prefetching " << collections.size() << " collections, " << m_prefetchDepth
+         << " entries ahead" << endmsg;
+}
+
+void PodioDataSvc::setLazyCollections(const std::vector<std::string>& names,
+                                      const std::vector<int>& ids) {
+  m_lazyCollections.clear();
+  m_lazyIndex.clear();
+  for (size_t i = 0; i < names.size() && i < ids.size(); ++i) {
+    m_lazyIndex[names[i]] = m_lazyCollections.size();
+    m_lazyCollections.push_back({names[i], ids[i]});
+  }
+}
+
+void PodioDataSvc::registerLazyCollections() {
+  for (auto& lazy : m_lazyCollections) {
+    lazy.pending = true;
+  }
+}
+
+StatusCode PodioDataSvc::readPendingCollections(
+    const std::function<bool(const std::string&)>& select) {
+  for (auto& lazy : m_lazyCollections) {
+    if (lazy.pending && select(lazy.name)) {
+      if (readLazyCollection(lazy).isFailure()) {
+        return StatusCode::FAILURE;
+      }
+      ++lazy.nForOutput;
+    }
+  }
+  return StatusCode::SUCCESS;
+}
+
+StatusCode PodioDataSvc::readLazyCollection(LazyCollection& lazy) {
+  lazy.pending = false;
+  debug() << "Reading collection " << lazy.name << " on demand" << endmsg;
+  return readCollection(lazy.name, lazy.id);
+}
+
+StatusCode PodioDataSvc::retrieveObject(IRegistry* pDirectory, std::string_view path,
+                                        DataObject*& pObject) {
+  // collections live directly under /Event, and are retrieved by their full path
+  if (pDirectory == nullptr && !m_lazyCollections.empty()) {
+    std::string_view name = path;
+    if (name.substr(0, rootName().size()) == rootName()) {
+      name.remove_prefix(rootName().size());
+    }
+    if (!name.empty() && name.front() == '/') {
+      name.remove_prefix(1);
+    }
+    const auto it = m_lazyIndex.find(std::string(name));
+    if (it != m_lazyIndex.end() && m_lazyCollections[it->second].pending) {
+      auto& lazy = m_lazyCollections[it->second];
+      if (readLazyCollection(lazy).isFailure()) {
+        error() << "Failed to read collection " << lazy.name << endmsg;
+        return StatusCode::FAILURE;
+      }
+      ++lazy.nOnDemand;
+    }
+  }
+  return DataSvc::retrieveObject(pDirectory, path, pObject);
+}
+
+void PodioDataSvc::recycleCollections() {
+  for (auto* wrapper : m_createdWrappers) {
+    auto* collection = wrapper->collectionBase();
+    // subset collections stay subset collections when cleared
+    if (collection == nullptr || collection->isSubsetCollection()) {
+      continue;
+    }
+    auto& pool = m_collectionPool[std::type_index(typeid(*collection))];
+    if (pool.size() < m_collectionPoolSize) {
+      // the collection was cleared with the other collections of the event
+      pool.emplace_back(wrapper->releaseCollection());
+    }
+  }
+  m_createdWrappers.clear();
+}
+
+podio::CollectionBase* PodioDataSvc::reuseCollection(const std::type_info& type) {
+  auto it = m_collectionPool.find(std::type_index(type));
+  if (it == m_collectionPool.end() || it->second.empty()) {
+    ++m_nCreated;
+    return nullptr;
+  }
+  ++m_nReused;
+  auto* collection = it->second.back().release();
+  it->second.pop_back();
+  return collection;
+}
+
+PodioDataSvc::CollRegistry PodioDataSvc::releaseCollections() {
+  // the asynchronous writer owns them now
+  m_createdWrappers.clear();
+  CollRegistry collections = std::move(m_collections);
+  collections.insert(collections.end(), m_readCollections.begin(), m_readCollections.end());
+  m_collections.clear();
+  m_readCollections.clear();
+  return collections;
+}
+
 void PodioDataSvc::setCollectionIDs(CollectionIDTable_ptr collectionIds) {
   m_collectionIDs = collectionIds;
 }
@@ -93,9 +270,14 @@ PodioDataSvc::PodioDataSvc(const std::string& name, ISvcLocator* svc)
   m_eventDataTree = new TTree("events", "Events tree");
 }
 
+PodioDataSvc::~PodioDataSvc() = default;
+
 StatusCode PodioDataSvc::readCollection(const std::string& collectionName, int collectionID) {
   podio::CollectionBase* collection(nullptr);
-  m_provider.get(collectionID, collection);
+  if (!m_provider.get(collectionID, collection) || collection == nullptr) {
+    error() << "Cannot read collection " << collectionName << " from the input" << endmsg;
+    return StatusCode::FAILURE;
+  }
   if (collection->isSubsetCollection()) {
     return StatusCode::SUCCESS;
   }
@@ -118,6 +300,9 @@ StatusCode PodioDataSvc::registerObject(std::string_view parentPath, std::string
       const int id = m_collectionIDs->add(shortPath);
       coll->setID(id);
       m_collections.emplace_back(std::make_pair(shortPath, coll));
+      if (m_collectionPoolSize > 0) {
+        m_createdWrappers.push_back(wrapper);
+      }
     }
   }
   return DataSvc::registerObject(parentPath, fullPath, pObject);
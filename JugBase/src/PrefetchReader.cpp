@@ -0,0 +1,190 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Whitney Armstrong, Wouter Deconinck
+
+#include "JugBase/PrefetchReader.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+PrefetchReader::PrefetchReader(podio::ROOTReader& reader, std::vector<std::string> filenames,
+                               const std::vector<std::string>& collections,
+                               const unsigned firstEntry, const size_t depth)
+    : m_reader{reader}
+    , m_filenames{std::move(filenames)}
+    , m_table{m_reader.getCollectionIDTable()}
+    , m_version{m_reader.currentFileVersion()}
+    , m_entries{m_reader.getEntries()}
+    , m_valid{m_reader.isValid()}
+    , m_depth{std::max<size_t>(depth, 1)}
+    , m_collections(collections.begin(), collections.end())
+    , m_next{firstEntry} {
+  // the metadata are read up front, so the reader is only used by the prefetch thread
+  const std::unique_ptr<std::map<int, podio::GenericParameters>> colMD{
+      m_reader.readCollectionMetaData()};
+  if (colMD) {
+    m_colMD = *colMD;
+  }
+  const std::unique_ptr<std::map<int, podio::GenericParameters>> runMD{m_reader.readRunMetaData()};
+  if (runMD) {
+    m_runMD = *runMD;
+  }
+  m_thread = std::thread([this]() { run(); });
+}
+
+PrefetchReader::~PrefetchReader() {
+  stop();
+  for (auto& entry : m_staged) {
+    release(*entry);
+  }
+}
+
+void PrefetchReader::run() {
+  try {
+    while (true) {
+      std::vector<std::string> names;
+      unsigned entry = 0;
+      {
+        std::unique_lock<std::mutex> lock{m_mutex};
+        m_cv.wait(lock, [this]() { return m_stop || m_staged.size() < m_depth; });
+        if (m_stop) {
+          return;
+        }
+        if (m_next >= m_entries) {
+          m_done = true;
+          m_cv.notify_all();
+          return;
+        }
+        names.assign(m_collections.begin(), m_collections.end());
+        entry = m_next++;
+      }
+      // basket I/O and decompression happen here, off the event thread
+      auto staged   = std::make_unique<Entry>();
+      staged->entry = entry;
+      for (const auto& name : names) {
+        staged->collections[name] = m_reader.readCollection(name);
+      }
+      staged->evtMD.reset(m_reader.readEventMetaData());
+      m_reader.endOfEvent();
+      {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_staged.push_back(std::move(staged));
+      }
+      m_cv.notify_all();
+    }
+  } catch (const std::exception&) {
+    // the event thread sees the end of the input
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_done = true;
+    m_cv.notify_all();
+  }
+}
+
+void PrefetchReader::stop() {
+  if (!m_thread.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_stop = true;
+  }
+  m_cv.notify_all();
+  m_thread.join();
+  m_stop = false;
+  m_done = false;
+}
+
+PrefetchReader::Entry* PrefetchReader::current() {
+  std::unique_lock<std::mutex> lock{m_mutex};
+  if (m_staged.empty() && !m_done) {
+    ++m_stalls;
+    m_cv.wait(lock, [this]() { return !m_staged.empty() || m_done; });
+  }
+  // only the event thread removes entries, so the front stays valid
+  return m_staged.empty() ? nullptr : m_staged.front().get();
+}
+
+void PrefetchReader::release(Entry& entry) {
+  for (auto& [name, collection] : entry.collections) {
+    delete collection;
+  }
+  entry.collections.clear();
+}
+
+podio::CollectionBase* PrefetchReader::readCollection(const std::string& name) {
+  Entry* entry = current();
+  if (entry == nullptr) {
+    return nullptr;
+  }
+  // ownership passes to the caller, as for the ROOTReader
+  const auto it = entry->collections.find(name);
+  if (it != entry->collections.end()) {
+    auto* collection = it->second;
+    entry->collections.erase(it);
+    return collection;
+  }
+
+  // not prefetched: read it here, and prefetch it for the next entries
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_collections.insert(name);
+  }
+  ++m_misses[name];
+  if (!m_fallback) {
+    m_fallback = std::make_unique<podio::ROOTReader>();
+    m_fallback->openFiles(m_filenames);
+  }
+  podio::IReader& fallback = *m_fallback;
+  fallback.goToEvent(entry->entry);
+  return fallback.readCollection(name);
+}
+
+podio::GenericParameters* PrefetchReader::readEventMetaData() {
+  Entry* entry = current();
+  if (entry == nullptr || !entry->evtMD) {
+    return new podio::GenericParameters();
+  }
+  return entry->evtMD.release();
+}
+
+std::map<int, podio::GenericParameters>* PrefetchReader::readCollectionMetaData() {
+  return new std::map<int, podio::GenericParameters>(m_colMD);
+}
+
+std::map<int, podio::GenericParameters>* PrefetchReader::readRunMetaData() {
+  return new std::map<int, podio::GenericParameters>(m_runMD);
+}
+
+void PrefetchReader::endOfEvent() {
+  // consume exactly one entry per event, even if nothing was read from it
+  if (current() == nullptr) {
+    return;
+  }
+  std::unique_ptr<Entry> entry;
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    entry = std::move(m_staged.front());
+    m_staged.pop_front();
+  }
+  m_cv.notify_all();
+  release(*entry);
+}
+
+void PrefetchReader::goToEvent(const unsigned iEvent) {
+  stop();
+  for (auto& entry : m_staged) {
+    release(*entry);
+  }
+  m_staged.clear();
+  m_reader.goToEvent(iEvent);
+  m_next   = iEvent;
+  m_thread = std::thread([this]() { run(); });
+}
+
+void PrefetchReader::openFile(const std::string& /* filename */) {
+  throw std::logic_error("PrefetchReader: cannot open files while prefetching");
+}
+
+void PrefetchReader::closeFile() {
+  throw std::logic_error("PrefetchReader: cannot close files while prefetching");
+}
@@ -0,0 +1,149 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Whitney Armstrong, Sylvester Joosten
+
+#include "CellGeometrySvc.h"
+
+#include <algorithm>
+#include <mutex>
+
+#include "DDRec/CellIDPositionConverter.h"
+#include "TGeoMatrix.h"
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+DECLARE_COMPONENT(CellGeometrySvc)
+
+namespace {
+// cellIDs are bit fields, mix all bits into the low ones used for the slot
+inline uint64_t mix(uint64_t x) {
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  x ^= x >> 33;
+  return x;
+}
+} // namespace
+
+CellGeometrySvc::CellGeometrySvc(const std::string& name, ISvcLocator* svc) : base_class(name, svc) {}
+
+CellGeometrySvc::~CellGeometrySvc() = default;
+
+StatusCode CellGeometrySvc::initialize() {
+  StatusCode sc = Service::initialize();
+  if (!sc.isSuccess()) {
+    return sc;
+  }
+  m_geoSvc = service(m_geoSvcName);
+  if (!m_geoSvc) {
+    error() << "Unable to locate Geometry Service. "
+            << "Make sure you have GeoSvc and SimSvc in the right order in the configuration." << endmsg;
+    return StatusCode::FAILURE;
+  }
+  size_t nslots = 16;
+  while (nslots < m_initialSize) {
+    nslots *= 2;
+  }
+  rehash(nslots);
+  return StatusCode::SUCCESS;
+}
+
+StatusCode CellGeometrySvc::finalize() {
+  info() << "Cached " << m_cells.size() << " cells, " << m_nHits << " cached lookups, " << m_nMisses
+         << " DD4hep lookups" << endmsg;
+  return Service::finalize();
+}
+
+CellGeometrySvc::CellGeometry CellGeometrySvc::cell(const uint64_t cellID) const {
+  {
+    std::shared_lock<std::shared_mutex> lock{m_mutex};
+    if (const auto idx = find(cellID); idx >= 0) {
+      ++m_nHits;
+      return m_cells[idx];
+    }
+  }
+  ++m_nMisses;
+  // DD4hep lookups without holding the lock, another thread may have added the cell
+  // meanwhile, which is harmless
+  const auto geo = lookup(cellID);
+  std::unique_lock<std::shared_mutex> lock{m_mutex};
+  if (m_cells.size() < m_maxCells && find(cellID) < 0) {
+    insert(cellID, geo);
+  }
+  return geo;
+}
+
+CellGeometrySvc::CellGeometry CellGeometrySvc::lookup(const uint64_t cellID) const {
+  const auto converter = m_geoSvc->cellIDPositionConverter();
+  const auto* context  = converter->findContext(cellID);
+
+  CellGeometry geo;
+  geo.volumeID          = context->identifier;
+  geo.position          = converter->position(cellID);
+  geo.detElement        = context->element;
+  geo.localToGlobal     = &geo.detElement.nominal().worldTransformation();
+  geo.localPosition     = geo.detElement.nominal().worldToLocal(geo.position);
+  geo.placementPosition = context->volumePlacement().position();
+
+  std::vector<double> dims;
+  if (converter->findReadout(geo.detElement).segmentation().type() != "NoSegmentation") {
+    dims = converter->cellDimensions(cellID);
+  } else {
+    // Using bounding box instead of actual solid so the dimensions are always in dim_x, dim_y, dim_z
+    dims = context->volumePlacement().volume().boundingBox().dimensions();
+    std::transform(dims.begin(), dims.end(), dims.begin(), [](double d) { return 2 * d; });
+  }
+  geo.nDimensions = std::min(dims.size(), geo.dimensions.size());
+  std::copy_n(dims.begin(), geo.nDimensions, geo.dimensions.begin());
+
+  const auto& surfaces = m_geoSvc->surfaceMap();
+  if (const auto is = surfaces.find(geo.volumeID); is != surfaces.end()) {
+    geo.surface = is->second;
+  }
+  return geo;
+}
+
+int64_t CellGeometrySvc::find(const uint64_t cellID) const {
+  const size_t mask = m_slots.size() - 1;
+  for (size_t i = mix(cellID) & mask;; i = (i + 1) & mask) {
+    if (m_slots[i] == 0) {
+      return -1;
+    }
+    if (m_keys[i] == cellID) {
+      return m_slots[i] - 1;
+    }
+  }
+}
+
+void CellGeometrySvc::insert(const uint64_t cellID, const CellGeometry& geo) const {
+  // keep the load factor below 1/2
+  if (2 * (m_cells.size() + 1) > m_slots.size()) {
+    rehash(2 * m_slots.size());
+  }
+  m_cells.push_back(geo);
+  const size_t mask = m_slots.size() - 1;
+  size_t i          = mix(cellID) & mask;
+  while (m_slots[i] != 0) {
+    i = (i + 1) & mask;
+  }
+  m_keys[i]  = cellID;
+  m_slots[i] = static_cast<uint32_t>(m_cells.size());
+}
+
+void CellGeometrySvc::rehash(const size_t nslots) const {
+  std::vector<uint64_t> keys(nslots, 0);
+  std::vector<uint32_t> slots(nslots, 0);
+  const size_t mask = nslots - 1;
+  for (size_t j = 0; j < m_slots.size(); ++j) {
+    if (m_slots[j] == 0) {
+      continue;
+    }
+    size_t i = mix(m_keys[j]) & mask;
+    while (slots[i] != 0) {
+      i = (i + 1) & mask;
+    }
+    keys[i]  = m_keys[j];
+    slots[i] = m_slots[j];
+  }
+  m_keys.swap(keys);
+  m_slots.swap(slots);
+}
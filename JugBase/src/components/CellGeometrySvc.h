@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Whitney Armstrong, Sylvester Joosten
+
+#ifndef CELLGEOMETRYSVC_H
+#define CELLGEOMETRYSVC_H
+
+#include <atomic>
+#include <shared_mutex>
+#include <vector>
+
+#include "GaudiKernel/Service.h"
+
+#include "JugBase/ICellGeometrySvc.h"
+#include "JugBase/IGeoSvc.h"
+
+/** Cell geometry lookup service.
+ *
+ *  Lazily fills a flat open-addressing (linear probing) table from cellID to the cell
+ *  geometry, the first time a cell is requested. Lookups take a shared lock, only new cells
+ *  take the exclusive lock (after the DD4hep lookups are done), so the service can be used
+ *  from concurrent algorithms.
+ *
+ *  Cells beyond maxCells are still served, but no longer cached.
+ */
+class CellGeometrySvc : public extends<Service, ICellGeometrySvc> {
+public:
+  CellGeometrySvc(const std::string& name, ISvcLocator* svc);
+
+  virtual ~CellGeometrySvc();
+
+  virtual StatusCode initialize() final;
+  virtual StatusCode finalize() final;
+
+  virtual CellGeometry cell(uint64_t cellID) const final;
+
+private:
+  /// Do the DD4hep lookups for a cell
+  CellGeometry lookup(uint64_t cellID) const;
+  /// Index in m_cells for a cell, or -1 if not cached (call with the lock held)
+  int64_t find(uint64_t cellID) const;
+  /// Add a cell (call with the exclusive lock held)
+  void insert(uint64_t cellID, const CellGeometry& geo) const;
+  /// Grow the table to the given (power of 2) number of slots
+  void rehash(size_t nslots) const;
+
+  Gaudi::Property<std::string> m_geoSvcName{this, "geoServiceName", "GeoSvc"};
+  Gaudi::Property<size_t> m_initialSize{this, "initialSize", 1 << 16,
+                                        "Initial number of table slots (rounded up to a power of 2)"};
+  Gaudi::Property<size_t> m_maxCells{this, "maxCells", 1 << 24, "Maximum number of cached cells"};
+
+  SmartIF<IGeoSvc> m_geoSvc;
+
+  mutable std::shared_mutex m_mutex;
+  /// open-addressing table: cellID and (index + 1) in m_cells, 0 for an empty slot
+  mutable std::vector<uint64_t> m_keys;
+  mutable std::vector<uint32_t> m_slots;
+  mutable std::vector<CellGeometry> m_cells;
+
+  mutable std::atomic<size_t> m_nHits{0};
+  mutable std::atomic<size_t> m_nMisses{0};
+};
+
+#endif // CELLGEOMETRYSVC_H
@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Whitney Armstrong, Wouter Deconinck
+
+#include <chrono>
+
+#include <fmt/format.h>
+
+#include "GaudiAlg/GaudiAlgorithm.h"
+
+#include "JugBase/DataHandle.h"
+
+#include "edm4hep/MCParticleCollection.h"
+
+/** Test algorithm: microbenchmark of the DataHandle::get path (tests/options/datahandle_benchmark.py).
+ *
+ *  Every event it times the first get (store lookup), a number of repeated gets (cached for
+ *  the rest of the event with a PodioDataSvc), and the same number of plain retrieveObject
+ *  calls with the key of the handle, for comparison. The mean times are reported at finalize.
+ */
+class DataHandleBenchmark : public GaudiAlgorithm {
+public:
+  DataHandleBenchmark(const std::string& name, ISvcLocator* svcLoc)
+      : GaudiAlgorithm(name, svcLoc), m_particles("MCParticles", Gaudi::DataHandle::Reader, this) {
+    declareProperty("particles", m_particles, "Collection to read");
+  }
+
+  StatusCode execute() override {
+    using Clock = std::chrono::steady_clock;
+    const std::string& key = m_particles.fullKey().key();
+
+    const auto t0    = Clock::now();
+    const auto* coll = m_particles.get();
+    const auto t1    = Clock::now();
+    size_t found     = 0;
+    for (size_t i = 0; i < m_calls; ++i) {
+      found += (m_particles.get() == coll);
+    }
+    const auto t2 = Clock::now();
+    for (size_t i = 0; i < m_calls; ++i) {
+      DataObject* obj = nullptr;
+      found += evtSvc()->retrieveObject(key, obj).isSuccess();
+    }
+    const auto t3 = Clock::now();
+    if (found != 2 * m_calls) {
+      error() << "Inconsistent lookups of " << key << endmsg;
+      return StatusCode::FAILURE;
+    }
+
+    m_first += t1 - t0;
+    m_repeated += t2 - t1;
+    m_retrieve += t3 - t2;
+    ++m_events;
+    return StatusCode::SUCCESS;
+  }
+
+  StatusCode finalize() override {
+    if (m_events > 0) {
+      const auto ns = [](auto dt, const double n) {
+        return std::chrono::duration<double, std::nano>(dt).count() / n;
+      };
+      const double nCalls = static_cast<double>(m_events) * static_cast<double>(m_calls);
+      info() << fmt::format("DataHandle::get: first of the event {:.1f} ns, repeated {:.1f} ns; "
+                            "retrieveObject {:.1f} ns ({} events, {} calls per event)",
+                            ns(m_first, m_events), ns(m_repeated, nCalls),
+                            ns(m_retrieve, nCalls), m_events, m_calls.value())
+             << endmsg;
+    }
+    return GaudiAlgorithm::finalize();
+  }
+
+private:
+  DataHandle<edm4hep::MCParticleCollection> m_particles;
+  Gaudi::Property<size_t> m_calls{this, "calls", 10000, "Number of timed lookups per event"};
+
+  std::chrono::steady_clock::duration m_first{0};
+  std::chrono::steady_clock::duration m_repeated{0};
+  std::chrono::steady_clock::duration m_retrieve{0};
+  size_t m_events{0};
+};
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+DECLARE_COMPONENT(DataHandleBenchmark)
@@ -12,6 +12,14 @@ DECLARE_COMPONENT(EICDataSvc)
 EICDataSvc::EICDataSvc(const std::string& name, ISvcLocator* svc) : PodioDataSvc(name, svc) {
   declareProperty("inputs", m_filenames = {}, "Names of the files to read");
   declareProperty("input", m_filename = "", "Name of the file to read");
+  declareProperty("prefetchDepth", m_prefetchDepth = 0,
+                  "Number of entries to read ahead in a background thread (0: no prefetching)");
+  declareProperty("treeCacheSize", m_treeCacheSize = 0,
+                  "TTreeCache size as a multiple of the input cluster size (0: ROOT default)");
+  declareProperty("treeCacheLearnEntries", m_treeCacheLearnEntries = 0,
+                  "Entries for the TTreeCache to learn the branches that are read (0: ROOT default)");
+  declareProperty("collectionPoolSize", m_collectionPoolSize = 0,
+                  "Cleared collections kept per type for reuse in the next events (0: no pooling)");
 }
 
 /// Standard Destructor
@@ -0,0 +1,298 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Sylvester Joosten
+
+// Per-algorithm execution profiler, implemented as a Gaudi auditor so it covers every
+// algorithm in the sequence (GaudiAlgorithm components as well as the Jug::Algo::Algorithm
+// wrappers) without any code in the algorithms themselves. When auditing is disabled
+// (the default), the only cost is the flag check Gaudi already does around execute().
+//
+// Enable with e.g.
+//   from Configurables import AuditorSvc, ExecutionProfiler
+//   ApplicationMgr(AuditAlgorithms=True, ExtSvc=[AuditorSvc(Auditors=["ExecutionProfiler"])])
+//
+// Per algorithm and per event it records wall and (thread) CPU time, the summed size of the
+// podio input and output collections, and the change in allocated heap memory. At finalize
+// a summary table is printed and a JSON file with percentiles is written. With concurrent
+// events (Hive) the times stay per algorithm, but the memory change also includes the
+// allocations of the algorithms running at the same time.
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <malloc.h>
+
+#include <fmt/format.h>
+
+#include "GaudiKernel/Auditor.h"
+#include "GaudiKernel/DataObject.h"
+#include "GaudiKernel/IDataHandleHolder.h"
+#include "GaudiKernel/IDataProviderSvc.h"
+#include "GaudiKernel/ISvcLocator.h"
+
+#include "JugBase/DataWrapper.h"
+
+namespace {
+
+// Histogram with logarithmic bins, used to estimate percentiles without keeping all samples.
+// Bins are 2% wide, starting at kMin; values below kMin end up in the first bin.
+class LogHistogram {
+public:
+  static constexpr double kMin   = 1e-7;
+  static constexpr double kRatio = 1.02;
+  static constexpr size_t kNBins = 1500;
+
+  void add(const double x) {
+    const size_t bin =
+        (x <= kMin) ? 0 : std::min<size_t>(std::log(x / kMin) / std::log(kRatio), kNBins - 1);
+    ++m_bins[bin];
+    ++m_count;
+    m_sum += x;
+    m_max = std::max(m_max, x);
+  }
+  // Returns the (geometric) bin center of the requested quantile, bounded by the maximum
+  double quantile(const double q) const {
+    const auto target = static_cast<uint64_t>(std::ceil(q * m_count));
+    uint64_t seen     = 0;
+    for (size_t i = 0; i < kNBins; ++i) {
+      seen += m_bins[i];
+      if (seen >= target && seen > 0) {
+        return std::min(kMin * std::pow(kRatio, i + 0.5), m_max);
+      }
+    }
+    return m_max;
+  }
+  double mean() const { return m_count ? m_sum / m_count : 0.; }
+  double max() const { return m_max; }
+  uint64_t count() const { return m_count; }
+
+private:
+  std::array<uint64_t, kNBins> m_bins{};
+  uint64_t m_count = 0;
+  double m_sum     = 0;
+  double m_max     = 0;
+};
+
+// Simple running mean/max for quantities where percentiles are not needed
+class Summary {
+public:
+  void add(const double x) {
+    m_max = (m_count == 0) ? x : std::max(m_max, x);
+    m_sum += x;
+    ++m_count;
+  }
+  double mean() const { return m_count ? m_sum / m_count : 0.; }
+  double max() const { return m_max; }
+
+private:
+  uint64_t m_count = 0;
+  double m_sum     = 0;
+  double m_max     = 0;
+};
+
+double wallTime() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+double cpuTime() {
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+// Heap memory currently in use (small allocations + mmapped chunks)
+int64_t allocatedBytes() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  const auto mi = mallinfo2();
+#else
+  const auto mi = mallinfo();
+#endif
+  return static_cast<int64_t>(mi.uordblks) + static_cast<int64_t>(mi.hblkhd);
+}
+
+} // namespace
+
+class ExecutionProfiler : public Auditor {
+public:
+  ExecutionProfiler(const std::string& name, ISvcLocator* svcLoc) : Auditor(name, svcLoc) {}
+
+  StatusCode initialize() override {
+    if (Auditor::initialize().isFailure()) {
+      return StatusCode::FAILURE;
+    }
+    m_eds = serviceLocator()->service("EventDataSvc");
+    if (!m_eds) {
+      warning() << "No EventDataSvc available, collection sizes will not be recorded" << endmsg;
+    }
+    return StatusCode::SUCCESS;
+  }
+
+  void beforeExecute(INamedInterface* alg) override {
+    Snapshot s;
+    s.nInput = collectionSize(alg, /* output */ false);
+    if (m_measureMemory) {
+      s.alloc = allocatedBytes();
+    }
+    auto& stack = threadStack();
+    // take the timestamps last so we do not measure our own overhead
+    s.cpu  = cpuTime();
+    s.wall = wallTime();
+    stack.push_back(s);
+  }
+
+  void afterExecute(INamedInterface* alg, const StatusCode&) override {
+    const double wall = wallTime();
+    const double cpu  = cpuTime();
+    auto& stack       = threadStack();
+    if (stack.empty()) {
+      return;
+    }
+    const Snapshot s = stack.back();
+    stack.pop_back();
+    const size_t nOutput = collectionSize(alg, /* output */ true);
+    const int64_t alloc  = m_measureMemory ? allocatedBytes() - s.alloc : 0;
+
+    std::lock_guard<std::mutex> lock{m_mutex};
+    auto it = m_records.find(alg);
+    if (it == m_records.end()) {
+      it = m_records.emplace(alg, Record{alg->name(), m_records.size()}).first;
+    }
+    Record& r = it->second;
+    r.wall.add(wall - s.wall);
+    r.cpu.add(cpu - s.cpu);
+    r.nInput.add(s.nInput);
+    r.nOutput.add(nOutput);
+    if (m_measureMemory) {
+      r.alloc.add(alloc);
+    }
+  }
+
+  StatusCode finalize() override {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    std::vector<const Record*> records;
+    for (const auto& [alg, r] : m_records) {
+      records.push_back(&r);
+    }
+    std::sort(records.begin(), records.end(),
+              [](const auto* a, const auto* b) { return a->index < b->index; });
+
+    info() << "Execution profile (times in ms, memory in kB):\n"
+           << fmt::format("{:<40} {:>8} {:>9} {:>9} {:>9} {:>9} {:>9} {:>9} {:>10} {:>10}",
+                          "algorithm", "events", "wall", "w-p50", "w-p99", "cpu", "c-p99",
+                          "inputs", "outputs", "alloc")
+           << endmsg;
+    for (const auto* r : records) {
+      info() << fmt::format(
+                    "{:<40} {:>8} {:>9.3f} {:>9.3f} {:>9.3f} {:>9.3f} {:>9.3f} {:>9.1f} {:>10.1f} "
+                    "{:>10.1f}",
+                    r->name.substr(0, 40), r->wall.count(), 1e3 * r->wall.mean(),
+                    1e3 * r->wall.quantile(.5), 1e3 * r->wall.quantile(.99), 1e3 * r->cpu.mean(),
+                    1e3 * r->cpu.quantile(.99), r->nInput.mean(), r->nOutput.mean(),
+                    r->alloc.mean() / 1024.)
+             << endmsg;
+    }
+
+    if (!m_outputFile.empty()) {
+      std::ofstream json(m_outputFile.value());
+      if (!json) {
+        error() << "Unable to open " << m_outputFile.value() << " for writing" << endmsg;
+        return StatusCode::FAILURE;
+      }
+      writeJSON(json, records);
+      info() << "Execution profile written to " << m_outputFile.value() << endmsg;
+    }
+    return Auditor::finalize();
+  }
+
+private:
+  struct Snapshot {
+    double wall   = 0;
+    double cpu    = 0;
+    int64_t alloc = 0;
+    size_t nInput = 0;
+  };
+  struct Record {
+    std::string name;
+    size_t index; // order of first execution
+    LogHistogram wall;
+    LogHistogram cpu;
+    Summary nInput;
+    Summary nOutput;
+    Summary alloc;
+  };
+
+  // The open measurements of the calling thread. Only that thread uses the stack, and the map
+  // nodes are stable, so the lock is only needed for the lookup.
+  std::vector<Snapshot>& threadStack() {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    return m_stacks[std::this_thread::get_id()];
+  }
+
+  // Summed size of all podio collections attached to the input (or output) handles. Uses
+  // findObject, so collections that are not in the store (e.g. lazy input collections that were
+  // not read yet) are skipped instead of read outside of the timed region.
+  size_t collectionSize(INamedInterface* alg, const bool output) {
+    auto* holder = dynamic_cast<IDataHandleHolder*>(alg);
+    if (!holder || !m_eds) {
+      return 0;
+    }
+    size_t n = 0;
+    for (const auto* handle : (output ? holder->outputHandles() : holder->inputHandles())) {
+      DataObject* obj = nullptr;
+      if (m_eds->findObject(handle->fullKey().key(), obj).isFailure() || obj == nullptr) {
+        continue;
+      }
+      if (auto* dw = dynamic_cast<DataWrapperBase*>(obj)) {
+        if (const auto* coll = dw->collectionBase()) {
+          n += coll->size();
+        }
+      }
+    }
+    return n;
+  }
+
+  static void writeJSON(std::ostream& os, const std::vector<const Record*>& records) {
+    const auto times = [](const LogHistogram& h) {
+      return fmt::format(
+          R"({{"mean": {:.6g}, "p50": {:.6g}, "p90": {:.6g}, "p99": {:.6g}, "max": {:.6g}}})",
+          1e3 * h.mean(), 1e3 * h.quantile(.5), 1e3 * h.quantile(.9), 1e3 * h.quantile(.99),
+          1e3 * h.max());
+    };
+    const auto summary = [](const Summary& s) {
+      return fmt::format(R"({{"mean": {:.6g}, "max": {:.6g}}})", s.mean(), s.max());
+    };
+    os << "{\n  \"algorithms\": [";
+    for (size_t i = 0; i < records.size(); ++i) {
+      const auto& r = *records[i];
+      os << (i ? ",\n" : "\n")
+         << fmt::format(R"(    {{"name": "{}", "events": {}, "wall_ms": {}, "cpu_ms": {}, )"
+                        R"("input_size": {}, "output_size": {}, "alloc_bytes": {}}})",
+                        r.name, r.wall.count(), times(r.wall), times(r.cpu), summary(r.nInput),
+                        summary(r.nOutput), summary(r.alloc));
+    }
+    os << "\n  ]\n}\n";
+  }
+
+  Gaudi::Property<std::string> m_outputFile{this, "OutputFile", "execution_profile.json",
+                                            "JSON output file (empty for no file)"};
+  Gaudi::Property<bool> m_measureMemory{this, "MeasureMemory", true,
+                                        "Record the change in allocated heap memory"};
+
+  SmartIF<IDataProviderSvc> m_eds;
+  // algorithms can be nested (sequencers), hence a stack of open measurements per thread
+  // (algorithms of different events run concurrently with Hive)
+  std::mutex m_mutex;
+  std::map<std::thread::id, std::vector<Snapshot>> m_stacks;
+  std::map<const INamedInterface*, Record> m_records;
+};
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+DECLARE_COMPONENT(ExecutionProfiler)
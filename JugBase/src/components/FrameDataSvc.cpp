@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Whitney Armstrong, Wouter Deconinck
+
+#include "FrameDataSvc.h"
+
+#if podio_VERSION_MAJOR > 0 || podio_VERSION_MINOR >= 16
+
+#include "JugBase/DataWrapper.h"
+
+#include <memory>
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+DECLARE_COMPONENT(FrameDataSvc)
+
+FrameDataSvc::FrameDataSvc(const std::string& name, ISvcLocator* svc) : DataSvc(name, svc) {}
+
+FrameDataSvc::~FrameDataSvc() = default;
+
+StatusCode FrameDataSvc::registerObject(std::string_view parentPath, std::string_view fullPath,
+                                        DataObject* pObject) {
+  auto* wrapper = dynamic_cast<DataWrapperBase*>(pObject);
+  if (wrapper != nullptr && wrapper->collectionBase() != nullptr) {
+    auto* eventFrame = frame();
+    if (eventFrame == nullptr) {
+      return StatusCode::FAILURE;
+    }
+    const size_t pos = fullPath.find_last_of('/');
+    const std::string name(fullPath.substr(pos + 1));
+    // the frame owns the collection from now on
+    eventFrame->put(std::unique_ptr<podio::CollectionBase>(wrapper->releaseCollection()), name);
+  }
+  return DataSvc::registerObject(parentPath, fullPath, pObject);
+}
+
+StatusCode FrameDataSvc::setFrame(podio::Frame&& frame,
+                                  const std::vector<std::string>& collections) {
+  auto frameWrapper   = std::make_unique<FrameWrapper>(std::move(frame));
+  podio::Frame& event = frameWrapper->getData();
+  if (DataSvc::registerObject(rootName(), "/" + m_frameName.value(), frameWrapper.get())
+          .isFailure()) {
+    error() << "Cannot register the frame of the event" << endmsg;
+    return StatusCode::FAILURE;
+  }
+  frameWrapper.release();
+
+  for (const auto& name : collections) {
+    // the frame unpacks the collection on first access
+    const auto* collection = event.get(name);
+    if (collection == nullptr) {
+      error() << "Collection " << name << " is not in the input" << endmsg;
+      return StatusCode::FAILURE;
+    }
+    auto wrapper = std::make_unique<DataWrapper<podio::CollectionBase>>();
+    wrapper->setData(const_cast<podio::CollectionBase*>(collection));
+    wrapper->releaseCollection();
+    if (DataSvc::registerObject(rootName(), "/" + name, wrapper.get()).isFailure()) {
+      error() << "Cannot register collection " << name << endmsg;
+      return StatusCode::FAILURE;
+    }
+    wrapper.release();
+  }
+  return StatusCode::SUCCESS;
+}
+
+podio::Frame* FrameDataSvc::frame() {
+  DataObject* obj = nullptr;
+  const std::string path = rootName() + "/" + m_frameName.value();
+  if (DataSvc::retrieveObject(nullptr, path, obj).isSuccess()) {
+    auto* frameWrapper = dynamic_cast<FrameWrapper*>(obj);
+    return (frameWrapper != nullptr) ? &frameWrapper->getData() : nullptr;
+  }
+  // no input frame (e.g. generating events), start an empty one
+  auto frameWrapper = std::make_unique<FrameWrapper>(podio::Frame());
+  auto* event       = &frameWrapper->getData();
+  if (DataSvc::registerObject(rootName(), "/" + m_frameName.value(), frameWrapper.get())
+          .isFailure()) {
+    error() << "Cannot register the frame of the event" << endmsg;
+    return nullptr;
+  }
+  frameWrapper.release();
+  return event;
+}
+
+podio::Frame FrameDataSvc::takeFrame() {
+  auto* event = frame();
+  if (event == nullptr) {
+    return podio::Frame();
+  }
+  podio::Frame taken = std::move(*event);
+  *event             = podio::Frame();
+  return taken;
+}
+
+#endif
@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Whitney Armstrong, Wouter Deconinck
+
+#ifndef JUGBASE_FRAMEDATASVC_H
+#define JUGBASE_FRAMEDATASVC_H
+
+// podio::Frame is available from podio 0.16
+#if podio_VERSION_MAJOR > 0 || podio_VERSION_MINOR >= 16
+
+#include <GaudiKernel/AnyDataWrapper.h>
+#include <GaudiKernel/DataSvc.h>
+
+#include <podio/Frame.h>
+
+#include <string>
+#include <vector>
+
+/** Event data service based on podio Frames.
+ *
+ *  Every event owns a podio::Frame, stored in the event store itself. Collections that are
+ *  registered in the store (e.g. through DataHandle::createAndPut) are moved into the frame of
+ *  the event, and the store only keeps non-owning wrappers. Nothing is shared between events,
+ *  so the reading (PodioFrameInput) and writing (PodioFrameOutput) of frames can happen
+ *  independently of the event being processed.
+ *
+ *  \ingroup base
+ */
+class FrameDataSvc : public DataSvc {
+public:
+  using FrameWrapper = AnyDataWrapper<podio::Frame>;
+
+  FrameDataSvc(const std::string& name, ISvcLocator* svc);
+  virtual ~FrameDataSvc();
+
+  // Use DataSvc functionality except where we override
+  using DataSvc::registerObject;
+  /// Register an object, moving podio collections into the frame of the event
+  virtual StatusCode registerObject(std::string_view parentPath, std::string_view fullPath,
+                                    DataObject* pObject) override final;
+
+  /// Install the (read) frame of the current event, and register the given collections of it
+  StatusCode setFrame(podio::Frame&& frame, const std::vector<std::string>& collections);
+  /// Frame of the current event, created if needed (nullptr on failure)
+  podio::Frame* frame();
+  /** Take the frame of the current event, e.g. to write it out. The collections in the store
+   *  point to the collections of the taken frame, so this should happen at the end of the event.
+   */
+  podio::Frame takeFrame();
+
+private:
+  Gaudi::Property<std::string> m_frameName{this, "frameName", "PodioFrame",
+                                           "Name of the event frame in the event store"};
+};
+
+#endif
+#endif
@@ -2,12 +2,17 @@
 // Copyright (C) 2022 Whitney Armstrong, Wouter Deconinck
 
 #include "GeoSvc.h"
+#include "GeometryCache.h"
 #include "GaudiKernel/Service.h"
 //#include "GeoConstruction.h"
 #include "TGeoManager.h"
 
 #include "DD4hep/Printout.h"
 
+#include <chrono>
+#include <cmath>
+#include <random>
+
 #include "JugBase/ACTSLogger.h"
 #include "JugBase/Acts/MaterialWiper.hpp"
 
@@ -105,14 +110,29 @@ StatusCode GeoSvc::initialize() {
     m_actsLoggingLevel = im->second;
   }
 
+  // Optional on-disk cache of the CBOR material map
+  std::unique_ptr<GeometryCache> cache;
+  if (!m_cacheDirectory.value().empty()) {
+    cache = std::make_unique<GeometryCache>(m_cacheDirectory.value());
+  }
+
   // Load ACTS materials maps
   if (m_jsonFileName.size() > 0) {
-    m_log << MSG::INFO << "loading materials map from file:  '" << m_jsonFileName << "'" << endmsg;
+    std::string materialFile = m_jsonFileName;
+    if (cache) {
+      // parsing the CBOR copy is a lot faster than parsing the JSON
+      if (auto cached = cache->materialFile(m_jsonFileName); !cached.empty()) {
+        materialFile = cached;
+      } else {
+        m_log << MSG::WARNING << "could not cache materials map, using JSON-file" << endmsg;
+      }
+    }
+    m_log << MSG::INFO << "loading materials map from file:  '" << materialFile << "'" << endmsg;
     // Set up the converter first
     Acts::MaterialMapJsonConverter::Config jsonGeoConvConfig;
     // Set up the json-based decorator
     m_materialDeco = std::make_shared<const Acts::JsonMaterialDecorator>(
-      jsonGeoConvConfig, m_jsonFileName, m_actsLoggingLevel);
+      jsonGeoConvConfig, materialFile, m_actsLoggingLevel);
   } else {
     m_log << MSG::WARNING << "no ACTS materials map has been loaded" << endmsg;
     m_materialDeco = std::make_shared<const Acts::MaterialWiper>();
@@ -140,7 +160,6 @@ StatusCode GeoSvc::initialize() {
       m_materialDeco);
   // Visit surfaces
   if (m_trackingGeo) {
-    draw_surfaces(m_trackingGeo, m_trackingGeoCtx, "tracking_geometry.obj");
     debug() << "visiting all the surfaces  " << endmsg;
     m_trackingGeo->visitSurfaces([this](const Acts::Surface* surface) {
       // for now we just require a valid surface
@@ -168,10 +187,19 @@ StatusCode GeoSvc::initialize() {
       }
       this->m_surfaces.insert_or_assign(vol_id, surface);
     });
+
+    if (!m_objFileName.value().empty()) {
+      m_log << MSG::INFO << "writing tracking surfaces to '" << m_objFileName << "'" << endmsg;
+      draw_surfaces(m_trackingGeo, m_trackingGeoCtx, m_objFileName);
+    }
   }
 
   // Load ACTS magnetic field
-  m_magneticField = std::make_shared<const Jug::BField::DD4hepBField>(m_dd4hepGeo);
+  auto field = std::make_shared<Jug::BField::DD4hepBField>(m_dd4hepGeo);
+  if (buildFieldGrid(*field).isFailure()) {
+    return StatusCode::FAILURE;
+  }
+  m_magneticField = field;
   Acts::MagneticFieldContext m_fieldctx{Jug::BField::BFieldVariant(m_magneticField)};
   auto bCache = m_magneticField->makeCache(m_fieldctx);
   for (int z : {0, 1000, 2000, 4000}) {
@@ -182,6 +210,98 @@ StatusCode GeoSvc::initialize() {
   return StatusCode::SUCCESS;
 }
 
+StatusCode GeoSvc::buildFieldGrid(Jug::BField::DD4hepBField& field) {
+  using GridConfig = Jug::BField::DD4hepBField::GridConfig;
+  if (m_fieldGrid.value().empty()) {
+    return StatusCode::SUCCESS;
+  }
+  GridConfig config;
+  if (m_fieldGrid.value() == "rz") {
+    config.type = GridConfig::Type::kRZ;
+  } else if (m_fieldGrid.value() == "xyz") {
+    config.type = GridConfig::Type::kXYZ;
+  } else {
+    error() << "Unknown magnetic field grid type '" << m_fieldGrid << "' (rz, xyz)" << endmsg;
+    return StatusCode::FAILURE;
+  }
+  config.min   = m_fieldGridMin;
+  config.max   = m_fieldGridMax;
+  config.nodes = m_fieldGridNodes;
+
+  try {
+    if (!m_fieldGridFile.value().empty() && field.loadGrid(m_fieldGridFile, config)) {
+      info() << "Loaded magnetic field grid from '" << m_fieldGridFile << "'" << endmsg;
+    } else {
+      const auto start = std::chrono::steady_clock::now();
+      field.sampleGrid(config);
+      const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      info() << "Sampled magnetic field on " << field.gridSize() << " " << m_fieldGrid
+             << " grid nodes in " << elapsed.count() << " s" << endmsg;
+      if (!m_fieldGridFile.value().empty() && !field.saveGrid(m_fieldGridFile)) {
+        warning() << "Could not store magnetic field grid in '" << m_fieldGridFile << "'" << endmsg;
+      }
+    }
+  } catch (const std::invalid_argument& e) {
+    error() << "Invalid magnetic field grid: " << e.what() << endmsg;
+    return StatusCode::FAILURE;
+  }
+
+  if (m_fieldGridCheck) {
+    checkFieldGrid(field);
+  }
+  return StatusCode::SUCCESS;
+}
+
+// Accuracy and speed versus the direct field, for stepper-like queries: straight lines
+// from the origin in 1 mm steps, in random directions
+void GeoSvc::checkFieldGrid(const Jug::BField::DD4hepBField& field) {
+  constexpr size_t kLines = 200;
+  constexpr size_t kSteps = 2000;
+  std::mt19937 gen{12345};
+  std::uniform_real_distribution<double> uphi{-M_PI, M_PI};
+  std::uniform_real_distribution<double> ucost{-1., 1.};
+  std::vector<Acts::Vector3> points;
+  points.reserve(kLines * kSteps);
+  for (size_t i = 0; i < kLines; ++i) {
+    const double phi  = uphi(gen);
+    const double cost = ucost(gen);
+    const double sint = std::sqrt(1. - cost * cost);
+    const Acts::Vector3 dir{sint * std::cos(phi), sint * std::sin(phi), cost};
+    for (size_t j = 0; j < kSteps; ++j) {
+      points.emplace_back(static_cast<double>(j) * Acts::UnitConstants::mm * dir);
+    }
+  }
+  Acts::MagneticFieldContext fieldCtx;
+  auto cache = field.makeCache(fieldCtx);
+  std::vector<Acts::Vector3> interpolated;
+  std::vector<Acts::Vector3> direct;
+  interpolated.reserve(points.size());
+  direct.reserve(points.size());
+  const auto t0 = std::chrono::steady_clock::now();
+  for (const auto& p : points) {
+    direct.push_back(field.directField(p));
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  for (const auto& p : points) {
+    interpolated.push_back(field.getField(p, cache).value());
+  }
+  const auto t2 = std::chrono::steady_clock::now();
+  double maxDiff = 0;
+  double sumDiff = 0;
+  for (size_t i = 0; i < points.size(); ++i) {
+    const double diff = (interpolated[i] - direct[i]).norm();
+    maxDiff           = std::max(maxDiff, diff);
+    sumDiff += diff;
+  }
+  const auto nsPerCall = [n = points.size()](auto dt) {
+    return std::chrono::duration<double, std::nano>(dt).count() / static_cast<double>(n);
+  };
+  info() << "Magnetic field grid: |B_grid - B_direct| mean "
+         << sumDiff / static_cast<double>(points.size()) / Acts::UnitConstants::T << " T, max "
+         << maxDiff / Acts::UnitConstants::T << " T; " << nsPerCall(t1 - t0)
+         << " ns/query direct, " << nsPerCall(t2 - t1) << " ns/query interpolated" << endmsg;
+}
+
 StatusCode GeoSvc::finalize() { return StatusCode::SUCCESS; }
 
 StatusCode GeoSvc::buildDD4HepGeo() {
@@ -43,7 +43,7 @@
  *  This is useful for debugging the ACTS geometry. The obj file can
  *  be loaded into various tools, such as FreeCAD, for inspection.
  */
-void draw_surfaces(std::shared_ptr<const Acts::TrackingGeometry> trk_geo, const std::string& fname);
+void draw_surfaces(std::shared_ptr<const Acts::TrackingGeometry> trk_geo, const Acts::GeometryContext geo_ctx, const std::string& fname);
 
 class GeoSvc : public extends<Service, IGeoSvc> {
 public:
@@ -89,6 +89,30 @@ private:
   Gaudi::Property<std::string> m_jsonFileName{
       this, "materials", "", "Material map JSON-file"};
 
+  /// Directory for the CBOR copy of the material map, which loads faster than the JSON-file.
+  /// Only the material map is cached, the conversion of the geometry to Acts is not sped up.
+  Gaudi::Property<std::string> m_cacheDirectory{
+      this, "cacheDirectory", "",
+      "CBOR copy of the material map (does not speed up the geometry conversion, no copy if empty)"};
+
+  /// Optional interpolation grid for the magnetic field
+  Gaudi::Property<std::string> m_fieldGrid{
+      this, "fieldGrid", "", "Magnetic field grid type: rz, xyz, or empty for the direct field"};
+  Gaudi::Property<std::vector<double>> m_fieldGridMin{
+      this, "fieldGridMin", {0., -4500.}, "Field grid minimum (r, z) or (x, y, z) [mm]"};
+  Gaudi::Property<std::vector<double>> m_fieldGridMax{
+      this, "fieldGridMax", {2000., 4500.}, "Field grid maximum (r, z) or (x, y, z) [mm]"};
+  Gaudi::Property<std::vector<size_t>> m_fieldGridNodes{
+      this, "fieldGridNodes", {201, 901}, "Number of field grid nodes along (r, z) or (x, y, z)"};
+  Gaudi::Property<std::string> m_fieldGridFile{
+      this, "fieldGridFile", "", "File to load/store the field grid (not stored if empty)"};
+  Gaudi::Property<bool> m_fieldGridCheck{
+      this, "fieldGridCheck", false, "Compare the field grid to the direct field (slow)"};
+
+  /// OBJ-file to dump the tracking surfaces to
+  Gaudi::Property<std::string> m_objFileName{
+      this, "surfacesObjFile", "", "Dump the tracking surfaces to this OBJ-file (if set)"};
+
   /// Gaudi logging output
   MsgStream m_log;
 
@@ -106,6 +130,16 @@ public:
    */
   StatusCode buildDD4HepGeo();
 
+  /** Set up the magnetic field grid (if configured).
+   *  Loads the grid from file or samples the DD4hep field.
+   */
+  StatusCode buildFieldGrid(Jug::BField::DD4hepBField& field);
+
+  /** Report the interpolation accuracy and speed of the field grid.
+   *  Compares 400k queries to the direct DD4hep field (if fieldGridCheck is set).
+   */
+  void checkFieldGrid(const Jug::BField::DD4hepBField& field);
+
   /** Get the top level DetElement.
    *   DD4hep Geometry
    */
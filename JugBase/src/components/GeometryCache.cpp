@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Whitney Armstrong, Wouter Deconinck
+
+#include "GeometryCache.h"
+
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+GeometryCache::Hash& GeometryCache::Hash::add(const void* data, size_t size) {
+  const auto* bytes = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    m_value ^= bytes[i];
+    m_value *= 1099511628211ULL;
+  }
+  return *this;
+}
+
+GeometryCache::GeometryCache(std::string_view directory) : m_directory{directory} {
+  if (!m_directory.empty() && m_directory.back() == '/') {
+    m_directory.pop_back();
+  }
+}
+
+// Keyed by the file metadata, so a cache hit does not need to read the (large) JSON file
+std::string GeometryCache::materialFile(const std::string& jsonFile) const {
+  struct stat st {};
+  char resolved[PATH_MAX];
+  if (::stat(jsonFile.c_str(), &st) != 0 || ::realpath(jsonFile.c_str(), resolved) == nullptr) {
+    return {};
+  }
+  const uint64_t key = Hash()
+                           .add(std::string_view{resolved})
+                           .add(static_cast<int64_t>(st.st_size))
+                           .add(static_cast<int64_t>(st.st_mtim.tv_sec))
+                           .add(static_cast<int64_t>(st.st_mtim.tv_nsec))
+                           .value();
+  const auto fname = path("material", key, "cbor");
+  if (::access(fname.c_str(), R_OK) == 0) {
+    return fname;
+  }
+  try {
+    std::ifstream is{jsonFile};
+    if (!is) {
+      return {};
+    }
+    const auto cbor = nlohmann::json::to_cbor(nlohmann::json::parse(is));
+    if (!write(fname, {reinterpret_cast<const char*>(cbor.data()), cbor.size()})) {
+      return {};
+    }
+  } catch (const nlohmann::json::exception&) {
+    return {};
+  }
+  return fname;
+}
+
+std::string GeometryCache::path(std::string_view prefix, const uint64_t key,
+                                std::string_view ext) const {
+  return fmt::format("{}/{}-{:016x}.{}", m_directory, prefix, key, ext);
+}
+
+// Write to a private temporary file first, and atomically move it in place. Concurrent
+// writers produce identical files, so it does not matter who wins.
+bool GeometryCache::write(const std::string& fname, gsl::span<const char> data) const {
+  ::mkdir(m_directory.c_str(), 0755);
+  const auto tmp = fmt::format("{}.{}.tmp", fname, ::getpid());
+  {
+    std::ofstream os{tmp, std::ios::binary | std::ios::trunc};
+    os.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!os.flush()) {
+      std::remove(tmp.c_str());
+      return false;
+    }
+  }
+  if (std::rename(tmp.c_str(), fname.c_str()) != 0) {
+    std::remove(tmp.c_str());
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Whitney Armstrong, Wouter Deconinck
+
+#ifndef GEOMETRYCACHE_H
+#define GEOMETRYCACHE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "gsl/gsl"
+
+/** On-disk cache of the material map of the tracking geometry.
+ *
+ *  The cache lives in a (node-local) directory. Files are written to a temporary file and
+ *  atomically renamed, so concurrent jobs on the same node can share the directory.
+ *
+ *  Only the material map is cached. It is converted from JSON to the (much faster to parse)
+ *  CBOR format that the Acts::JsonMaterialDecorator also accepts, and keyed by the path, size
+ *  and modification time of the JSON file. The DD4hep geometry and its conversion to the Acts
+ *  tracking geometry are not cached, they take the same time with or without the cache.
+ *
+ *  \ingroup base
+ *  \ingroup geosvc
+ */
+class GeometryCache {
+public:
+  /// 64-bit FNV-1a hash, used to build the cache keys
+  class Hash {
+  public:
+    Hash& add(const void* data, size_t size);
+    Hash& add(std::string_view str) { return add(str.data(), str.size()); }
+    template <class T> Hash& add(const T& value) { return add(&value, sizeof(T)); }
+    uint64_t value() const { return m_value; }
+
+  private:
+    uint64_t m_value = 14695981039346656037ULL;
+  };
+
+  explicit GeometryCache(std::string_view directory);
+
+  /** Get the CBOR copy of a JSON material map, creating it if needed.
+   *  Returns an empty string if the material map could not be converted.
+   */
+  std::string materialFile(const std::string& jsonFile) const;
+
+  const std::string& directory() const { return m_directory; }
+
+private:
+  std::string path(std::string_view prefix, uint64_t key, std::string_view ext) const;
+  bool write(const std::string& fname, gsl::span<const char> data) const;
+
+  std::string m_directory;
+};
+
+#endif // GEOMETRYCACHE_H
@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Whitney Armstrong, Wouter Deconinck
+
+#include "PodioFrameInput.h"
+
+#if podio_VERSION_MAJOR > 0 || podio_VERSION_MINOR >= 16
+
+#include "FrameDataSvc.h"
+
+#include "GaudiKernel/IEventProcessor.h"
+
+#include <podio/Frame.h>
+
+#include "TROOT.h"
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+DECLARE_COMPONENT(PodioFrameInput)
+
+PodioFrameInput::PodioFrameInput(const std::string& name, ISvcLocator* svcLoc)
+    : GaudiAlgorithm(name, svcLoc) {}
+
+PodioFrameInput::~PodioFrameInput() { stopReader(); }
+
+StatusCode PodioFrameInput::initialize() {
+  if (GaudiAlgorithm::initialize().isFailure()) {
+    return StatusCode::FAILURE;
+  }
+  m_frameDataSvc = dynamic_cast<FrameDataSvc*>(evtSvc().get());
+  if (m_frameDataSvc == nullptr) {
+    error() << "PodioFrameInput needs the FrameDataSvc as event data service" << endmsg;
+    return StatusCode::FAILURE;
+  }
+  if (m_filenames.value().empty()) {
+    error() << "No input files" << endmsg;
+    return StatusCode::FAILURE;
+  }
+  m_reader.openFiles(m_filenames);
+  m_entries = m_reader.getEntries("events");
+  info() << "Reading " << m_entries << " events" << endmsg;
+
+  if (m_prefetchDepth.value() > 0) {
+    ROOT::EnableThreadSafety();
+    m_thread = std::thread([this]() { readerLoop(); });
+  }
+  return StatusCode::SUCCESS;
+}
+
+StatusCode PodioFrameInput::execute() {
+  auto data = next();
+  if (!data) {
+    error() << "No more events in the input" << endmsg;
+    return StatusCode::FAILURE;
+  }
+  if (m_frameDataSvc->setFrame(podio::Frame(std::move(data)), m_collectionNames).isFailure()) {
+    return StatusCode::FAILURE;
+  }
+  // stop before the next event if this was the last one
+  if (++m_read >= m_entries) {
+    info() << "Reached the end of the input with event " << m_read << endmsg;
+    auto eventProcessor = service<IEventProcessor>("ApplicationMgr");
+    if (!eventProcessor || eventProcessor->stopRun().isFailure()) {
+      warning() << "Unable to stop the event loop" << endmsg;
+    }
+  }
+  return StatusCode::SUCCESS;
+}
+
+StatusCode PodioFrameInput::finalize() {
+  stopReader();
+  return GaudiAlgorithm::finalize();
+}
+
+PodioFrameInput::FrameData PodioFrameInput::next() {
+  if (!m_thread.joinable()) {
+    return m_reader.readNextEntry("events");
+  }
+  FrameData data;
+  {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_cv.wait(lock, [this]() { return !m_queue.empty() || m_done; });
+    if (m_queue.empty()) {
+      return nullptr;
+    }
+    data = std::move(m_queue.front());
+    m_queue.pop_front();
+  }
+  m_cv.notify_all();
+  return data;
+}
+
+void PodioFrameInput::readerLoop() {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock{m_mutex};
+      m_cv.wait(lock, [this]() { return m_stop || m_queue.size() < m_prefetchDepth.value(); });
+      if (m_stop) {
+        return;
+      }
+    }
+    // basket I/O and decompression, the collections are unpacked by the event frame
+    auto data       = m_reader.readNextEntry("events");
+    const bool done = !data;
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      if (done) {
+        m_done = true;
+      } else {
+        m_queue.push_back(std::move(data));
+      }
+    }
+    m_cv.notify_all();
+    if (done) {
+      return;
+    }
+  }
+}
+
+void PodioFrameInput::stopReader() {
+  if (!m_thread.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_stop = true;
+  }
+  m_cv.notify_all();
+  m_thread.join();
+}
+
+#endif
@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Whitney Armstrong, Wouter Deconinck
+
+#ifndef JUGBASE_PODIOFRAMEINPUT_H
+#define JUGBASE_PODIOFRAMEINPUT_H
+
+#if podio_VERSION_MAJOR > 0 || podio_VERSION_MINOR >= 16
+
+#include "GaudiAlg/GaudiAlgorithm.h"
+
+#include <podio/ROOTFrameData.h>
+#include <podio/ROOTFrameReader.h>
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class FrameDataSvc;
+
+/** Read podio Frames (with the FrameDataSvc).
+ *
+ *  The raw data of the next prefetchDepth entries is read by a background thread, independently
+ *  of the events being processed. Every event gets its own frame, which unpacks the
+ *  collections on first access.
+ */
+class PodioFrameInput : public GaudiAlgorithm {
+public:
+  PodioFrameInput(const std::string& name, ISvcLocator* svcLoc);
+  ~PodioFrameInput();
+
+  virtual StatusCode initialize();
+  /// Installs the frame of the next entry, and registers the requested collections
+  virtual StatusCode execute();
+  virtual StatusCode finalize();
+
+private:
+  using FrameData = std::unique_ptr<podio::ROOTFrameData>;
+
+  /// Next entry (nullptr past the end of the input)
+  FrameData next();
+  void readerLoop();
+  void stopReader();
+
+  Gaudi::Property<std::vector<std::string>> m_filenames{
+      this, "inputs", {}, "Names of the files to read"};
+  Gaudi::Property<std::vector<std::string>> m_collectionNames{
+      this, "collections", {}, "Collections to read"};
+  Gaudi::Property<unsigned> m_prefetchDepth{
+      this, "prefetchDepth", 2, "Entries read ahead in the background (0: on the event thread)"};
+
+  FrameDataSvc* m_frameDataSvc{nullptr};
+  podio::ROOTFrameReader m_reader;
+  /// Number of entries in the input, and handed out so far
+  size_t m_entries{0};
+  size_t m_read{0};
+
+  std::thread m_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::deque<FrameData> m_queue;
+  bool m_done{false};
+  bool m_stop{false};
+};
+
+#endif
+#endif
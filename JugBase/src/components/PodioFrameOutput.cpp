@@ -0,0 +1,128 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Whitney Armstrong, Wouter Deconinck
+
+#include "PodioFrameOutput.h"
+
+#if podio_VERSION_MAJOR > 0 || podio_VERSION_MINOR >= 16
+
+#include "FrameDataSvc.h"
+
+#include "Gaudi/Interfaces/IOptionsSvc.h"
+#include "GaudiKernel/ISvcLocator.h"
+
+#include "TROOT.h"
+
+#include <exception>
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+DECLARE_COMPONENT(PodioFrameOutput)
+
+PodioFrameOutput::PodioFrameOutput(const std::string& name, ISvcLocator* svcLoc)
+    : GaudiAlgorithm(name, svcLoc) {}
+
+PodioFrameOutput::~PodioFrameOutput() { stopWriter(); }
+
+StatusCode PodioFrameOutput::initialize() {
+  if (GaudiAlgorithm::initialize().isFailure()) {
+    return StatusCode::FAILURE;
+  }
+  m_frameDataSvc = dynamic_cast<FrameDataSvc*>(evtSvc().get());
+  if (m_frameDataSvc == nullptr) {
+    error() << "PodioFrameOutput needs the FrameDataSvc as event data service" << endmsg;
+    return StatusCode::FAILURE;
+  }
+  m_switch = KeepDropSwitch(m_outputCommands);
+  m_writer = std::make_unique<podio::ROOTFrameWriter>(m_filename);
+  if (m_asyncDepth.value() > 0) {
+    ROOT::EnableThreadSafety();
+    m_thread = std::thread([this]() { writerLoop(); });
+  }
+  return StatusCode::SUCCESS;
+}
+
+StatusCode PodioFrameOutput::execute() {
+  if (m_writerFailed) {
+    error() << "Background writer failed to write a frame" << endmsg;
+    return StatusCode::FAILURE;
+  }
+  podio::Frame frame = m_frameDataSvc->takeFrame();
+  if (m_firstEvent) {
+    for (const auto& name : frame.getAvailableCollections()) {
+      if (m_switch.isOn(name)) {
+        m_collections.push_back(name);
+      }
+    }
+    debug() << "Writing " << m_collections.size() << " collections" << endmsg;
+    m_firstEvent = false;
+  }
+  if (!m_thread.joinable()) {
+    m_writer->writeFrame(frame, "events", m_collections);
+    return StatusCode::SUCCESS;
+  }
+  {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_cv.wait(lock, [this]() { return m_queue.size() < m_asyncDepth.value(); });
+    m_queue.push_back(std::move(frame));
+  }
+  m_cv.notify_all();
+  return StatusCode::SUCCESS;
+}
+
+void PodioFrameOutput::writerLoop() {
+  while (true) {
+    podio::Frame frame;
+    {
+      std::unique_lock<std::mutex> lock{m_mutex};
+      m_cv.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+      if (m_queue.empty()) {
+        return;
+      }
+      frame = std::move(m_queue.front());
+      m_queue.pop_front();
+    }
+    m_cv.notify_all();
+    // no more writing after a failure, but keep draining the queue
+    if (!m_writerFailed) {
+      try {
+        m_writer->writeFrame(frame, "events", m_collections);
+      } catch (const std::exception&) {
+        m_writerFailed = true;
+      }
+    }
+  }
+}
+
+void PodioFrameOutput::stopWriter() {
+  if (!m_thread.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_stop = true;
+  }
+  m_cv.notify_all();
+  m_thread.join();
+}
+
+StatusCode PodioFrameOutput::finalize() {
+  stopWriter();
+  if (m_writerFailed) {
+    error() << "Background writer failed to write a frame" << endmsg;
+  }
+  if (!m_writer) {
+    return GaudiAlgorithm::finalize();
+  }
+  // job options, as in the metadata tree of PodioOutput
+  std::vector<std::string> config_data;
+  for (const auto& [name, value] : Gaudi::svcLocator()->getOptsSvc().items()) {
+    config_data.push_back(name + " = \"" + value + "\";\n");
+  }
+  podio::Frame metadata;
+  metadata.putParameter("gaudiConfigOptions", std::move(config_data));
+  m_writer->writeFrame(metadata, "metadata");
+  m_writer->finish();
+  info() << "Data written to: " << m_filename.value() << endmsg;
+  return GaudiAlgorithm::finalize();
+}
+
+#endif
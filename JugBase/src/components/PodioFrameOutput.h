@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Whitney Armstrong, Wouter Deconinck
+
+#ifndef JUGBASE_PODIOFRAMEOUTPUT_H
+#define JUGBASE_PODIOFRAMEOUTPUT_H
+
+#if podio_VERSION_MAJOR > 0 || podio_VERSION_MINOR >= 16
+
+#include "JugBase/KeepDropSwitch.h"
+#include "GaudiAlg/GaudiAlgorithm.h"
+
+#include <podio/Frame.h>
+#include <podio/ROOTFrameWriter.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class FrameDataSvc;
+
+/** Write podio Frames (with the FrameDataSvc).
+ *
+ *  Takes the frame of the event, with the input and all newly created collections, and writes
+ *  the collections selected by outputCommands. With asyncQueueDepth > 0 the frames are
+ *  written (and then destroyed) by a background thread. PodioFrameOutput should be the last
+ *  algorithm to use the collections of an event.
+ */
+class PodioFrameOutput : public GaudiAlgorithm {
+public:
+  PodioFrameOutput(const std::string& name, ISvcLocator* svcLoc);
+  ~PodioFrameOutput();
+
+  virtual StatusCode initialize();
+  virtual StatusCode execute();
+  /// Writes the job options in a metadata frame and closes the file
+  virtual StatusCode finalize();
+
+private:
+  void writerLoop();
+  void stopWriter();
+
+  Gaudi::Property<std::string> m_filename{
+      this, "filename", "output.root", "Name of the file to create"};
+  Gaudi::Property<std::vector<std::string>> m_outputCommands{
+      this, "outputCommands", {"keep *"}, "Commands to declare which collections to keep or drop"};
+  Gaudi::Property<unsigned> m_asyncDepth{
+      this, "asyncQueueDepth", 0, "Frames queued for the writer thread (0: write synchronously)"};
+
+  FrameDataSvc* m_frameDataSvc{nullptr};
+  KeepDropSwitch m_switch;
+  std::unique_ptr<podio::ROOTFrameWriter> m_writer;
+  /// Collections written for every event (fixed by the first event)
+  std::vector<std::string> m_collections;
+  bool m_firstEvent{true};
+
+  std::thread m_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::deque<podio::Frame> m_queue;
+  bool m_stop{false};
+  std::atomic<bool> m_writerFailed{false};
+};
+
+#endif
+#endif
@@ -35,10 +35,21 @@ StatusCode PodioInput::initialize() {
     }
     m_collectionIDs.push_back(idTable->collectionID(name));
   }
+  if (m_lazy) {
+    m_podioDataSvc->setLazyCollections(m_collectionNames, m_collectionIDs);
+  }
+  m_podioDataSvc->startPrefetch(m_collectionNames);
   return StatusCode::SUCCESS;
 }
 
 StatusCode PodioInput::execute() {
+  ++m_events;
+  if (m_lazy) {
+    debug() << "Registering " << m_collectionIDs.size() << " collections to read on demand" << endmsg;
+    m_podioDataSvc->registerLazyCollections();
+    m_podioDataSvc->endOfRead();
+    return StatusCode::SUCCESS;
+  }
   size_t cntr = 0;
   // Re-create the collections from ROOT file
   for (auto& id : m_collectionIDs) {
@@ -54,6 +65,28 @@ StatusCode PodioInput::execute() {
 }
 
 StatusCode PodioInput::finalize() {
+  if (m_lazy && m_events > 0) {
+    std::vector<std::string> unused;
+    for (const auto& lazy : m_podioDataSvc->lazyCollections()) {
+      if (lazy.nOnDemand + lazy.nForOutput == 0) {
+        unused.push_back(lazy.name);
+      } else {
+        debug() << "Collection " << lazy.name << " read in " << lazy.nOnDemand << " / " << m_events
+                << " events on demand, " << lazy.nForOutput << " for the output" << endmsg;
+      }
+      if (lazy.nOnDemand == 0 && lazy.nForOutput > 0) {
+        info() << "Collection " << lazy.name << " was only read to be written out" << endmsg;
+      }
+    }
+    if (!unused.empty()) {
+      auto& msg = warning();
+      msg << unused.size() << " of the requested collections were never read (consider removing them):";
+      for (const auto& name : unused) {
+        msg << " " << name;
+      }
+      msg << endmsg;
+    }
+  }
   if (GaudiAlgorithm::finalize().isFailure()) {
     return StatusCode::FAILURE;
   }
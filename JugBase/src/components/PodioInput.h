@@ -18,6 +18,10 @@ class PodioDataSvc;
  *
  *  Class that allows to read ROOT files written with PodioOutput
  *
+ *  With lazy = true (default), the collections are only registered with the PodioDataSvc, and
+ *  read from the file when they are first retrieved (or when PodioOutput writes them). The
+ *  listed collections that were never read are reported at finalize.
+ *
  *  @author J. Lingemann
  */
 
@@ -36,10 +40,13 @@ public:
 private:
   /// Name of collections to read. Set by option collections (this is temporary)
   Gaudi::Property<std::vector<std::string>> m_collectionNames{this, "collections", {}, "Places of collections to read"};
+  Gaudi::Property<bool> m_lazy{this, "lazy", true, "Only read collections when they are first retrieved"};
   /// Collection IDs (retrieved with CollectionIDTable from ROOT file, using collection names)
   std::vector<int> m_collectionIDs;
   /// Data service: needed to register objects and get collection IDs. Just an observing pointer.
   PodioDataSvc* m_podioDataSvc;
+  /// Number of events read
+  size_t m_events{0};
 };
 
 #endif
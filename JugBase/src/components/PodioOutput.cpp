@@ -3,18 +3,28 @@
 
 #include "PodioOutput.h"
 #include "podio/podioVersion.h"
+#include "GaudiKernel/IAlgManager.h"
 #include "GaudiKernel/ISvcLocator.h"
+#include "GaudiKernel/ThreadLocalContext.h"
+#include "JugBase/IShardingSvc.h"
 #include "JugBase/PodioDataSvc.h"
 #include "TFile.h"
+#include "TROOT.h"
 #include "rootutils.h"
 
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
 DECLARE_COMPONENT(PodioOutput)
 
 PodioOutput::PodioOutput(const std::string& name, ISvcLocator* svcLoc)
-    : GaudiAlgorithm(name, svcLoc), m_firstEvent(true),
-      m_podioDataSvc(nullptr), m_datatree(nullptr), m_metadatatree(nullptr),
-      m_runMDtree(nullptr), m_evtMDtree(nullptr), m_colMDtree(nullptr) {}
+    : GaudiAlgorithm(name, svcLoc), m_podioDataSvc(nullptr) {}
+
+PodioOutput::~PodioOutput() { stopWriter(); }
 
 StatusCode PodioOutput::initialize() {
   if (GaudiAlgorithm::initialize().isFailure()) {
@@ -27,37 +37,168 @@ StatusCode PodioOutput::initialize() {
     error() << "Failed to get the DataSvc" << endmsg;
     return StatusCode::FAILURE;
   }
+  try {
+    m_settings = BranchSettings(m_branchSettings);
+  } catch (const std::invalid_argument& e) {
+    error() << e.what() << endmsg;
+    return StatusCode::FAILURE;
+  }
+  if (!m_streamFilters.value().empty()) {
+    m_algExecStateSvc = service<IAlgExecStateSvc>("AlgExecStateSvc");
+    if (!m_algExecStateSvc) {
+      error() << "Unable to locate the AlgExecStateSvc for the stream filters" << endmsg;
+      return StatusCode::FAILURE;
+    }
+  }
 
-  m_file = std::unique_ptr<TFile>(TFile::Open(m_filename.value().c_str(), "RECREATE", "data file"));
-  // Both trees are written to the ROOT file and owned by it
-  // PodioDataSvc has ownership of EventDataTree
-  m_datatree = m_podioDataSvc->eventDataTree();
-  m_datatree->SetDirectory(m_file.get());
-  m_metadatatree = new TTree("metadata", "Metadata tree");
-  m_runMDtree = new TTree("run_metadata", "Run metadata tree");
-  m_evtMDtree = new TTree("evt_metadata", "Event metadata tree");
-  m_colMDtree = new TTree("col_metadata", "Collection metadata tree");
+  // branches point into the streams (collectionInfo), so they must not be moved once created
+  m_streams.reserve(1 + m_streamCommands.value().size());
+  if (openStream(m_filename, m_outputCommands).isFailure()) {
+    return StatusCode::FAILURE;
+  }
+  for (const auto& [name, commands] : m_streamCommands.value()) {
+    if (name == m_filename.value()) {
+      error() << "Stream " << name << " is the same file as filename" << endmsg;
+      return StatusCode::FAILURE;
+    }
+    if (openStream(name, commands).isFailure()) {
+      return StatusCode::FAILURE;
+    }
+  }
+  for (const auto& [name, filter] : m_streamFilters.value()) {
+    if (std::none_of(m_streams.begin(), m_streams.end(),
+                     [&name = name](const auto& stream) { return stream.name == name; })) {
+      error() << "Filter " << filter << " for unknown output stream " << name << endmsg;
+      return StatusCode::FAILURE;
+    }
+  }
+
+  // Branches that are not podio collections (see DataHandle) are filled straight from the
+  // memory of their owner, which cannot be done in the background
+  m_async = m_asyncDepth.value() > 0;
+  if (m_async && m_streams.front().datatree->GetListOfBranches()->GetEntries() > 0) {
+    warning() << "Non-collection branches in the output, writing synchronously" << endmsg;
+    m_async = false;
+  }
+  for (auto& stream : m_streams) {
+    if (m_async) {
+      stream.evtMDtree->Branch("evtMD", "GenericParameters", &m_evtMDBuffer);
+    } else {
+      stream.evtMDtree->Branch("evtMD", "GenericParameters", m_podioDataSvc->getProvider().eventMetaDataPtr() ) ;
+    }
+  }
+  if (m_async) {
+    ROOT::EnableThreadSafety();
+    m_writer = std::thread([this]() { writerLoop(); });
+    info() << "Writing in the background, with up to " << m_asyncDepth << " events queued" << endmsg;
+  }
+  return StatusCode::SUCCESS;
+}
+
+StatusCode PodioOutput::openStream(const std::string& name, const std::vector<std::string>& commands) {
+  Stream stream;
+  stream.name     = name;
+  stream.filename = name;
+  if (auto shardingSvc = service<IShardingSvc>("ShardingSvc", false, true)) {
+    stream.filename = shardingSvc->outputFile(name);
+    if (!m_filenameRemote.value().empty() && shardingSvc->nShards() > 1) {
+      warning() << "filenameRemote is ignored when sharding" << endmsg;
+      m_filenameRemote = "";
+    }
+  }
+  stream.keep = KeepDropSwitch(commands);
+  if (const auto it = m_streamFilters.value().find(name); it != m_streamFilters.value().end()) {
+    auto algMgr   = service<IAlgManager>("ApplicationMgr");
+    stream.filter = algMgr->algorithm(it->second, false);
+    if (!stream.filter) {
+      error() << "Unable to find filter algorithm " << it->second << " for " << name << endmsg;
+      return StatusCode::FAILURE;
+    }
+  }
 
-  m_evtMDtree->Branch("evtMD", "GenericParameters", m_podioDataSvc->getProvider().eventMetaDataPtr() ) ;
-  m_switch       = KeepDropSwitch(m_outputCommands);
+  stream.file = std::unique_ptr<TFile>(TFile::Open(stream.filename.c_str(), "RECREATE", "data file"));
+  if (!stream.file || stream.file->IsZombie()) {
+    error() << "Unable to create " << stream.filename << endmsg;
+    return StatusCode::FAILURE;
+  }
+  // The trees are written to the ROOT file and owned by it
+  // PodioDataSvc has ownership of EventDataTree, the event tree of the main output
+  if (m_streams.empty()) {
+    stream.datatree = m_podioDataSvc->eventDataTree();
+    stream.datatree->SetDirectory(stream.file.get());
+  } else {
+    stream.datatree = new TTree("events", "Events tree");
+  }
+  stream.metadatatree = new TTree("metadata", "Metadata tree");
+  stream.runMDtree = new TTree("run_metadata", "Run metadata tree");
+  stream.evtMDtree = new TTree("evt_metadata", "Event metadata tree");
+  stream.colMDtree = new TTree("col_metadata", "Collection metadata tree");
+  // the flush (and cluster) size is a property of the whole tree
+  if (m_autoFlush.value() != 0) {
+    stream.datatree->SetAutoFlush(m_autoFlush.value());
+  }
+  m_streams.push_back(std::move(stream));
   return StatusCode::SUCCESS;
 }
 
-void PodioOutput::resetBranches(const std::vector<std::pair<std::string, podio::CollectionBase*>>& collections) {
+bool PodioOutput::accept(const Stream& stream) const {
+  if (!stream.filter) {
+    return true;
+  }
+  const auto& state = m_algExecStateSvc->algExecState(stream.filter.get(), Gaudi::Hive::currentContext());
+  return state.state() == AlgExecState::State::Done && state.filterPassed();
+}
+
+std::vector<PodioOutput::StreamAction> PodioOutput::prepareStreams(const CollRegistry& collections) {
+  // the collections are serialized once, for all streams
   for (const auto& [collName, collBuffers] : collections) {
+    collBuffers->prepareForWrite();
+  }
+  std::vector<StreamAction> actions;
+  actions.reserve(m_streams.size());
+  for (auto& stream : m_streams) {
+    if (!accept(stream)) {
+      actions.push_back(StreamAction::kSkip);
+    } else if (stream.firstEvent) {
+      // for now assume identical content for every event
+      // (no event of this stream was written yet, so the writer thread does not use its trees)
+      stream.collectionInfo.clear();
+      createBranches(stream, collections);
+      stream.metadatatree->Branch("CollectionTypeInfo", &stream.collectionInfo);
+      stream.firstEvent = false;
+      actions.push_back(StreamAction::kFill);
+    } else {
+      actions.push_back(StreamAction::kBind);
+    }
+  }
+  return actions;
+}
+
+std::vector<bool> PodioOutput::keepFlags(const Stream& stream, const CollRegistry& collections) {
+  std::vector<bool> keep;
+  keep.reserve(collections.size());
+  for (const auto& [collName, collBuffers] : collections) {
+    keep.push_back(stream.keep.isOn(collName));
+  }
+  return keep;
+}
+
+void PodioOutput::bindBranches(Stream& stream, const CollRegistry& collections, const std::vector<bool>& keep) {
+  for (size_t i = 0; i < collections.size(); ++i) {
+    const auto& [collName, collBuffers] = collections[i];
     auto buffers = collBuffers->getBuffers();
     auto* data = buffers.data;
     auto* references = buffers.references;
     auto* vecmembers = buffers.vectorMembers;
 
-    if (m_switch.isOn(collName)) {
+    if (keep[i]) {
       // Reconnect branches and collections
-      m_datatree->SetBranchAddress(collName.c_str(), data);
+      stream.datatree->SetBranchAddress(collName.c_str(), data);
       auto* colls = references;
       if (colls != nullptr) {
         for (size_t j = 0; j < colls->size(); ++j) {
           const auto brName = podio::root_utils::refBranch(collName, j);
-          auto* l_branch = m_datatree->GetBranch(brName.c_str());
+          auto* l_branch = stream.datatree->GetBranch(brName.c_str());
           l_branch->SetAddress(&(*colls)[j]);
         }
       }
@@ -66,16 +207,15 @@ void PodioOutput::resetBranches(const std::vector<std::pair<std::string, podio::
         int j = 0;
         for (auto& [dataType, add] : (*colls_v)) {
           const auto brName = podio::root_utils::vecBranch(collName, j);
-          m_datatree->SetBranchAddress(brName.c_str(), add);
+          stream.datatree->SetBranchAddress(brName.c_str(), add);
           ++j;
         }
       }
     }
-    collBuffers->prepareForWrite();
   }
 }
 
-void PodioOutput::createBranches(const std::vector<std::pair<std::string, podio::CollectionBase*>>& collections) {
+void PodioOutput::createBranches(Stream& stream, const CollRegistry& collections) {
   for (const auto& [collName, collBuffers] : collections) {
     auto buffers = collBuffers->getBuffers();
     auto* data = buffers.data;
@@ -86,15 +226,24 @@ void PodioOutput::createBranches(const std::vector<std::pair<std::string, podio:
     const std::string collClassName = "vector<" + className + "Data>";
 
     int isOn = 0;
-    if (m_switch.isOn(collName)) {
-      isOn = 1;
-      m_datatree->Branch(collName.c_str(), collClassName.c_str(), data);
+    if (stream.keep.isOn(collName)) {
+      isOn                = 1;
+      const auto settings = m_settings.get(collName);
+      // applies to the sub-branches as well
+      auto compress = [&settings](TBranch* branch) {
+        if (settings.compression >= 0) {
+          branch->SetCompressionSettings(settings.compression);
+        }
+      };
+      TTree* tree = stream.datatree;
+      compress(tree->Branch(collName.c_str(), collClassName.c_str(), data, settings.basketSize,
+                            settings.splitLevel));
       // Create branches for collections holding relations
       if (auto* refColls = references) {
         int j = 0;
         for (auto& c : (*refColls)) {
           const auto brName = podio::root_utils::refBranch(collName, j);
-          m_datatree->Branch(brName.c_str(), c.get());
+          compress(tree->Branch(brName.c_str(), c.get(), settings.basketSize, settings.splitLevel));
           ++j;
         }
       }
@@ -104,43 +253,215 @@ void PodioOutput::createBranches(const std::vector<std::pair<std::string, podio:
         for (auto& [dataType, add] : (*vminfo)) {
           const std::string typeName = "vector<" + dataType + ">";
           const auto brName          = podio::root_utils::vecBranch(collName, j);
-          m_datatree->Branch(brName.c_str(), typeName.c_str(), add);
+          compress(tree->Branch(brName.c_str(), typeName.c_str(), add, settings.basketSize,
+                                settings.splitLevel));
           ++j;
         }
       }
+      if (msgLevel(MSG::DEBUG)) {
+        debug() << "Branch settings for " << collName << ": compression "
+                << BranchSettings::compressionName(settings.compression) << ", basket size "
+                << settings.basketSize << ", split level " << settings.splitLevel << endmsg;
+      }
     }
 
     const auto collID = m_podioDataSvc->getCollectionIDs()->collectionID(collName);
     const auto collType = collBuffers->getValueTypeName() + "Collection";
-    m_collectionInfo.emplace_back(collID, std::move(collType), collBuffers->isSubsetCollection());
+    stream.collectionInfo.emplace_back(collID, std::move(collType), collBuffers->isSubsetCollection());
 
     debug() << isOn << " Registering collection " << collClassName << " " << collName.c_str() << " containing type "
-            << className << endmsg;
-    collBuffers->prepareForWrite();
+            << className << " in " << stream.name << endmsg;
   }
 }
 
 StatusCode PodioOutput::execute() {
-  // for now assume identical content for every event
-  // register for writing
-  if (m_firstEvent) {
-    m_collectionInfo.clear();
-    createBranches(m_podioDataSvc->getCollections());
-    createBranches(m_podioDataSvc->getReadCollections());
-    m_metadatatree->Branch("CollectionTypeInfo", &m_collectionInfo);
-  } else {
-    resetBranches(m_podioDataSvc->getCollections());
-    resetBranches(m_podioDataSvc->getReadCollections());
+  // input collections that are written out but were not read yet
+  const auto isOn = [this](const std::string& collName) {
+    return std::any_of(m_streams.begin(), m_streams.end(),
+                       [&collName](const auto& stream) { return stream.keep.isOn(collName); });
+  };
+  if (m_podioDataSvc->readPendingCollections(isOn).isFailure()) {
+    return StatusCode::FAILURE;
+  }
+  if (m_async) {
+    return executeAsync();
   }
-  m_firstEvent = false;
+  // register for writing
+  CollRegistry collections      = m_podioDataSvc->getCollections();
+  const auto& readCollections = m_podioDataSvc->getReadCollections();
+  collections.insert(collections.end(), readCollections.begin(), readCollections.end());
+  const auto actions = prepareStreams(collections);
   if (msgLevel(MSG::DEBUG)) {
     debug() << "Filling DataTree .." << endmsg;
   }
-  m_datatree->Fill();
-  m_evtMDtree->Fill();
+  for (size_t i = 0; i < m_streams.size(); ++i) {
+    if (actions[i] == StreamAction::kBind) {
+      bindBranches(m_streams[i], collections, keepFlags(m_streams[i], collections));
+    }
+    if (actions[i] != StreamAction::kSkip) {
+      fill(m_streams[i]);
+    }
+  }
   return StatusCode::SUCCESS;
 }
 
+StatusCode PodioOutput::executeAsync() {
+  releaseWritten();
+  if (m_writerFailed) {
+    error() << "Background writer failed to fill the output tree" << endmsg;
+    return StatusCode::FAILURE;
+  }
+
+  auto event         = std::make_unique<PendingEvent>();
+  event->collections = m_podioDataSvc->releaseCollections();
+  // keep the collections alive beyond the end of this event
+  for (const auto& [collName, coll] : event->collections) {
+    DataObject* wrapper = nullptr;
+    if (evtSvc()->retrieveObject("/Event/" + collName, wrapper).isFailure()) {
+      error() << "Cannot find collection " << collName << " in the event store" << endmsg;
+      for (auto* w : event->wrappers) {
+        w->release();
+      }
+      return StatusCode::FAILURE;
+    }
+    wrapper->addRef();
+    event->wrappers.push_back(wrapper);
+  }
+  // filling the buffers stays on the event thread, as later algorithms may still read the
+  // collections
+  event->actions = prepareStreams(event->collections);
+  event->evtMD   = m_podioDataSvc->getProvider().getEventMetaData();
+  event->keep.resize(m_streams.size());
+  for (size_t i = 0; i < m_streams.size(); ++i) {
+    if (event->actions[i] == StreamAction::kBind) {
+      event->keep[i] = keepFlags(m_streams[i], event->collections);
+    }
+  }
+
+  {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_cv.wait(lock, [this]() { return m_inFlight < m_asyncDepth.value(); });
+    m_queue.push_back(std::move(event));
+    ++m_inFlight;
+  }
+  m_cv.notify_all();
+  return StatusCode::SUCCESS;
+}
+
+void PodioOutput::writerLoop() {
+  while (true) {
+    std::unique_ptr<PendingEvent> event;
+    {
+      std::unique_lock<std::mutex> lock{m_mutex};
+      m_cv.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+      if (m_queue.empty()) {
+        return;
+      }
+      event = std::move(m_queue.front());
+      m_queue.pop_front();
+    }
+    // no more writing after a failure, but keep draining the queue
+    if (!m_writerFailed) {
+      m_evtMDBuffer = std::move(event->evtMD);
+      for (size_t i = 0; i < m_streams.size(); ++i) {
+        if (event->actions[i] == StreamAction::kBind) {
+          bindBranches(m_streams[i], event->collections, event->keep[i]);
+        }
+        if (event->actions[i] != StreamAction::kSkip && !fill(m_streams[i])) {
+          m_writerFailed = true;
+        }
+      }
+    }
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      m_written.push_back(std::move(event));
+      --m_inFlight;
+    }
+    m_cv.notify_all();
+  }
+}
+
+bool PodioOutput::fill(Stream& stream) {
+  const auto start = std::chrono::steady_clock::now();
+  const Int_t ret  = stream.datatree->Fill();
+  stream.fillTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return ret >= 0 && stream.evtMDtree->Fill() >= 0;
+}
+
+// Sizes include the sub-branches (split members), the time is for the full tree as ROOT
+// fills (and compresses) all branches of an entry in one go
+void PodioOutput::reportBranches(const Stream& stream) const {
+  if (m_reportBranches.value() == 0) {
+    return;
+  }
+  struct BranchSize {
+    std::string name;
+    Long64_t zipBytes;
+    Long64_t totBytes;
+    int compression;
+  };
+  std::vector<BranchSize> sizes;
+  Long64_t zipBytes = 0;
+  Long64_t totBytes = 0;
+  for (auto* obj : *stream.datatree->GetListOfBranches()) {
+    const auto* branch = static_cast<TBranch*>(obj);
+    sizes.push_back({branch->GetName(), branch->GetZipBytes("*"), branch->GetTotBytes("*"),
+                     branch->GetCompressionSettings()});
+    zipBytes += sizes.back().zipBytes;
+    totBytes += sizes.back().totBytes;
+  }
+  std::sort(sizes.begin(), sizes.end(),
+            [](const auto& a, const auto& b) { return a.zipBytes > b.zipBytes; });
+  if (m_reportBranches.value() > 0 && sizes.size() > static_cast<size_t>(m_reportBranches.value())) {
+    sizes.resize(m_reportBranches.value());
+  }
+
+  auto ratio = [](const Long64_t tot, const Long64_t zip) {
+    return (zip > 0) ? static_cast<double>(tot) / static_cast<double>(zip) : 0.;
+  };
+  auto& msg = info();
+  msg << fmt::format("Wrote {} events to {}: {:.1f} MB compressed, {:.1f} MB uncompressed "
+                     "(ratio {:.2f}), {:.2f} s filling the event tree",
+                     stream.datatree->GetEntries(), stream.name, zipBytes / 1e6, totBytes / 1e6,
+                     ratio(totBytes, zipBytes), stream.fillTime);
+  msg << fmt::format("\n  {:<50} {:>12} {:>12} {:>7} {:>6} {:>10}", "Branch", "Compressed",
+                     "Uncompressed", "Ratio", "Share", "Settings");
+  for (const auto& b : sizes) {
+    msg << fmt::format("\n  {:<50} {:>12} {:>12} {:>7.2f} {:>5.1f}% {:>10}", b.name, b.zipBytes,
+                       b.totBytes, ratio(b.totBytes, b.zipBytes),
+                       (zipBytes > 0) ? 100. * b.zipBytes / zipBytes : 0.,
+                       BranchSettings::compressionName(b.compression));
+  }
+  msg << endmsg;
+}
+
+void PodioOutput::releaseWritten() {
+  std::vector<std::unique_ptr<PendingEvent>> written;
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    written.swap(m_written);
+  }
+  // DataObject reference counting is not thread-safe, so this happens on the event thread
+  for (auto& event : written) {
+    for (auto* wrapper : event->wrappers) {
+      wrapper->release();
+    }
+  }
+}
+
+void PodioOutput::stopWriter() {
+  if (!m_writer.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_stop = true;
+  }
+  m_cv.notify_all();
+  m_writer.join();
+  releaseWritten();
+}
+
 /** PodioOutput::finalize
  * has to happen after all algorithms that touch the data store finish.
  * Here the job options are retrieved and stored to disk as a branch
@@ -149,6 +470,10 @@ StatusCode PodioOutput::execute() {
  */
 StatusCode PodioOutput::finalize() {
   info() << "Finalizing output algorithm" << endmsg;
+  stopWriter();
+  if (m_writerFailed) {
+    error() << "Background writer failed to fill the output tree" << endmsg;
+  }
   if (GaudiAlgorithm::finalize().isFailure()) {
     return StatusCode::FAILURE;
   }
@@ -185,19 +510,26 @@ StatusCode PodioOutput::finalize() {
   }
   //// finalize trees and file //////////////////////////////
   debug() << "Finalizing trees and output file" << endmsg;
-  m_file->cd();
-  m_metadatatree->Branch("gaudiConfigOptions", &config_data);
   const auto collIDTable = m_podioDataSvc->getCollectionIDs();
-  m_metadatatree->Branch("CollectionIDs", collIDTable);
-  m_metadatatree->Fill();
-  m_colMDtree->Branch("colMD", "std::map<int,podio::GenericParameters>", m_podioDataSvc->getProvider().getColMetaDataMap() ) ;
-  m_colMDtree->Fill();
-  m_runMDtree->Branch("runMD", "std::map<int,podio::GenericParameters>", m_podioDataSvc->getProvider().getRunMetaDataMap() ) ;
-  m_runMDtree->Fill();
-  m_datatree->Write();
-  m_file->Write();
-  m_file->Close();
-  info() << "Data written to: " << m_filename.value() << endmsg;
+  for (auto& stream : m_streams) {
+    stream.file->cd();
+    stream.metadatatree->Branch("gaudiConfigOptions", &config_data);
+    stream.metadatatree->Branch("CollectionIDs", collIDTable);
+    if (stream.firstEvent) {
+      // no events were written
+      stream.metadatatree->Branch("CollectionTypeInfo", &stream.collectionInfo);
+    }
+    stream.metadatatree->Fill();
+    stream.colMDtree->Branch("colMD", "std::map<int,podio::GenericParameters>", m_podioDataSvc->getProvider().getColMetaDataMap() ) ;
+    stream.colMDtree->Fill();
+    stream.runMDtree->Branch("runMD", "std::map<int,podio::GenericParameters>", m_podioDataSvc->getProvider().getRunMetaDataMap() ) ;
+    stream.runMDtree->Fill();
+    stream.datatree->Write();
+    reportBranches(stream);
+    stream.file->Write();
+    stream.file->Close();
+    info() << "Data written to: " << stream.filename << endmsg;
+  }
   if (!m_filenameRemote.value().empty()) {
     TFile::Cp(m_filename.value().c_str(), m_filenameRemote.value().c_str(), false);
     info() << " and copied to: " << m_filenameRemote.value() << endmsg;
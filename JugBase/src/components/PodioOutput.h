@@ -4,12 +4,23 @@
 #ifndef JUGBASE_PODIOOUTPUT_H
 #define JUGBASE_PODIOOUTPUT_H
 
+#include "JugBase/BranchSettings.h"
 #include "JugBase/KeepDropSwitch.h"
 #include "GaudiAlg/GaudiAlgorithm.h"
+#include "GaudiKernel/IAlgExecStateSvc.h"
+#include "GaudiKernel/IAlgorithm.h"
 #include "podio/CollectionBase.h"
+#include "podio/GenericParameters.h"
 
 #include "TTree.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <gsl/gsl>
 
@@ -17,11 +28,36 @@
 class TFile;
 class PodioDataSvc;
 
+/** Write the podio collections to a ROOT file.
+ *
+ *  With asyncQueueDepth > 0, the branch binding, serialization and compression of an event
+ *  happen on a background writer thread, while the event loop moves on. The collections of up
+ *  to asyncQueueDepth events are kept alive for the writer (they are released on the event
+ *  thread once written), and events are written in order. PodioOutput should be the last
+ *  algorithm to use the collections of an event in this mode.
+ *
+ *  The compression, basket size and split level of the collection branches can be tuned per
+ *  collection with branchSettings (see BranchSettings), e.g.
+ *    branchSettings = ["* compression=LZ4:4", "*Hits compression=ZSTD:5 basket=256000"]
+ *  A summary of the compressed and uncompressed branch sizes is printed at finalize.
+ *
+ *  Additional output files (streams) with their own outputCommands can be written in the same
+ *  pass, e.g.
+ *    streams = {"slim.root": ["drop *", "keep ReconstructedParticles"]}
+ *  and each file (including filename) can be restricted to the events accepted by a filter
+ *  algorithm that runs before PodioOutput, e.g. streamFilters = {"skim.root": "SkimFilter"}.
+ *  The collections are only prepared for writing once per event, for all streams. Branches
+ *  that are not podio collections (see DataHandle) are only written to filename.
+ *
+ *  When running with the ShardingSvc, every worker writes its own file, and the ShardingSvc
+ *  merges them into filename at the end of the job.
+ */
 class PodioOutput : public GaudiAlgorithm {
 
 public:
   /// Constructor.
   PodioOutput(const std::string& name, ISvcLocator* svcLoc);
+  ~PodioOutput();
 
   /// Initialization of PodioOutput. Acquires the data service, creates trees and root file.
   virtual StatusCode initialize();
@@ -32,10 +68,69 @@ public:
   virtual StatusCode finalize();
 
 private:
-  void resetBranches(const std::vector<std::pair<std::string, podio::CollectionBase*>>& collections);
-  void createBranches(const std::vector<std::pair<std::string, podio::CollectionBase*>>& collections);
-  /// First event or not
-  bool m_firstEvent;
+  using CollRegistry = std::vector<std::pair<std::string, podio::CollectionBase*>>;
+
+  /// An output file, with its own selection of collections and events
+  struct Stream {
+    /// Configured file name, and the file that is actually written (differs when sharding)
+    std::string name;
+    std::string filename;
+    /// Switch for keeping or dropping outputs
+    KeepDropSwitch keep;
+    /// Only the events accepted by this algorithm are written (if set)
+    SmartIF<IAlgorithm> filter;
+    /// The actual ROOT file
+    std::unique_ptr<TFile> file;
+    /// The tree to be filled with collections
+    gsl::owner<TTree*> datatree{nullptr};
+    /// The tree to be filled with meta data
+    gsl::owner<TTree*> metadatatree{nullptr};
+    gsl::owner<TTree*> runMDtree{nullptr};
+    gsl::owner<TTree*> evtMDtree{nullptr};
+    gsl::owner<TTree*> colMDtree{nullptr};
+    std::vector<std::tuple<int, std::string, bool>> collectionInfo;
+    /// No branches yet
+    bool firstEvent{true};
+    /// Time spent filling the data tree (serialization and compression), in s
+    double fillTime{0};
+  };
+
+  /// What to do with an event for a stream
+  enum class StreamAction { kSkip, kBind, kFill };
+
+  /// An event handed over to the writer thread
+  struct PendingEvent {
+    CollRegistry collections;
+    /// Wrappers of the collections, kept alive (addRef) until the event is written
+    std::vector<DataObject*> wrappers;
+    podio::GenericParameters evtMD;
+    /// Per stream (branches need to be reconnected, except for the event that created them)
+    std::vector<StreamAction> actions;
+    /// Per stream and collection, decided on the event thread (KeepDropSwitch is not thread-safe)
+    std::vector<std::vector<bool>> keep;
+  };
+
+  StatusCode openStream(const std::string& name, const std::vector<std::string>& commands);
+  /// The filter of the stream (if any) accepted the current event
+  bool accept(const Stream& stream) const;
+  /// Decide, on the event thread, what to do with the current event for every stream
+  std::vector<StreamAction> prepareStreams(const CollRegistry& collections);
+  /// The collections that are written to the stream (in the order of collections)
+  static std::vector<bool> keepFlags(const Stream& stream, const CollRegistry& collections);
+  void bindBranches(Stream& stream, const CollRegistry& collections, const std::vector<bool>& keep);
+  void createBranches(Stream& stream, const CollRegistry& collections);
+  /// Fill the trees of a stream, keeping track of the time spent
+  bool fill(Stream& stream);
+  /// Hand the current event over to the writer thread
+  StatusCode executeAsync();
+  /// Writer thread main loop
+  void writerLoop();
+  /// Release the collections of written events (on the event thread)
+  void releaseWritten();
+  /// Write all queued events and stop the writer thread
+  void stopWriter();
+  /// Print the branch size summary
+  void reportBranches(const Stream& stream) const;
   /// Root file name the output is written to
   Gaudi::Property<std::string> m_filename{this, "filename", "output.root", "Name of the file to create"};
   /// Commands which output is to be kept
@@ -43,22 +138,43 @@ private:
       this, "outputCommands", {"keep *"}, "A set of commands to declare which collections to keep or drop."};
   Gaudi::Property<std::string> m_filenameRemote{
       this, "filenameRemote", "", "An optional file path to copy the outputfile to."};
-  /// Switch for keeping or dropping outputs
-  KeepDropSwitch m_switch;
+  Gaudi::Property<std::map<std::string, std::vector<std::string>>> m_streamCommands{
+      this, "streams", {}, "Additional output files, with their outputCommands"};
+  Gaudi::Property<std::map<std::string, std::string>> m_streamFilters{
+      this, "streamFilters", {}, "Filter algorithm deciding which events are written, per output file"};
+  Gaudi::Property<unsigned> m_asyncDepth{
+      this, "asyncQueueDepth", 0, "Events queued for the background writer thread (0: write synchronously)"};
+  Gaudi::Property<std::vector<std::string>> m_branchSettings{
+      this, "branchSettings", {},
+      "Per-collection branch settings: '<pattern> [compression=<ALG>[:<level>]] [basket=<bytes>] [split=<level>]'"};
+  Gaudi::Property<Long64_t> m_autoFlush{
+      this, "autoFlush", 0, "TTree::SetAutoFlush for the event tree (>0: entries, <0: bytes, 0: ROOT default)"};
+  Gaudi::Property<int> m_reportBranches{
+      this, "reportBranches", 20, "Number of (largest) branches in the size summary at finalize (-1: all)"};
+  /// Branch settings per collection
+  BranchSettings m_settings;
   /// Needed for collection ID table
   PodioDataSvc* m_podioDataSvc;
-  /// The actual ROOT file
-  std::unique_ptr<TFile> m_file;
-  /// The tree to be filled with collections
-  gsl::owner<TTree*> m_datatree;
-  /// The tree to be filled with meta data
-  gsl::owner<TTree*> m_metadatatree;
-  gsl::owner<TTree*> m_runMDtree;
-  gsl::owner<TTree*> m_evtMDtree;
-  gsl::owner<TTree*> m_colMDtree;
+  /// For the decisions of the stream filters
+  SmartIF<IAlgExecStateSvc> m_algExecStateSvc;
+  /// The output streams, the first one is filename
+  std::vector<Stream> m_streams;
   /// The stored collections
   std::vector<podio::CollectionBase*> m_storedCollections;
-  std::vector<std::tuple<int, std::string, bool>> m_collectionInfo;
+
+  /// Background writer
+  bool m_async{false};
+  std::thread m_writer;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::deque<std::unique_ptr<PendingEvent>> m_queue;
+  std::vector<std::unique_ptr<PendingEvent>> m_written;
+  /// Events handed to the writer that were not written yet
+  size_t m_inFlight{0};
+  bool m_stop{false};
+  std::atomic<bool> m_writerFailed{false};
+  /// Event meta data of the event being written (the branch address of evtMD when async)
+  podio::GenericParameters m_evtMDBuffer;
 };
 
 #endif
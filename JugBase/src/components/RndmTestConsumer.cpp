@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Whitney Armstrong, Wouter Deconinck
+
+#include <fmt/format.h>
+
+#include "GaudiAlg/GaudiAlgorithm.h"
+#include "GaudiKernel/RndmGenerators.h"
+
+#include "JugBase/PodioDataSvc.h"
+
+/** Test algorithm: prints a draw of the random engine (RndmGenSvc) for every event, with the
+ *  input entry of the event, e.g. to check that the workers of a sharded job do not repeat
+ *  each other's random numbers (tests/scripts/check_sharded_rndm.py).
+ */
+class RndmTestConsumer : public GaudiAlgorithm {
+public:
+  RndmTestConsumer(const std::string& name, ISvcLocator* svcLoc) : GaudiAlgorithm(name, svcLoc) {}
+
+  StatusCode initialize() override {
+    if (GaudiAlgorithm::initialize().isFailure()) {
+      return StatusCode::FAILURE;
+    }
+    m_podioDataSvc = dynamic_cast<PodioDataSvc*>(evtSvc().get());
+    if (m_podioDataSvc == nullptr) {
+      error() << "Unable to locate the PodioDataSvc" << endmsg;
+      return StatusCode::FAILURE;
+    }
+    IRndmGenSvc* randSvc = svc<IRndmGenSvc>("RndmGenSvc", true);
+    return m_gaussDist.initialize(randSvc, Rndm::Gauss(0.0, 1.0));
+  }
+
+  StatusCode execute() override {
+    const auto entry = m_podioDataSvc->firstEntry() + getContext().evt();
+    info() << fmt::format("entry {} draw {:.17g}", entry, m_gaussDist()) << endmsg;
+    return StatusCode::SUCCESS;
+  }
+
+private:
+  PodioDataSvc* m_podioDataSvc{nullptr};
+  Rndm::Numbers m_gaussDist;
+};
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+DECLARE_COMPONENT(RndmTestConsumer)
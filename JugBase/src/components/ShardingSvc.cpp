@@ -0,0 +1,282 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Whitney Armstrong, Wouter Deconinck
+
+#include "ShardingSvc.h"
+
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include "GaudiKernel/IIncidentSvc.h"
+#include "GaudiKernel/IProperty.h"
+#include "GaudiKernel/IRndmEngine.h"
+
+#include "JugBase/PodioDataSvc.h"
+
+#include "TFile.h"
+#include "TFileMerger.h"
+#include "TTree.h"
+
+namespace {
+// splitmix64 finalizer
+uint64_t mix(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30U)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27U)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31U);
+}
+// streams of the seeds, so initialize and the first event do not draw the same numbers
+constexpr uint64_t kEventStream      = 0;
+constexpr uint64_t kInitializeStream = 1;
+// trees with one entry per job, taken from the first worker instead of concatenated
+constexpr const char* kJobTrees = "metadata run_metadata col_metadata";
+// threads of this process (0 if unknown)
+size_t threadCount() {
+  std::error_code ec;
+  size_t n = 0;
+  for (std::filesystem::directory_iterator it{"/proc/self/task", ec}, end; !ec && it != end;
+       it.increment(ec)) {
+    ++n;
+  }
+  return ec ? 0 : n;
+}
+} // namespace
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+DECLARE_COMPONENT(ShardingSvc)
+
+ShardingSvc::ShardingSvc(const std::string& name, ISvcLocator* svc) : base_class(name, svc) {}
+
+ShardingSvc::~ShardingSvc() = default;
+
+StatusCode ShardingSvc::initialize() {
+  StatusCode sc = Service::initialize();
+  if (!sc.isSuccess()) {
+    return sc;
+  }
+  const size_t workers = (m_workers.value() > 0)
+                             ? m_workers.value()
+                             : std::max(1U, std::thread::hardware_concurrency());
+  if (workers == 1) {
+    return StatusCode::SUCCESS;
+  }
+
+  SmartIF<IService> evtSvc = service("EventDataSvc");
+  auto* podioDataSvc       = dynamic_cast<PodioDataSvc*>(evtSvc.get());
+  if (podioDataSvc == nullptr || podioDataSvc->inputEntries() < 0) {
+    error() << "Sharding needs a PodioDataSvc reading an input file" << endmsg;
+    return StatusCode::FAILURE;
+  }
+  auto appMgr = service<IProperty>("ApplicationMgr");
+  Gaudi::Property<int> evtMax{"EvtMax", -1};
+  if (!appMgr || appMgr->getProperty(&evtMax).isFailure()) {
+    error() << "Unable to get the number of events from the ApplicationMgr" << endmsg;
+    return StatusCode::FAILURE;
+  }
+  size_t total = podioDataSvc->inputEntries();
+  if (evtMax.value() >= 0) {
+    total = std::min<size_t>(total, evtMax.value());
+  }
+  m_nShards = std::clamp<size_t>(workers, 1, std::max<size_t>(total, 1));
+
+  // the engine is initialized before the fork (if not already), so all workers start from the
+  // same seeds, and reseed it afterwards
+  if (m_nShards > 1) {
+    m_rndmSvc = service("RndmGenSvc", true);
+    if (!m_rndmSvc || m_rndmSvc->engine() == nullptr ||
+        m_rndmSvc->engine()->seeds(m_seeds).isFailure()) {
+      error() << "Unable to get the seeds of the random engine" << endmsg;
+      return StatusCode::FAILURE;
+    }
+  }
+
+  // only the forking thread exists in the workers, the other threads (e.g. the asynchronous
+  // log sink of the AlgoServiceSvc) would be gone with their state
+  if (const size_t nThreads = threadCount(); m_nShards > 1 && nThreads > 1) {
+    error() << "Unable to fork the workers, the process already runs " << nThreads
+            << " threads (ShardingSvc must come before the services that start threads in ExtSvc)"
+            << endmsg;
+    return StatusCode::FAILURE;
+  }
+
+  // flush before forking, or the buffered output is written by every worker
+  std::cout.flush();
+  std::cerr.flush();
+  std::fflush(nullptr);
+  for (size_t i = 1; i < m_nShards; ++i) {
+    const pid_t pid = ::fork();
+    if (pid < 0) {
+      error() << "Failed to start worker " << i << endmsg;
+      for (const pid_t child : m_children) {
+        ::kill(child, SIGTERM);
+      }
+      waitForWorkers();
+      return StatusCode::FAILURE;
+    }
+    if (pid == 0) {
+      m_shard = i;
+      m_children.clear();
+      break;
+    }
+    m_children.push_back(pid);
+  }
+
+  // contiguous ranges, so the merged output is in entry order
+  const size_t first = m_shard * total / m_nShards;
+  const size_t count = (m_shard + 1) * total / m_nShards - first;
+  if (podioDataSvc->setEntryRange(first, count, m_shard != 0).isFailure()) {
+    error() << "Unable to select entries " << first << " to " << first + count << endmsg;
+    return StatusCode::FAILURE;
+  }
+  if (appMgr->setProperty("EvtMax", static_cast<int>(count)).isFailure()) {
+    error() << "Unable to set the number of events of worker " << m_shard << endmsg;
+    return StatusCode::FAILURE;
+  }
+  if (m_nShards > 1) {
+    m_firstInputEntry = podioDataSvc->firstEntry();
+    reseed(m_firstInputEntry, kInitializeStream);
+    auto incidentSvc = service<IIncidentSvc>("IncidentSvc");
+    if (!incidentSvc) {
+      error() << "Unable to locate the IncidentSvc" << endmsg;
+      return StatusCode::FAILURE;
+    }
+    incidentSvc->addListener(this, IncidentType::BeginEvent);
+  }
+
+  info() << "Worker " << m_shard << " of " << m_nShards << " (pid " << ::getpid()
+         << "): entries " << first << " to " << first + count << endmsg;
+  return StatusCode::SUCCESS;
+}
+
+// The event loop of a worker is sequential, events are read in entry order
+void ShardingSvc::handle(const Incident& incident) {
+  if (incident.type() == IncidentType::BeginEvent) {
+    reseed(m_firstInputEntry + incident.context().evt(), kEventStream);
+  }
+}
+
+void ShardingSvc::reseed(const uint64_t entry, const uint64_t stream) {
+  const uint64_t key = mix(mix(entry) ^ stream);
+  std::vector<long> seeds(std::max<size_t>(m_seeds.size(), 1));
+  for (size_t i = 0; i < seeds.size(); ++i) {
+    const uint64_t base = i < m_seeds.size() ? static_cast<uint64_t>(m_seeds[i]) : 0;
+    // positive 31 bit seeds, 0 ends the list of seeds of the CLHEP engines
+    seeds[i] = static_cast<long>(mix(base ^ (key + i)) % 0x7fffffffULL) + 1;
+  }
+  if (m_rndmSvc->engine()->setSeeds(seeds).isFailure()) {
+    warning() << "Unable to reseed the random engine for entry " << entry << endmsg;
+  }
+}
+
+StatusCode ShardingSvc::finalize() {
+  StatusCode sc = StatusCode::SUCCESS;
+  if (m_shard == 0 && m_nShards > 1) {
+    if (!waitForWorkers()) {
+      error() << "Not all workers succeeded, the outputs are not merged" << endmsg;
+      sc = StatusCode::FAILURE;
+    } else {
+      for (const auto& output : m_outputs) {
+        if (!merge(output)) {
+          error() << "Failed to merge the worker outputs into " << output << endmsg;
+          sc = StatusCode::FAILURE;
+        } else {
+          info() << "Merged " << m_nShards << " worker outputs into " << output << endmsg;
+        }
+      }
+    }
+  }
+  m_rndmSvc.reset();
+  if (Service::finalize().isFailure()) {
+    return StatusCode::FAILURE;
+  }
+  return sc;
+}
+
+std::string ShardingSvc::outputFile(const std::string& filename) {
+  if (m_nShards == 1) {
+    return filename;
+  }
+  m_outputs.push_back(filename);
+  return shardFile(filename, m_shard);
+}
+
+std::string ShardingSvc::shardFile(const std::string& filename, const size_t shard) const {
+  const std::string ext = ".root";
+  if (filename.size() > ext.size() &&
+      filename.compare(filename.size() - ext.size(), ext.size(), ext) == 0) {
+    const auto stem = filename.substr(0, filename.size() - ext.size());
+    return fmt::format("{}.shard{}{}", stem, shard, ext);
+  }
+  return fmt::format("{}.shard{}", filename, shard);
+}
+
+bool ShardingSvc::waitForWorkers() {
+  bool success = true;
+  for (const pid_t pid : m_children) {
+    int status = 0;
+    if (::waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      error() << "Worker process " << pid << " failed" << endmsg;
+      success = false;
+    }
+  }
+  m_children.clear();
+  return success;
+}
+
+// The event trees are concatenated in worker order. Baskets are copied without recompressing
+// them when the compression settings match, so the merged file keeps the settings of the
+// workers. The trees with one entry per job (kJobTrees) are copied from the first worker.
+bool ShardingSvc::merge(const std::string& filename) const {
+  int compression = 0;
+  {
+    std::unique_ptr<TFile> first{TFile::Open(shardFile(filename, 0).c_str(), "READ")};
+    if (!first || first->IsZombie()) {
+      return false;
+    }
+    compression = first->GetCompressionSettings();
+  }
+  TFileMerger merger(false, false);
+  merger.SetMsgPrefix(name().c_str());
+  if (!merger.OutputFile(filename.c_str(), "RECREATE", compression)) {
+    return false;
+  }
+  for (size_t i = 0; i < m_nShards; ++i) {
+    if (!merger.AddFile(shardFile(filename, i).c_str(), false)) {
+      return false;
+    }
+  }
+  merger.AddObjectNames(kJobTrees);
+  if (!merger.PartialMerge(TFileMerger::kAll | TFileMerger::kRegular | TFileMerger::kSkipListed)) {
+    return false;
+  }
+  {
+    std::unique_ptr<TFile> first{TFile::Open(shardFile(filename, 0).c_str(), "READ")};
+    std::unique_ptr<TFile> merged{TFile::Open(filename.c_str(), "UPDATE")};
+    if (!first || first->IsZombie() || !merged || merged->IsZombie()) {
+      return false;
+    }
+    std::istringstream names{kJobTrees};
+    for (std::string name; names >> name;) {
+      if (auto* tree = first->Get<TTree>(name.c_str())) {
+        merged->cd();
+        tree->CloneTree(-1, "fast")->Write();
+      }
+    }
+  }
+  if (!m_keepShards) {
+    for (size_t i = 0; i < m_nShards; ++i) {
+      std::remove(shardFile(filename, i).c_str());
+    }
+  }
+  return true;
+}
@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Whitney Armstrong, Wouter Deconinck
+
+#ifndef SHARDINGSVC_H
+#define SHARDINGSVC_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+#include "GaudiKernel/IIncidentListener.h"
+#include "GaudiKernel/IRndmGenSvc.h"
+#include "GaudiKernel/Service.h"
+
+#include "JugBase/IShardingSvc.h"
+
+/** Sharding service.
+ *
+ *  Forks the worker processes when it is initialized. Only the forking thread continues in the
+ *  workers, so the process must not run other threads yet: ShardingSvc must come before the
+ *  AlgoServiceSvc (asynchronous log sink) and the GeoSvc in ExtSvc, and initialize fails if
+ *  more than one thread exists. Each worker reopens the input and processes its own range of
+ *  entries; the main process is worker 0. The main process waits for the other workers at
+ *  finalize, and merges the output files (see outputFile): the event trees are concatenated,
+ *  the metadata trees (one entry per job) are taken from worker 0.
+ *
+ *  The workers would all continue the random sequence of the Gaudi engine (RndmGenSvc) where
+ *  it was at the fork. They reseed it after the fork, and at every BeginEvent from the
+ *  configured seeds and the input entry of the event. The random numbers of an event then do
+ *  not depend on the number of workers (but differ from a run without sharding).
+ */
+class ShardingSvc : public extends<Service, IShardingSvc, IIncidentListener> {
+public:
+  ShardingSvc(const std::string& name, ISvcLocator* svc);
+
+  virtual ~ShardingSvc();
+
+  virtual StatusCode initialize() final;
+  virtual StatusCode finalize() final;
+
+  virtual size_t nShards() const final { return m_nShards; }
+  virtual size_t shard() const final { return m_shard; }
+  virtual std::string outputFile(const std::string& filename) final;
+
+  /// Reseed the random engine for the event (BeginEvent)
+  virtual void handle(const Incident& incident) final;
+
+private:
+  /// Name of the output of a worker
+  std::string shardFile(const std::string& filename, size_t shard) const;
+  /// Wait for the other workers, returns false if any of them failed
+  bool waitForWorkers();
+  bool merge(const std::string& filename) const;
+  /// Seed the random engine from the configured seeds, the input entry and the stream
+  /// (events or initialize)
+  void reseed(uint64_t entry, uint64_t stream);
+
+  Gaudi::Property<int> m_workers{this, "workers", 1,
+                                 "Number of worker processes (0: one per core)"};
+  Gaudi::Property<bool> m_keepShards{this, "keepShards", false,
+                                     "Keep the outputs of the workers after merging"};
+
+  size_t m_nShards{1};
+  size_t m_shard{0};
+  /// Input entry of the first event of this worker (including FirstEventEntry)
+  uint64_t m_firstInputEntry{0};
+  SmartIF<IRndmGenSvc> m_rndmSvc;
+  /// Seeds of the random engine before the fork
+  std::vector<long> m_seeds;
+  std::vector<pid_t> m_children;
+  /// Output files to merge
+  std::vector<std::string> m_outputs;
+};
+
+#endif // SHARDINGSVC_H
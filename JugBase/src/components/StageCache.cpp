@@ -0,0 +1,497 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Whitney Armstrong, Wouter Deconinck
+
+#include "StageCache.h"
+#include "GeometryCache.h"
+#include "GaudiKernel/IDataHandleHolder.h"
+#include "GaudiKernel/IRndmEngine.h"
+#include "GaudiKernel/IRndmGenSvc.h"
+#include "JugBase/DataWrapper.h"
+#include "JugBase/IShardingSvc.h"
+#include "podio/ICollectionProvider.h"
+#include "TFile.h"
+#include "rootutils.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <set>
+#include <string_view>
+#include <unordered_map>
+
+#include <fmt/format.h>
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+DECLARE_COMPONENT(StageCache)
+
+namespace {
+  /// Properties that do not change the outputs of an algorithm (or service)
+  bool ignoredProperty(std::string_view name) {
+    static const std::set<std::string_view> ignored{
+        "OutputLevel", "Enable",     "ErrorMax",  "Timeline",           "RegisterForContextService",
+        "ErrorsPrint", "StatPrint",  "TypePrint", "PrintEmptyCounters", "PropertiesPrint",
+        "MonitorService",
+        // AlgoServiceSvc
+        "asyncLogging", "logQueueSize",
+        // GeoSvc
+        "cacheDirectory", "surfacesObjFile", "fieldGridFile", "fieldGridCheck"};
+    return name.rfind("Audit", 0) == 0 || ignored.count(name) > 0;
+  }
+
+  /// Add the properties that can change the outputs, in declaration order
+  void addProperties(GeometryCache::Hash& hash, const IProperty& component) {
+    for (const auto* property : component.getProperties()) {
+      const std::string_view name{property->name()};
+      if (ignoredProperty(name)) {
+        continue;
+      }
+      hash.add(name).add('\0');
+      hash.add(std::string_view{property->toString()}).add('\0');
+    }
+  }
+
+  /// Add the name, size and modification time of a file (the latter are not available for
+  /// remote files)
+  void addFile(GeometryCache::Hash& hash, const std::string& fname) {
+    hash.add(std::string_view{fname}).add('\0');
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(fname, ec);
+    if (!ec) {
+      hash.add(static_cast<uint64_t>(size));
+    }
+    const auto mtime = std::filesystem::last_write_time(fname, ec);
+    if (!ec) {
+      hash.add(static_cast<int64_t>(mtime.time_since_epoch().count()));
+    }
+  }
+
+  /// Collection name of a data handle key ("/Event/Name")
+  std::string collectionName(const std::string& key) { return key.substr(key.find_last_of('/') + 1); }
+
+  /// The collections read from the cache file, by their ID in the file
+  class CachedCollections : public podio::ICollectionProvider {
+  public:
+    bool get(int collectionID, podio::CollectionBase*& collection) const override {
+      const auto it = m_collections.find(collectionID);
+      collection    = it == m_collections.end() ? nullptr : it->second;
+      return collection != nullptr;
+    }
+    void add(int collectionID, podio::CollectionBase* collection) { m_collections[collectionID] = collection; }
+
+  private:
+    std::unordered_map<int, podio::CollectionBase*> m_collections;
+  };
+} // namespace
+
+StageCache::StageCache(const std::string& name, ISvcLocator* svcLoc) : GaudiAlgorithm(name, svcLoc) {}
+
+StageCache::~StageCache() = default;
+
+StatusCode StageCache::initialize() {
+  if (GaudiAlgorithm::initialize().isFailure()) {
+    return StatusCode::FAILURE;
+  }
+  m_podioDataSvc = dynamic_cast<PodioDataSvc*>(evtSvc().get());
+  if (m_podioDataSvc == nullptr) {
+    error() << "Failed to get the DataSvc" << endmsg;
+    return StatusCode::FAILURE;
+  }
+  for (const auto& typeName : m_memberNames) {
+    const auto pos         = typeName.find('/');
+    const std::string type = typeName.substr(0, pos);
+    const std::string name = pos == std::string::npos ? type : typeName.substr(pos + 1);
+    Gaudi::Algorithm* alg  = nullptr;
+    if (createSubAlgorithm(type, name, alg).isFailure() || alg == nullptr) {
+      error() << "Unable to create member " << typeName << endmsg;
+      return StatusCode::FAILURE;
+    }
+    m_members.push_back({alg, 0, {}});
+  }
+  return StatusCode::SUCCESS;
+}
+
+StatusCode StageCache::start() {
+  if (GaudiAlgorithm::start().isFailure()) {
+    return StatusCode::FAILURE;
+  }
+  if (m_directory.value().empty() || m_members.empty()) {
+    return StatusCode::SUCCESS;
+  }
+  if (m_podioDataSvc->inputEntries() < 0) {
+    warning() << "No input file, the outputs of the stage are not cached" << endmsg;
+    return StatusCode::SUCCESS;
+  }
+
+  // keys and outputs (the data handles are only complete after the members are initialized)
+  const auto collIDTable = m_podioDataSvc->getCollectionIDs();
+  std::set<std::string> produced;
+  uint64_t key = inputKey();
+  for (auto& member : m_members) {
+    member.key = key = memberKey(*member.alg, key);
+    member.outputs.clear();
+    auto* holder = dynamic_cast<IDataHandleHolder*>(member.alg);
+    if (holder == nullptr) {
+      continue;
+    }
+    for (const auto* handle : holder->inputHandles()) {
+      const auto name = collectionName(handle->fullKey().key());
+      if (produced.count(name) == 0 && !collIDTable->present(name)) {
+        warning() << "Input " << name << " of " << member.alg->name()
+                  << " is not read from the input file, changes upstream of " << this->name()
+                  << " are not detected" << endmsg;
+      }
+    }
+    for (const auto* handle : holder->outputHandles()) {
+      member.outputs.push_back(collectionName(handle->fullKey().key()));
+      produced.insert(member.outputs.back());
+    }
+    if (msgLevel(MSG::DEBUG)) {
+      debug() << "Key of " << member.alg->name() << ": " << fmt::format("{:016x}", member.key) << endmsg;
+    }
+  }
+
+  // entries of the input this job processes
+  auto appMgr = service<IProperty>("ApplicationMgr");
+  Gaudi::Property<int> evtMax{"EvtMax", -1};
+  if (!appMgr || appMgr->getProperty(&evtMax).isFailure()) {
+    error() << "Unable to get the number of events from the ApplicationMgr" << endmsg;
+    return StatusCode::FAILURE;
+  }
+  Long64_t nEvents = m_podioDataSvc->inputEntries();
+  if (evtMax.value() >= 0) {
+    nEvents = std::min<Long64_t>(nEvents, evtMax.value());
+  }
+  m_entry = m_podioDataSvc->firstEntry();
+
+  // the file with the longest matching prefix
+  m_nCached = 0;
+  for (auto& file : scanDirectory()) {
+    if (file.entries < m_entry + nEvents) {
+      continue;
+    }
+    size_t n = 0;
+    while (n < file.keys.size() && n < m_members.size() && file.keys[n] == m_members[n].key) {
+      ++n;
+    }
+    if (n > m_nCached) {
+      m_nCached   = n;
+      m_cacheFile = std::move(file);
+    }
+  }
+  if (m_nCached > 0) {
+    m_reader = std::make_unique<podio::ROOTReader>();
+    m_reader->openFile(m_cacheFile.filename);
+    m_readTable = m_reader->getCollectionIDTable();
+    if (m_nCached == m_cacheFile.keys.size()) {
+      m_superseded = m_cacheFile.filename;
+    }
+  }
+  info() << "Reading the outputs of " << m_nCached << " of " << m_members.size() << " members"
+         << (m_nCached > 0 ? " from " + m_cacheFile.filename : std::string()) << endmsg;
+
+  bool sharded = false;
+  if (auto shardingSvc = service<IShardingSvc>("ShardingSvc", false, true)) {
+    sharded = shardingSvc->nShards() > 1;
+  }
+  m_writing = m_write && m_nCached < m_members.size() && m_entry == 0 && !sharded;
+  if (m_write && m_nCached < m_members.size() && !m_writing) {
+    info() << "The outputs are not stored, the input is sharded or not processed from its first entry"
+           << endmsg;
+  }
+  return StatusCode::SUCCESS;
+}
+
+StatusCode StageCache::execute() {
+  if (m_nCached > 0 && readCached().isFailure()) {
+    return StatusCode::FAILURE;
+  }
+  for (size_t i = m_nCached; i < m_members.size(); ++i) {
+    if (m_members[i].alg->sysExecute(getContext()).isFailure()) {
+      error() << "Execution of " << m_members[i].alg->name() << " failed" << endmsg;
+      return StatusCode::FAILURE;
+    }
+  }
+  if (m_firstEvent) {
+    m_firstEvent = false;
+    if (m_writing) {
+      openOutput();
+    }
+  }
+  if (m_writing) {
+    writeOutputs();
+  }
+  ++m_entry;
+  return StatusCode::SUCCESS;
+}
+
+StatusCode StageCache::finalize() {
+  if (m_file) {
+    m_file->cd();
+    auto* metadatatree     = new TTree("metadata", "Metadata tree");
+    const auto collIDTable = m_podioDataSvc->getCollectionIDs();
+    metadatatree->Branch("CollectionIDs", collIDTable);
+    metadatatree->Branch("CollectionTypeInfo", &m_collectionInfo);
+    metadatatree->Fill();
+
+    auto* stagetree = new TTree("stage", "Stored members of the stage");
+    std::string member;
+    ULong64_t key = 0;
+    std::vector<std::string> outputs;
+    stagetree->Branch("member", &member);
+    stagetree->Branch("key", &key);
+    stagetree->Branch("outputs", &outputs);
+    for (size_t i = 0; i < m_nStored; ++i) {
+      member  = m_members[i].alg->name();
+      key     = m_members[i].key;
+      outputs = m_members[i].outputs;
+      stagetree->Fill();
+    }
+    const Long64_t entries = m_datatree->GetEntries();
+    m_file->Write();
+    m_file->Close();
+    m_file.reset();
+    m_datatree = nullptr;
+
+    if (std::rename(m_tmpFilename.c_str(), m_outFilename.c_str()) != 0) {
+      warning() << "Unable to rename " << m_tmpFilename << " to " << m_outFilename << endmsg;
+      std::remove(m_tmpFilename.c_str());
+    } else {
+      info() << "Stored the outputs of " << m_nStored << " members (" << entries << " events) in "
+             << m_outFilename << endmsg;
+      if (!m_superseded.empty() && m_superseded != m_outFilename) {
+        std::remove(m_superseded.c_str());
+      }
+    }
+  }
+  m_reader.reset();
+  return GaudiAlgorithm::finalize();
+}
+
+uint64_t StageCache::inputKey() const {
+  GeometryCache::Hash hash;
+  for (const auto& fname : m_podioDataSvc->inputFiles()) {
+    addFile(hash, fname);
+  }
+  hash.add(std::string_view{m_salt.value()});
+  // members drawing random numbers depend on the engine and its seeds (the service only exists
+  // if something uses it, the members are initialized by now)
+  if (auto rndmSvc = service<IRndmGenSvc>("RndmGenSvc", false, true)) {
+    hash.add(std::string_view{"RndmGenSvc"}).add('\0');
+    addProperties(hash, *SmartIF<IProperty>{rndmSvc});
+    if (SmartIF<IProperty> engine{rndmSvc->engine()}) {
+      addProperties(hash, *engine);
+    }
+  }
+  // the seed of the algorithms::RandomSvc (JugAlgo algorithms)
+  if (auto algoSvc = service<IProperty>("AlgoServiceSvc", false, true)) {
+    hash.add(std::string_view{"AlgoServiceSvc"}).add('\0');
+    addProperties(hash, *algoSvc);
+  }
+  // the geometry: the GeoSvc settings, and the compact and material files
+  if (auto geoSvc = service<IProperty>("GeoSvc", false, true)) {
+    hash.add(std::string_view{"GeoSvc"}).add('\0');
+    addProperties(hash, *geoSvc);
+    Gaudi::Property<std::vector<std::string>> detectors{"detectors", {}};
+    Gaudi::Property<std::string> materials{"materials", ""};
+    if (geoSvc->getProperty(&detectors).isSuccess()) {
+      for (const auto& fname : detectors.value()) {
+        addFile(hash, fname);
+      }
+    }
+    if (geoSvc->getProperty(&materials).isSuccess() && !materials.value().empty()) {
+      addFile(hash, materials.value());
+    }
+  }
+  return hash.value();
+}
+
+uint64_t StageCache::memberKey(const Gaudi::Algorithm& alg, const uint64_t previous) const {
+  GeometryCache::Hash hash;
+  hash.add(previous);
+  hash.add(std::string_view{alg.type()}).add('\0');
+  hash.add(std::string_view{alg.name()}).add('\0');
+  addProperties(hash, alg);
+  return hash.value();
+}
+
+std::vector<StageCache::CacheFile> StageCache::scanDirectory() const {
+  std::vector<CacheFile> files;
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator(m_directory.value(), ec)) {
+    const auto& path = entry.path();
+    if (path.extension() != ".root" || path.filename().string().rfind("stage-", 0) != 0) {
+      continue;
+    }
+    std::unique_ptr<TFile> file{TFile::Open(path.c_str(), "READ")};
+    if (!file || file->IsZombie()) {
+      continue;
+    }
+    auto* stagetree = file->Get<TTree>("stage");
+    auto* datatree  = file->Get<TTree>("events");
+    if (stagetree == nullptr || datatree == nullptr) {
+      continue;
+    }
+    CacheFile cache{path.string(), {}, {}, datatree->GetEntries()};
+    ULong64_t key                     = 0;
+    std::vector<std::string>* outputs = nullptr;
+    stagetree->SetBranchAddress("key", &key);
+    stagetree->SetBranchAddress("outputs", &outputs);
+    for (Long64_t i = 0; i < stagetree->GetEntries(); ++i) {
+      stagetree->GetEntry(i);
+      cache.keys.push_back(key);
+      cache.outputs.push_back(*outputs);
+    }
+    stagetree->ResetBranchAddresses();
+    delete outputs;
+    files.push_back(std::move(cache));
+  }
+  return files;
+}
+
+StatusCode StageCache::readCached() {
+  m_reader->goToEvent(m_entry);
+  // readCollection is only public through the interface
+  podio::IReader& reader = *m_reader;
+  CachedCollections provider;
+  std::vector<std::pair<std::string, std::unique_ptr<podio::CollectionBase>>> collections;
+  for (size_t i = 0; i < m_nCached; ++i) {
+    for (const auto& name : m_cacheFile.outputs[i]) {
+      std::unique_ptr<podio::CollectionBase> collection{reader.readCollection(name)};
+      if (!collection) {
+        error() << "Cannot read collection " << name << " from " << m_cacheFile.filename << endmsg;
+        return StatusCode::FAILURE;
+      }
+      collection->prepareAfterRead();
+      provider.add(m_readTable->collectionID(name), collection.get());
+      collections.emplace_back(name, std::move(collection));
+    }
+  }
+  // the relations refer to the collection IDs of the job that wrote the file
+  for (auto& [name, collection] : collections) {
+    collection->setReferences(&provider);
+  }
+  for (auto& [name, collection] : collections) {
+    auto* wrapper = new DataWrapper<podio::CollectionBase>;
+    wrapper->setData(collection.release());
+    if (evtSvc()->registerObject("/Event/" + name, wrapper).isFailure()) {
+      error() << "Unable to register collection " << name << endmsg;
+      delete wrapper;
+      return StatusCode::FAILURE;
+    }
+  }
+  m_reader->endOfEvent();
+  return StatusCode::SUCCESS;
+}
+
+void StageCache::openOutput() {
+  // the stored prefix ends at the first member with an output that is not a podio collection
+  m_nStored = 0;
+  while (m_nStored < m_members.size() &&
+         std::all_of(m_members[m_nStored].outputs.begin(), m_members[m_nStored].outputs.end(),
+                     [this](const auto& name) { return collection(name) != nullptr; })) {
+    ++m_nStored;
+  }
+  if (m_nStored <= m_nCached) {
+    m_writing = false;
+    info() << "No more members than the cached ones can be stored" << endmsg;
+    return;
+  }
+
+  std::error_code ec;
+  std::filesystem::create_directories(m_directory.value(), ec);
+  m_outFilename = fmt::format("{}/stage-{:016x}.root", m_directory.value(), m_members[m_nStored - 1].key);
+  m_tmpFilename = fmt::format("{}.{}.tmp", m_outFilename, ::getpid());
+  m_file        = std::unique_ptr<TFile>(TFile::Open(m_tmpFilename.c_str(), "RECREATE", "stage cache file"));
+  if (!m_file || m_file->IsZombie()) {
+    m_file.reset();
+    abandonOutput("unable to create " + m_tmpFilename);
+    return;
+  }
+  m_datatree = new TTree("events", "Events tree");
+
+  for (size_t i = 0; i < m_nStored; ++i) {
+    for (const auto& collName : m_members[i].outputs) {
+      auto* coll = collection(collName);
+      coll->prepareForWrite();
+      auto buffers = coll->getBuffers();
+
+      const std::string className     = coll->getValueTypeName();
+      const std::string collClassName = "vector<" + className + "Data>";
+      m_datatree->Branch(collName.c_str(), collClassName.c_str(), buffers.data);
+      if (auto* refColls = buffers.references) {
+        int j = 0;
+        for (auto& c : (*refColls)) {
+          const auto brName = podio::root_utils::refBranch(collName, j);
+          m_datatree->Branch(brName.c_str(), c.get());
+          ++j;
+        }
+      }
+      if (auto* vminfo = buffers.vectorMembers) {
+        int j = 0;
+        for (auto& [dataType, add] : (*vminfo)) {
+          const std::string typeName = "vector<" + dataType + ">";
+          const auto brName          = podio::root_utils::vecBranch(collName, j);
+          m_datatree->Branch(brName.c_str(), typeName.c_str(), add);
+          ++j;
+        }
+      }
+      const auto collID = m_podioDataSvc->getCollectionIDs()->collectionID(collName);
+      m_collectionInfo.emplace_back(collID, className + "Collection", coll->isSubsetCollection());
+    }
+  }
+}
+
+void StageCache::writeOutputs() {
+  for (size_t i = 0; i < m_nStored; ++i) {
+    for (const auto& collName : m_members[i].outputs) {
+      auto* coll = collection(collName);
+      if (coll == nullptr) {
+        abandonOutput("collection " + collName + " is missing");
+        return;
+      }
+      // reconnect the branches, the buffers can move
+      coll->prepareForWrite();
+      auto buffers = coll->getBuffers();
+      m_datatree->SetBranchAddress(collName.c_str(), buffers.data);
+      if (auto* refColls = buffers.references) {
+        for (size_t j = 0; j < refColls->size(); ++j) {
+          const auto brName = podio::root_utils::refBranch(collName, j);
+          m_datatree->GetBranch(brName.c_str())->SetAddress(&(*refColls)[j]);
+        }
+      }
+      if (auto* vminfo = buffers.vectorMembers) {
+        int j = 0;
+        for (auto& [dataType, add] : (*vminfo)) {
+          const auto brName = podio::root_utils::vecBranch(collName, j);
+          m_datatree->SetBranchAddress(brName.c_str(), add);
+          ++j;
+        }
+      }
+    }
+  }
+  if (m_datatree->Fill() < 0) {
+    abandonOutput("failed to fill the tree");
+  }
+}
+
+void StageCache::abandonOutput(const std::string& reason) {
+  warning() << "The outputs of the stage are not stored: " << reason << endmsg;
+  m_writing  = false;
+  m_datatree = nullptr;
+  if (m_file) {
+    m_file->Close();
+    m_file.reset();
+    std::remove(m_tmpFilename.c_str());
+  }
+}
+
+podio::CollectionBase* StageCache::collection(const std::string& name) {
+  DataObject* obj = nullptr;
+  if (evtSvc()->retrieveObject("/Event/" + name, obj).isFailure()) {
+    return nullptr;
+  }
+  auto* wrapper = dynamic_cast<DataWrapperBase*>(obj);
+  return wrapper == nullptr ? nullptr : wrapper->collectionBase();
+}
@@ -0,0 +1,141 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Whitney Armstrong, Wouter Deconinck
+
+#ifndef JUGBASE_STAGECACHE_H
+#define JUGBASE_STAGECACHE_H
+
+#include "GaudiAlg/GaudiAlgorithm.h"
+#include "JugBase/PodioDataSvc.h"
+#include "podio/CollectionBase.h"
+#include "podio/ROOTReader.h"
+
+#include "TTree.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// forward declarations
+class TFile;
+
+/** Run a chain of algorithms (a reconstruction stage), reusing their outputs from an earlier
+ *  job with the same settings.
+ *
+ *  The members are run in order, as by a sequencer, and are taken out of the TopAlg list, e.g.
+ *    StageCache("CalStage", members=[digi.getFullName(), reco.getFullName(), clus.getFullName()])
+ *
+ *  Every member gets a key: a hash of its type, name and properties (except OutputLevel and the
+ *  like), chained with the key of the member before it. The chain starts from the input files
+ *  (names, sizes and modification times), the random engine configuration and seeds (if the
+ *  RndmGenSvc is used), the AlgoServiceSvc settings (seed of the algorithms::RandomSvc), the
+ *  GeoSvc settings with its compact and material files (names, sizes and modification times),
+ *  and salt. A changed member changes its own key and those of the members after it, but not
+ *  those before it.
+ *
+ *  The podio collections of the output data handles of the members are stored in a side file
+ *  in directory, with the keys of the members they belong to. At start, the file with the
+ *  longest prefix of matching keys is looked up. The members of that prefix are not run, their
+ *  outputs are read from the file instead, so the stage only recomputes from the first changed
+ *  member. When more members can be stored than were found, a new file is written (renamed into
+ *  place at finalize), and a file it supersedes is removed.
+ *
+ *  Limitations:
+ *   - only podio collections are stored: the stored prefix ends at the first member with
+ *     another output (e.g. ACTS containers)
+ *   - the relations of the stored collections can only point to collections of the same file
+ *   - inputs of the members that are not read from the input file (but produced by algorithms
+ *     before the stage) are not part of the keys, a warning is printed for them
+ *   - events are matched by their input entry: a file is only written when the input is
+ *     processed from its first entry without sharding (it can be read when sharding, unless
+ *     the RndmGenSvc is used, as the ShardingSvc reseeds it per worker)
+ *   - only the top-level compact files are part of the keys, not the files they include (or
+ *     the DD4hep plugins), use salt for those as well
+ *   - the members are not treated as filters, and code changes are not part of the keys, use
+ *     salt (e.g. the software version) for those
+ *
+ *  \ingroup base
+ */
+class StageCache : public GaudiAlgorithm {
+
+public:
+  StageCache(const std::string& name, ISvcLocator* svcLoc);
+  ~StageCache();
+
+  /// Creates the members (as sub-algorithms, they are initialized after this)
+  StatusCode initialize() override;
+  /// Computes the keys and looks up the cache
+  StatusCode start() override;
+  /// Reads the cached outputs, runs the other members, stores the outputs
+  StatusCode execute() override;
+  /// Writes the new cache file
+  StatusCode finalize() override;
+
+private:
+  struct Member {
+    Gaudi::Algorithm* alg{nullptr};
+    uint64_t key{0};
+    /// Names of the output collections
+    std::vector<std::string> outputs;
+  };
+
+  /// The stored members of a cache file
+  struct CacheFile {
+    std::string filename;
+    std::vector<uint64_t> keys;
+    std::vector<std::vector<std::string>> outputs;
+    Long64_t entries{0};
+  };
+
+  /// Hash of the input files and salt, the start of the key chain
+  uint64_t inputKey() const;
+  /// Key of a member, chained with the key before it
+  uint64_t memberKey(const Gaudi::Algorithm& alg, uint64_t previous) const;
+  /// Read the keys of all cache files in the directory
+  std::vector<CacheFile> scanDirectory() const;
+  /// Read the outputs of the first m_nCached members from the cache file
+  StatusCode readCached();
+  /// First event: decide which members can be stored, and create the file for them
+  void openOutput();
+  /// Store the outputs of the first m_nStored members
+  void writeOutputs();
+  /// Stop writing (on failure), the temporary file is removed
+  void abandonOutput(const std::string& reason);
+  /// A podio collection in the event store (nullptr if there is none)
+  podio::CollectionBase* collection(const std::string& name);
+
+  Gaudi::Property<std::vector<std::string>> m_memberNames{
+      this, "members", {}, "Algorithms of the stage ('Type/Name'), run in this order"};
+  Gaudi::Property<std::string> m_directory{
+      this, "directory", "stage_cache", "Directory of the cache files (empty: only run the members)"};
+  Gaudi::Property<std::string> m_salt{
+      this, "salt", "", "Added to the keys, e.g. the software version"};
+  Gaudi::Property<bool> m_write{this, "write", true, "Store the outputs for the next jobs"};
+
+  PodioDataSvc* m_podioDataSvc{nullptr};
+  std::vector<Member> m_members;
+
+  /// Members whose outputs are read from m_cacheFile (a prefix of the members)
+  size_t m_nCached{0};
+  CacheFile m_cacheFile;
+  std::unique_ptr<podio::ROOTReader> m_reader;
+  PodioDataSvc::CollectionIDTable_ptr m_readTable;
+  /// Input entry of the current event
+  Long64_t m_entry{0};
+
+  /// Members whose outputs are stored (decided at the first event)
+  size_t m_nStored{0};
+  bool m_writing{false};
+  bool m_firstEvent{true};
+  std::string m_tmpFilename;
+  std::string m_outFilename;
+  std::unique_ptr<TFile> m_file;
+  /// Owned by the file
+  TTree* m_datatree{nullptr};
+  std::vector<std::tuple<int, std::string, bool>> m_collectionInfo;
+  /// A cache file that is superseded by the new one
+  std::string m_superseded;
+};
+
+#endif
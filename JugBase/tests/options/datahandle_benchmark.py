@@ -0,0 +1,18 @@
+# Microbenchmark of DataHandle::get (DataHandleBenchmark), reports the time per lookup at
+# finalize
+from Gaudi.Configuration import *
+from Configurables import ApplicationMgr, EICDataSvc, PodioInput
+from Configurables import DataHandleBenchmark
+
+podioevent = EICDataSvc("EventDataSvc", inputs=["derp.root"])
+
+podioinput = PodioInput("PodioReader", collections=["MCParticles"])
+bench = DataHandleBenchmark("DataHandleBenchmark", particles="MCParticles", calls=10000)
+
+ApplicationMgr(
+    TopAlg = [podioinput, bench],
+    EvtSel = 'NONE',
+    EvtMax   = 100,
+    ExtSvc = [podioevent],
+    OutputLevel=INFO
+ )
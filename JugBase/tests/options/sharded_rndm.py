@@ -0,0 +1,20 @@
+# Sharded job printing a draw of the random engine per event (RndmTestConsumer), checked by
+# tests/scripts/check_sharded_rndm.py. The number of workers can be changed with
+#   --option "from Configurables import ShardingSvc; ShardingSvc().workers = 3"
+from Gaudi.Configuration import *
+from Configurables import ApplicationMgr, EICDataSvc, PodioInput, ShardingSvc
+from Configurables import RndmTestConsumer
+
+podioevent = EICDataSvc("EventDataSvc", inputs=["derp.root"])
+sharding = ShardingSvc("ShardingSvc", workers=2)
+
+podioinput = PodioInput("PodioReader", collections=["MCParticles"])
+draws = RndmTestConsumer("RndmTestConsumer")
+
+ApplicationMgr(
+    TopAlg = [podioinput, draws],
+    EvtSel = 'NONE',
+    EvtMax   = 10,
+    ExtSvc = [podioevent, sharding],
+    OutputLevel=INFO
+ )
@@ -0,0 +1,46 @@
+#!/usr/bin/env python3
+"""Run tests/options/sharded_rndm.py with 2 and 3 workers, and check that
+
+- every entry gets its own random numbers: the workers do not repeat each other's draws,
+- the draw of an entry does not depend on the number of workers.
+
+usage: check_sharded_rndm.py <gaudirun command...>
+"""
+import re
+import subprocess
+import sys
+
+OPTIONS = 'JugBase/tests/options/sharded_rndm.py'
+DRAW = re.compile(r'RndmTestConsumer\s+INFO entry (\d+) draw (\S+)')
+
+
+def run(gaudirun, workers):
+    cmd = gaudirun + [OPTIONS, '--option',
+                      f'from Configurables import ShardingSvc; ShardingSvc().workers = {workers}']
+    proc = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+    print(proc.stdout)
+    if proc.returncode != 0:
+        sys.exit(f'{workers} workers: gaudirun failed ({proc.returncode})')
+    draws = {}
+    for entry, value in DRAW.findall(proc.stdout):
+        if entry in draws:
+            sys.exit(f'{workers} workers: entry {entry} processed twice')
+        draws[entry] = value
+    return draws
+
+
+def main():
+    gaudirun = sys.argv[1:] or ['gaudirun.py']
+    two = run(gaudirun, 2)
+    three = run(gaudirun, 3)
+    if len(two) < 2:
+        sys.exit(f'expected at least 2 events, got {len(two)}')
+    if len(set(two.values())) != len(two):
+        sys.exit('2 workers: draws repeated between the entries')
+    if two != three:
+        sys.exit('the draws depend on the number of workers')
+    print(f'{len(two)} entries, no repeated draws')
+
+
+if __name__ == '__main__':
+    main()
@@ -77,6 +77,8 @@ namespace Jug::Digi {
     // unitless counterparts of inputs
     double           dyRangeADC{0}, stepTDC{0}, tRes{0}, eRes[3] = {0., 0., 0.};
     Rndm::Numbers    m_normDist;
+    // per-event buffer of normal random numbers, drawn in bulk
+    std::vector<double> m_normBuffer;
     SmartIF<IGeoSvc> m_geoSvc;
     uint64_t         id_mask{0}, ref_mask{0};
 
@@ -157,33 +159,41 @@ namespace Jug::Digi {
     StatusCode execute() override
     {
       if (!u_fields.value().empty()) {
-        signal_sum_digi();
-      } else {
-        single_hits_digi();
+        return signal_sum_digi();
       }
-      return StatusCode::SUCCESS;
+      return single_hits_digi();
     }
 
   private:
-    void single_hits_digi() {
+    // number of normal random numbers used per output hit
+    static constexpr size_t kSingleHitRndm = 3;
+    static constexpr size_t kSumHitRndm    = 5;
+
+    StatusCode single_hits_digi() {
       // input collections
       const auto* const simhits = m_inputHitCollection.get();
       // Create output collections
       auto* rawhits = m_outputHitCollection.createAndPut();
+      // draw all random numbers for this event at once
+      if (m_normDist.shootArray(m_normBuffer, kSingleHitRndm * simhits->size()).isFailure()) {
+        error() << "Failed to generate random numbers" << endmsg;
+        return StatusCode::FAILURE;
+      }
+      const double* rndm = m_normBuffer.data();
       for (const auto& ahit : *simhits) {
         // Note: juggler internal unit of energy is GeV
         const double eDep    = ahit.getEnergy();
 
         // apply additional calorimeter noise to corrected energy deposit
         const double eResRel = (eDep > m_threshold)
-            ? m_normDist() * std::sqrt(
+            ? rndm[0] * std::sqrt(
                   std::pow(eRes[0] / std::sqrt(eDep), 2) +
                   std::pow(eRes[1], 2) +
                   std::pow(eRes[2] / (eDep), 2)
               )
             : 0;
 
-        const double ped    = m_pedMeanADC + m_normDist() * m_pedSigmaADC;
+        const double ped    = m_pedMeanADC + rndm[1] * m_pedSigmaADC;
         const long long adc = std::llround(ped +  eDep * (m_corrMeanScale + eResRel) / dyRangeADC * m_capADC);
 
         double time = std::numeric_limits<double>::max();
@@ -192,7 +202,8 @@ namespace Jug::Digi {
             time = c.getTime();
           }
         }
-        const long long tdc = std::llround((time + m_normDist() * tRes) * stepTDC);
+        const long long tdc = std::llround((time + rndm[2] * tRes) * stepTDC);
+        rndm += kSingleHitRndm;
 
         edm4eic::RawCalorimeterHit rawhit(
           ahit.getCellID(),
@@ -201,9 +212,10 @@ namespace Jug::Digi {
         );
         rawhits->push_back(rawhit);
       }
+      return StatusCode::SUCCESS;
     }
 
-    void signal_sum_digi() {
+    StatusCode signal_sum_digi() {
       const auto* const simhits = m_inputHitCollection.get();
       auto* rawhits = m_outputHitCollection.createAndPut();
 
@@ -220,6 +232,13 @@ namespace Jug::Digi {
         }
       }
 
+      // draw all random numbers for this event at once
+      if (m_normDist.shootArray(m_normBuffer, kSumHitRndm * merge_map.size()).isFailure()) {
+        error() << "Failed to generate random numbers" << endmsg;
+        return StatusCode::FAILURE;
+      }
+      const double* rndm = m_normBuffer.data();
+
       // signal sum
       for (auto &[id, hits] : merge_map) {
         double edep     = hits[0].getEnergy();
@@ -240,14 +259,15 @@ namespace Jug::Digi {
 
         // safety check
         const double eResRel = (edep > m_threshold)
-            ? m_normDist() * eRes[0] / std::sqrt(edep) +
-              m_normDist() * eRes[1] +
-              m_normDist() * eRes[2] / edep
+            ? rndm[0] * eRes[0] / std::sqrt(edep) +
+              rndm[1] * eRes[1] +
+              rndm[2] * eRes[2] / edep
             : 0;
 
-        double    ped     = m_pedMeanADC + m_normDist() * m_pedSigmaADC;
+        double    ped     = m_pedMeanADC + rndm[3] * m_pedSigmaADC;
         unsigned long long adc     = std::llround(ped + edep * (1. + eResRel) / dyRangeADC * m_capADC);
-        unsigned long long tdc     = std::llround((time + m_normDist() * tRes) * stepTDC);
+        unsigned long long tdc     = std::llround((time + rndm[4] * tRes) * stepTDC);
+        rndm += kSumHitRndm;
 
         edm4eic::RawCalorimeterHit rawhit(
           id,
@@ -256,6 +276,7 @@ namespace Jug::Digi {
         );
         rawhits->push_back(rawhit);
       }
+      return StatusCode::SUCCESS;
     }
   };
   // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
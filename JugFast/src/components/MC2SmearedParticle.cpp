@@ -2,7 +2,13 @@
 // Copyright (C) 2022 Sylvester Joosten, Whitney Armstrong, Wouter Deconinck
 
 #include <JugAlgo/Algorithm.h>
+#include <JugAlgo/ReentrantAlgorithm.h>
 #include <algorithms/truth/MC2SmearedParticle.h>
 
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
 JUGALGO_DEFINE_ALGORITHM(MC2SmearedParticle, algorithms::truth::MC2SmearedParticle, Jug::Fast)
+
+// Same algorithm for multi-threaded (Gaudi Hive) jobs
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+JUGALGO_DEFINE_REENTRANT_ALGORITHM(ReentrantMC2SmearedParticle,
+                                   algorithms::truth::MC2SmearedParticle, Jug::Fast)
@@ -2,7 +2,13 @@
 // Copyright (C) 2022 Sylvester Joosten, Wouter Deconinck
 
 #include <JugAlgo/Algorithm.h>
+#include <JugAlgo/ReentrantAlgorithm.h>
 #include <algorithms/truth/ParticlesWithTruthPID.h>
 
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
 JUGALGO_DEFINE_ALGORITHM(ParticlesWithTruthPID, algorithms::truth::ParticlesWithTruthPID, Jug::Fast)
+
+// Same algorithm for multi-threaded (Gaudi Hive) jobs
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+JUGALGO_DEFINE_REENTRANT_ALGORITHM(ReentrantParticlesWithTruthPID,
+                                   algorithms::truth::ParticlesWithTruthPID, Jug::Fast)
@@ -9,6 +9,8 @@
 #include "fmt/ranges.h"
 #include <algorithm>
 #include <bitset>
+#include <cmath>
+#include <unordered_map>
 
 #include "Gaudi/Property.h"
 #include "GaudiAlg/GaudiAlgorithm.h"
@@ -18,11 +20,17 @@
 #include "GaudiKernel/RndmGenerators.h"
 #include "GaudiKernel/ToolHandle.h"
 
+#include "DD4hep/DD4hepUnits.h"
 #include "DDRec/CellIDPositionConverter.h"
 #include "DDRec/Surface.h"
 #include "DDRec/SurfaceManager.h"
+#include "DDSegmentation/CartesianGridXY.h"
+#include "DDSegmentation/CartesianGridXZ.h"
+#include "DDSegmentation/PolarGridRPhi.h"
+#include "TGeoMatrix.h"
 
 #include "JugBase/DataHandle.h"
+#include "JugBase/ICellGeometrySvc.h"
 #include "JugBase/IGeoSvc.h"
 
 // Event Model related classes
@@ -72,7 +80,9 @@ private:
   Gaudi::Property<std::string> m_readout{this, "readoutClass", ""};
   Gaudi::Property<std::string> m_layerField{this, "layerField", ""};
   Gaudi::Property<std::string> m_sectorField{this, "sectorField", ""};
+  Gaudi::Property<std::string> m_cellGeoSvcName{this, "cellGeoServiceName", "CellGeometrySvc"};
   SmartIF<IGeoSvc> m_geoSvc;
+  SmartIF<ICellGeometrySvc> m_cellGeoSvc;
   dd4hep::BitFieldCoder* id_dec = nullptr;
   size_t sector_idx{0}, layer_idx{0};
 
@@ -83,6 +93,23 @@ private:
   dd4hep::DetElement local;
   size_t local_mask = ~0;
 
+  // cell positions of regular grid segmentations from the segmentation itself, with the
+  // transforms of the sensitive volumes (looked up once per volume, and checked against the
+  // generic lookup for the first cell of every volume)
+  Gaudi::Property<bool> m_analyticGrid{this, "analyticGrid", true,
+                                       "Cached volume transforms for CartesianGridXY/XZ and PolarGridRPhi cells"};
+  Gaudi::Property<double> m_analyticGridTolerance{this, "analyticGridTolerance", 1. * dd4hep::um,
+                                                  "Maximum difference to the generic cell lookup"};
+  const dd4hep::DDSegmentation::Segmentation* grid_segmentation{nullptr};
+  // cellID bits of the sensitive volume (without the segmentation fields)
+  uint64_t volume_mask{0};
+  struct VolumeTransforms {
+    bool valid{false};
+    // segmentation (volume) frame to the global frame and to the frame of the local positions
+    TGeoHMatrix toGlobal, toLocal;
+  };
+  std::unordered_map<uint64_t, VolumeTransforms> m_volumes;
+
 public:
   CalorimeterHitReco(const std::string& name, ISvcLocator* svcLoc) : GaudiAlgorithm(name, svcLoc) {
     declareProperty("inputHitCollection", m_inputHitCollection, "");
@@ -100,6 +127,11 @@ public:
               << "Make sure you have GeoSvc and SimSvc in the right order in the configuration." << endmsg;
       return StatusCode::FAILURE;
     }
+    m_cellGeoSvc = service(m_cellGeoSvcName);
+    if (!m_cellGeoSvc) {
+      error() << "Unable to locate Cell Geometry Service " << m_cellGeoSvcName << endmsg;
+      return StatusCode::FAILURE;
+    }
 
     // unitless conversion
     dyRangeADC = m_dyRangeADC.value() / GeV;
@@ -155,6 +187,10 @@ public:
              << endmsg;
     }
 
+    if (m_analyticGrid.value()) {
+      init_grid(m_geoSvc->detector()->readout(m_readout).segmentation());
+    }
+
     return StatusCode::SUCCESS;
   }
 
@@ -162,8 +198,7 @@ public:
     // input collections
     const auto& rawhits = *m_inputHitCollection.get();
     // create output collections
-    auto& hits     = *m_outputHitCollection.createAndPut();
-    auto converter = m_geoSvc->cellIDPositionConverter();
+    auto& hits = *m_outputHitCollection.createAndPut();
 
     // energy time reconstruction
     for (const auto& rh : rawhits) {
@@ -186,26 +221,12 @@ public:
       const auto cellID = rh.getCellID();
       const int lid = id_dec != nullptr && !m_layerField.value().empty() ? static_cast<int>(id_dec->get(cellID, layer_idx)) : -1;
       const int sid = id_dec != nullptr && !m_sectorField.value().empty() ? static_cast<int>(id_dec->get(cellID, sector_idx)) : -1;
-      // global positions
-      const auto gpos = converter->position(cellID);
-      // local positions
-      if (m_localDetElement.value().empty()) {
-        auto volman = m_geoSvc->detector()->volumeManager();
-        local       = volman.lookupDetElement(cellID & local_mask);
-        }
-        const auto pos = local.nominal().worldToLocal(dd4hep::Position(gpos.x(), gpos.y(), gpos.z()));
-        // cell dimension
-        std::vector<double> cdim;
-        // get segmentation dimensions
-        if (converter->findReadout(local).segmentation().type() != "NoSegmentation") {
-        cdim = converter->cellDimensions(cellID);
-        // get volume dimensions (multiply by two to get fullsize)
-        } else {
-        // Using bounding box instead of actual solid so the dimensions are always in dim_x, dim_y, dim_z
-        cdim = converter->findContext(cellID)->volumePlacement().volume().boundingBox().dimensions();
-        std::transform(cdim.begin(), cdim.end(), cdim.begin(),
-                       std::bind(std::multiplies<double>(), std::placeholders::_1, 2));
-        }
+      // global and local positions, cell dimension
+      dd4hep::Position gpos, pos;
+      std::array<double, 3> cdim{};
+      if (!grid_cell(cellID, gpos, pos, cdim)) {
+        generic_cell(cellID, gpos, pos, cdim);
+      }
 
         // create const vectors for passing to hit initializer list
         const decltype(edm4eic::CalorimeterHitData::position) position(
@@ -236,6 +257,147 @@ public:
     return StatusCode::SUCCESS;
   }
 
+private:
+  // positions and dimensions of a cell from the cell geometry service
+  void generic_cell(const uint64_t cellID, dd4hep::Position& gpos, dd4hep::Position& pos,
+                    std::array<double, 3>& cdim) {
+    const auto cell = m_cellGeoSvc->cell(cellID);
+    gpos            = cell.position;
+    if (m_localDetElement.value().empty() && local_mask == ~size_t{0}) {
+      pos = cell.localPosition;
+    } else {
+      if (m_localDetElement.value().empty()) {
+        auto volman = m_geoSvc->detector()->volumeManager();
+        local       = volman.lookupDetElement(cellID & local_mask);
+      }
+      pos = local.nominal().worldToLocal(gpos);
+    }
+    cdim = cell.dimensions;
+  }
+
+  // set up the analytic positions if the readout has a regular grid segmentation
+  void init_grid(const dd4hep::Segmentation& segmentation) {
+    namespace seg = dd4hep::DDSegmentation;
+    if (!segmentation.isValid()) {
+      return;
+    }
+    const auto* base = segmentation.segmentation();
+    std::string fields[2];
+    if (const auto* xy = dynamic_cast<const seg::CartesianGridXY*>(base)) {
+      fields[0] = xy->fieldNameX();
+      fields[1] = xy->fieldNameY();
+    } else if (const auto* xz = dynamic_cast<const seg::CartesianGridXZ*>(base)) {
+      fields[0] = xz->fieldNameX();
+      fields[1] = xz->fieldNameZ();
+    } else if (const auto* rphi = dynamic_cast<const seg::PolarGridRPhi*>(base)) {
+      fields[0] = rphi->fieldNameR();
+      fields[1] = rphi->fieldNamePhi();
+    } else {
+      info() << "No analytic cell positions for segmentation " << segmentation.type() << endmsg;
+      return;
+    }
+
+    try {
+      volume_mask = ~((*id_dec)[fields[0]].mask() | (*id_dec)[fields[1]].mask());
+    } catch (...) {
+      warning() << fmt::format("Fields {}, {} of segmentation {} not in the readout, no analytic cell positions",
+                               fields[0], fields[1], segmentation.type())
+                << endmsg;
+      return;
+    }
+    // the local frame needs to be the same for all cells of a volume
+    if (m_localDetElement.value().empty() && local_mask != ~size_t{0} && (local_mask & ~volume_mask) != 0) {
+      info() << "Local DetElement fields include the segmentation, no analytic cell positions" << endmsg;
+      return;
+    }
+    grid_segmentation = base;
+    info() << "Analytic cell positions for segmentation " << segmentation.type() << endmsg;
+  }
+
+  // transforms of the volume of a cell (from one generic lookup), not valid if the cell does not
+  // belong to the segmentation of the readout
+  VolumeTransforms volume_transforms(const uint64_t cellID) const {
+    VolumeTransforms transforms;
+    const auto converter = m_geoSvc->cellIDPositionConverter();
+    const auto* context  = converter->findContext(cellID);
+    if (context == nullptr ||
+        converter->findReadout(context->element).segmentation().segmentation() != grid_segmentation) {
+      return transforms;
+    }
+    // as CellIDPositionConverter::position: volume -> DetElement -> global
+    transforms.toGlobal = context->element.nominal().worldTransformation();
+    transforms.toGlobal.Multiply(&context->toElement());
+    if (m_localDetElement.value().empty() && local_mask == ~size_t{0}) {
+      transforms.toLocal = context->toElement();
+    } else {
+      auto det = local;
+      if (m_localDetElement.value().empty()) {
+        det = m_geoSvc->detector()->volumeManager().lookupDetElement(cellID & local_mask);
+      }
+      transforms.toLocal = det.nominal().worldTransformation().Inverse();
+      transforms.toLocal.Multiply(&transforms.toGlobal);
+    }
+    transforms.valid = true;
+    return transforms;
+  }
+
+  // positions and dimensions of a cell of the grid segmentation, false for the generic lookup
+  bool grid_cell(const uint64_t cellID, dd4hep::Position& gpos, dd4hep::Position& pos,
+                 std::array<double, 3>& cdim) {
+    if (grid_segmentation == nullptr) {
+      return false;
+    }
+    const uint64_t volumeID = cellID & volume_mask;
+    auto it                 = m_volumes.find(volumeID);
+    if (it == m_volumes.end()) {
+      it = m_volumes.emplace(volumeID, volume_transforms(cellID)).first;
+      if (it->second.valid && !check_grid_cell(cellID, it->second)) {
+        it->second.valid = false;
+      }
+    }
+    if (!it->second.valid) {
+      return false;
+    }
+    grid_position(cellID, it->second, gpos, pos, cdim);
+    return true;
+  }
+
+  // segmentation position and dimensions (pure arithmetic) with the transforms of the volume
+  void grid_position(const uint64_t cellID, const VolumeTransforms& transforms, dd4hep::Position& gpos,
+                     dd4hep::Position& pos, std::array<double, 3>& cdim) const {
+    const auto p = grid_segmentation->position(cellID);
+    const double l[3]{p.X, p.Y, p.Z};
+    double g[3], lp[3];
+    transforms.toGlobal.LocalToMaster(l, g);
+    transforms.toLocal.LocalToMaster(l, lp);
+    gpos = dd4hep::Position(g[0], g[1], g[2]);
+    pos  = dd4hep::Position(lp[0], lp[1], lp[2]);
+    const auto dims = grid_segmentation->cellDimensions(cellID);
+    cdim            = {0., 0., 0.};
+    std::copy_n(dims.begin(), std::min(dims.size(), cdim.size()), cdim.begin());
+  }
+
+  // the analytic and generic positions and dimensions of a cell agree (the first cell of every
+  // volume is checked, the generic lookup is used for the volume otherwise)
+  bool check_grid_cell(const uint64_t cellID, const VolumeTransforms& transforms) {
+    dd4hep::Position gpos, pos, ggpos, glocal;
+    std::array<double, 3> cdim{}, gcdim{};
+    grid_position(cellID, transforms, gpos, pos, cdim);
+    generic_cell(cellID, ggpos, glocal, gcdim);
+    const double tol = m_analyticGridTolerance.value();
+    bool agree       = (gpos - ggpos).R() <= tol && (pos - glocal).R() <= tol;
+    for (size_t i = 0; i < cdim.size(); ++i) {
+      agree = agree && std::abs(cdim[i] - gcdim[i]) <= tol;
+    }
+    if (!agree) {
+      warning() << fmt::format("Analytic position of cell {:#018x} differs from the generic lookup by {:g} mm "
+                               "(global) and {:g} mm (local), using the generic lookup for its volume",
+                               cellID, (gpos - ggpos).R() / dd4hep::mm, (pos - glocal).R() / dd4hep::mm)
+                << endmsg;
+    }
+    return agree;
+  }
+
 }; // class CalorimeterHitReco
 
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
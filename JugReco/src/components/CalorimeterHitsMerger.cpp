@@ -29,6 +29,7 @@
 #include "fmt/ranges.h"
 
 #include "JugBase/DataHandle.h"
+#include "JugBase/ICellGeometrySvc.h"
 #include "JugBase/IGeoSvc.h"
 
 // Event Model related classes
@@ -48,6 +49,7 @@ namespace Jug::Reco {
 class CalorimeterHitsMerger : public GaudiAlgorithm {
 private:
   Gaudi::Property<std::string> m_geoSvcName{this, "geoServiceName", "GeoSvc"};
+  Gaudi::Property<std::string> m_cellGeoSvcName{this, "cellGeoServiceName", "CellGeometrySvc"};
   Gaudi::Property<std::string> m_readout{this, "readoutClass", ""};
   // field names to generate id mask, the hits will be grouped by masking the field
   Gaudi::Property<std::vector<std::string>> u_fields{this, "fields", {"layer"}};
@@ -58,6 +60,7 @@ private:
                                                                   this};
 
   SmartIF<IGeoSvc> m_geoSvc;
+  SmartIF<ICellGeometrySvc> m_cellGeoSvc;
   uint64_t id_mask{0}, ref_mask{0};
 
 public:
@@ -77,6 +80,11 @@ public:
               << "Make sure you have GeoSvc and SimSvc in the right order in the configuration." << endmsg;
       return StatusCode::FAILURE;
     }
+    m_cellGeoSvc = service(m_cellGeoSvcName);
+    if (!m_cellGeoSvc) {
+      error() << "Unable to locate Cell Geometry Service " << m_cellGeoSvcName << endmsg;
+      return StatusCode::FAILURE;
+    }
 
     if (m_readout.value().empty()) {
       error() << "readoutClass is not provided, it is needed to know the fields in readout ids" << endmsg;
@@ -131,19 +139,18 @@ public:
     });
 
     // reconstruct info for merged hits
-    // dd4hep decoders
-    auto poscon = m_geoSvc->cellIDPositionConverter();
-    auto volman = m_geoSvc->detector()->volumeManager();
-
     for (auto& [id, hits] : merge_map) {
       // reference fields id
       const uint64_t ref_id = id | ref_mask;
+      const auto ref_cell   = m_cellGeoSvc->cell(ref_id);
       // global positions
-      const auto gpos = poscon->position(ref_id);
+      const auto& gpos = ref_cell.position;
       // local positions
-      auto alignment = volman.lookupDetElement(ref_id).nominal();
-      const auto pos = alignment.worldToLocal(dd4hep::Position(gpos.x(), gpos.y(), gpos.z()));
-      debug() << volman.lookupDetElement(ref_id).path() << ", " << volman.lookupDetector(ref_id).path() << endmsg;
+      const auto& pos = ref_cell.localPosition;
+      if (msgLevel(MSG::DEBUG)) {
+        auto volman = m_geoSvc->detector()->volumeManager();
+        debug() << ref_cell.detElement.path() << ", " << volman.lookupDetector(ref_id).path() << endmsg;
+      }
       // sum energy
       float energy      = 0.;
       float energyError = 0.;
@@ -12,7 +12,12 @@
  *      https://www.jlab.org/primex/weekly_meetings/primexII/slides_2012_01_20/island_algorithm.pdf
  */
 #include <algorithm>
-#include <functional>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <memory>
+#include <numeric>
 #include <tuple>
 
 #include "fmt/format.h"
@@ -32,27 +37,15 @@
 #include "JugBase/DataHandle.h"
 #include "JugBase/IGeoSvc.h"
 
+#include <algorithms/calorimetry/CalorimeterHitArrays.h>
+#include <algorithms/calorimetry/CalorimeterHitGroups.h>
+#include <algorithms/thread_pool.h>
+
 // Event Model related classes
 #include "edm4eic/CalorimeterHitCollection.h"
 #include "edm4eic/ClusterCollection.h"
 #include "edm4eic/ProtoClusterCollection.h"
 #include "edm4eic/vector_utils.h"
-#include "edm4hep/Vector3f.h"
-#include "edm4hep/Vector2f.h"
-
-#if defined __has_include
-#  if __has_include ("edm4eic/Vector3f.h")
-#    include "edm4eic/Vector3f.h"
-#  endif
-#  if __has_include ("edm4eic/Vector2f.h")
-#    include "edm4eic/Vector2f.h"
-#  endif
-#endif
-
-namespace edm4eic {
-  class Vector2f;
-  class Vector3f;
-}
 
 using namespace Gaudi::Units;
 
@@ -60,62 +53,18 @@ namespace {
 
 using CaloHit = edm4eic::CalorimeterHit;
 using CaloHitCollection = edm4eic::CalorimeterHitCollection;
-
-using Vector2f = std::conditional_t<
-  std::is_same_v<decltype(edm4eic::CalorimeterHitData::position), edm4hep::Vector3f>,
-  edm4hep::Vector2f,
-  edm4eic::Vector2f
->;
-
-// helper functions to get distance between hits
-static Vector2f localDistXY(const CaloHit& h1, const CaloHit& h2) {
-  const auto delta = h1.getLocal() - h2.getLocal();
-  return {delta.x, delta.y};
-}
-static Vector2f localDistXZ(const CaloHit& h1, const CaloHit& h2) {
-  const auto delta = h1.getLocal() - h2.getLocal();
-  return {delta.x, delta.z};
-}
-static Vector2f localDistYZ(const CaloHit& h1, const CaloHit& h2) {
-  const auto delta = h1.getLocal() - h2.getLocal();
-  return {delta.y, delta.z};
-}
-static Vector2f dimScaledLocalDistXY(const CaloHit& h1, const CaloHit& h2) {
-  const auto delta = h1.getLocal() - h2.getLocal();
-  const auto dimsum = h1.getDimension() + h2.getDimension();
-  return {2 * delta.x / dimsum.x, 2 * delta.y / dimsum.y};
-}
-static Vector2f globalDistRPhi(const CaloHit& h1, const CaloHit& h2) {
-  using vector_type = decltype(Vector2f::a);
-  return {
-    static_cast<vector_type>(
-      edm4eic::magnitude(h1.getPosition()) - edm4eic::magnitude(h2.getPosition())
-    ),
-    static_cast<vector_type>(
-      edm4eic::angleAzimuthal(h1.getPosition()) - edm4eic::angleAzimuthal(h2.getPosition())
-    )
-  };
-}
-static Vector2f globalDistEtaPhi(const CaloHit& h1,
-                                       const CaloHit& h2) {
-  using vector_type = decltype(Vector2f::a);
-  return {
-    static_cast<vector_type>(
-      edm4eic::eta(h1.getPosition()) - edm4eic::eta(h2.getPosition())
-    ),
-    static_cast<vector_type>(
-      edm4eic::angleAzimuthal(h1.getPosition()) - edm4eic::angleAzimuthal(h2.getPosition())
-    )
-  };
-}
-// name: {method, units}
-static std::map<std::string,
-                std::tuple<std::function<Vector2f(const CaloHit&, const CaloHit&)>, std::vector<double>>>
-    distMethods{
-        {"localDistXY", {localDistXY, {mm, mm}}},        {"localDistXZ", {localDistXZ, {mm, mm}}},
-        {"localDistYZ", {localDistYZ, {mm, mm}}},        {"dimScaledLocalDistXY", {dimScaledLocalDistXY, {1., 1.}}},
-        {"globalDistRPhi", {globalDistRPhi, {mm, rad}}}, {"globalDistEtaPhi", {globalDistEtaPhi, {1., rad}}},
-    };
+using algorithms::calorimetry::CalorimeterHitArrays;
+using algorithms::calorimetry::HitCoordinates;
+// name: {coordinates, units}
+static std::map<std::string, std::tuple<HitCoordinates, std::vector<double>>> distMethods{
+    {"localDistXY", {{&CalorimeterHitArrays::localX, &CalorimeterHitArrays::localY}, {mm, mm}}},
+    {"localDistXZ", {{&CalorimeterHitArrays::localX, &CalorimeterHitArrays::localZ}, {mm, mm}}},
+    {"localDistYZ", {{&CalorimeterHitArrays::localY, &CalorimeterHitArrays::localZ}, {mm, mm}}},
+    // differences scaled by the mean dimension of the two hits
+    {"dimScaledLocalDistXY", {{&CalorimeterHitArrays::localX, &CalorimeterHitArrays::localY}, {1., 1.}}},
+    {"globalDistRPhi", {{&CalorimeterHitArrays::r, &CalorimeterHitArrays::phi}, {mm, rad}}},
+    {"globalDistEtaPhi", {{&CalorimeterHitArrays::eta, &CalorimeterHitArrays::phi}, {1., rad}}},
+};
 
 } // namespace
 namespace Jug::Reco {
@@ -149,12 +98,17 @@ private:
   Gaudi::Property<std::vector<double>> u_globalDistRPhi{this, "globalDistRPhi", {}};
   Gaudi::Property<std::vector<double>> u_globalDistEtaPhi{this, "globalDistEtaPhi", {}};
   Gaudi::Property<std::vector<double>> u_dimScaledLocalDistXY{this, "dimScaledLocalDistXY", {1.8, 1.8}};
-  // neighbor checking function
-  std::function<Vector2f(const CaloHit&, const CaloHit&)> hitsDist;
-
-  // unitless counterparts of the input parameters
-  double minClusterHitEdep{0}, minClusterCenterEdep{0}, sectorDist{0};
-  std::array<double, 2> neighbourDist = {0., 0.};
+  // the groups are independent, they can be split in parallel
+  Gaudi::Property<int> m_splitThreads{this, "splitThreads", 1,
+                                      "Threads to split the groups on (0: hardware threads, 1: no thread pool)"};
+  // unitless counterparts of the input parameters, the neighbour distances with the coordinates
+  // of the staged hits they apply to
+  double minClusterCenterEdep{0};
+  algorithms::calorimetry::NeighbourConfig m_neighbours;
+
+  // hits of the event, staged for the neighbour checks (keeps the capacity between events)
+  CalorimeterHitArrays m_staged;
+  std::unique_ptr<algorithms::ThreadPool> m_pool;
 
 public:
   CalorimeterIslandCluster(const std::string& name, ISvcLocator* svcLoc) : GaudiAlgorithm(name, svcLoc) {
@@ -168,16 +122,16 @@ public:
     }
 
     // unitless conversion, keep consistency with juggler internal units (GeV, mm, ns, rad)
-    minClusterHitEdep    = m_minClusterHitEdep.value() / GeV;
-    minClusterCenterEdep = m_minClusterCenterEdep.value() / GeV;
-    sectorDist           = m_sectorDist.value() / mm;
+    m_neighbours.minHitEdep = m_minClusterHitEdep.value() / GeV;
+    minClusterCenterEdep    = m_minClusterCenterEdep.value() / GeV;
+    m_neighbours.sectorDist = m_sectorDist.value() / mm;
 
     // set coordinate system
     auto set_dist_method = [this](const Gaudi::Property<std::vector<double>>& uprop) {
       if (uprop.size() == 0) {
         return false;
       }
-      auto& [method, units] = distMethods[uprop.name()];
+      auto& [coord, units] = distMethods[uprop.name()];
       if (uprop.size() != units.size()) {
         info() << units.size() << endmsg;
         warning() << fmt::format("Expect {} values from {}, received {}: ({}), ignored it.", units.size(), uprop.name(),
@@ -186,10 +140,12 @@ public:
         return false;
       } else {
         for (size_t i = 0; i < units.size(); ++i) {
-          neighbourDist[i] = uprop.value()[i] / units[i];
+          m_neighbours.dist[i] = uprop.value()[i] / units[i];
         }
-        hitsDist = method;
-        info() << fmt::format("Clustering uses {} with distances <= [{}]", uprop.name(), fmt::join(neighbourDist, ","))
+        m_neighbours.coordinates = coord;
+        m_neighbours.dimScaled   = (uprop.name() == "dimScaledLocalDistXY");
+        info() << fmt::format("Clustering uses {} with distances <= [{}]", uprop.name(),
+                              fmt::join(m_neighbours.dist, ","))
                << endmsg;
       }
       return true;
@@ -217,21 +173,31 @@ public:
       return StatusCode::FAILURE;
     }
 
+    if (m_splitThreads.value() < 0) {
+      error() << "splitThreads cannot be negative" << endmsg;
+      return StatusCode::FAILURE;
+    }
+    if (m_splitThreads.value() != 1) {
+      m_pool = std::make_unique<algorithms::ThreadPool>(m_splitThreads.value());
+      info() << "Splitting the groups on " << m_pool->size() << " threads" << endmsg;
+    }
+
     return StatusCode::SUCCESS;
   }
 
+  StatusCode finalize() override {
+    m_pool.reset();
+    return GaudiAlgorithm::finalize();
+  }
+
   StatusCode execute() override {
     // input collections
     const auto& hits = *(m_inputHitCollection.get());
     // Create output collections
     auto& proto = *(m_outputProtoCollection.createAndPut());
 
-    // group neighboring hits
-    std::vector<std::vector<std::pair<uint32_t, CaloHit>>> groups;
-
-    std::vector<bool> visits(hits.size(), false);
-    for (size_t i = 0; i < hits.size(); ++i) {
-      if (msgLevel(MSG::DEBUG)) {
+    if (msgLevel(MSG::DEBUG)) {
+      for (size_t i = 0; i < hits.size(); ++i) {
         const auto& hit = hits[i];
         debug() << fmt::format("hit {:d}: energy = {:.4f} MeV, local = ({:.4f}, {:.4f}) mm, "
                                "global=({:.4f}, {:.4f}, {:.4f}) mm",
@@ -239,24 +205,56 @@ public:
                                hit.getPosition().y, hit.getPosition().z)
                 << endmsg;
       }
-      // already in a group
-      if (visits[i]) {
-        continue;
+    }
+
+    // group neighboring hits
+    m_staged.stage(hits);
+    std::vector<algorithms::calorimetry::HitEdge> edges;
+    const auto groups = group_hits(hits, m_staged, edges);
+
+    // a hit with a more energetic neighbour is not a local maximum
+    std::vector<uint8_t> dominated(hits.size(), 0);
+    for (const auto& [i, j] : edges) {
+      if (m_staged.energy[j] > m_staged.energy[i]) {
+        dominated[i] = 1;
+      } else if (m_staged.energy[i] > m_staged.energy[j]) {
+        dominated[j] = 1;
       }
-      groups.emplace_back();
-      // create a new group, and group all the neighboring hits
-      dfs_group(groups.back(), i, hits, visits);
     }
 
-    for (auto& group : groups) {
-      if (group.empty()) {
-        continue;
+    // the groups are split independently (on the thread pool, if any), and the clusters are
+    // added in the order of the groups
+    std::vector<std::vector<uint32_t>> maxima(groups.size());
+    std::vector<std::vector<edm4eic::MutableProtoCluster>> clusters(groups.size());
+    const auto split = [&](const size_t g) {
+      maxima[g]   = find_maxima(groups[g], m_staged, dominated, !m_splitCluster.value());
+      clusters[g] = split_group(groups[g], maxima[g], m_staged);
+    };
+    if (m_pool && groups.size() > 1) {
+      m_pool->run(groups.size(), split);
+    } else {
+      for (size_t g = 0; g < groups.size(); ++g) {
+        split(g);
+      }
+    }
+
+    for (size_t g = 0; g < groups.size(); ++g) {
+      for (const auto& pcl : clusters[g]) {
+        proto.push_back(pcl);
+      }
+      if (msgLevel(MSG::VERBOSE)) {
+        if (maxima[g].empty()) {
+          verbose() << "No maxima found, not building any clusters" << endmsg;
+        } else if (maxima[g].size() == 1) {
+          verbose() << "A single maximum found, added one ProtoCluster" << endmsg;
+        } else {
+          verbose() << "Multiple (" << maxima[g].size() << ") maxima found, added a ProtoClusters for each maximum"
+                    << endmsg;
+        }
       }
-      auto maxima = find_maxima(group, !m_splitCluster.value());
-      split_group(group, maxima, proto);
       if (msgLevel(MSG::DEBUG)) {
-        debug() << "hits in a group: " << group.size() << ", "
-                << "local maxima: " << maxima.size() << endmsg;
+        debug() << "hits in a group: " << groups[g].size() << ", "
+                << "local maxima: " << maxima[g].size() << endmsg;
       }
     }
 
@@ -264,80 +262,52 @@ public:
   }
 
 private:
-  // helper function to group hits
-  inline bool is_neighbour(const CaloHit& h1, const CaloHit& h2) const {
-    // in the same sector
-    if (h1.getSector() == h2.getSector()) {
-      auto dist = hitsDist(h1, h2);
-      return (dist.a <= neighbourDist[0]) && (dist.b <= neighbourDist[1]);
-      // different sector, local coordinates do not work, using global coordinates
-    } else {
-      // sector may have rotation (barrel), so z is included
-      return (edm4eic::magnitude(h1.getPosition() - h2.getPosition()) <= sectorDist);
-    }
-  }
-
-  // grouping function with Depth-First Search
-  void dfs_group(std::vector<std::pair<uint32_t, CaloHit>>& group, int idx,
-                 const CaloHitCollection& hits, std::vector<bool>& visits) const {
-    // not a qualified hit to particpate clustering, stop here
-    if (hits[idx].getEnergy() < minClusterHitEdep) {
-      visits[idx] = true;
-      return;
-    }
-
-    group.emplace_back(idx, hits[idx]);
-    visits[idx] = true;
-    for (size_t i = 0; i < hits.size(); ++i) {
-      if (visits[i] || !is_neighbour(hits[idx], hits[i])) {
-        continue;
+  // group the neighbouring hits, see algorithms::calorimetry::groupHits (the groups are ordered
+  // by their first hit), every pair of neighbours is added to edges for the local maxima
+  std::vector<std::vector<std::pair<uint32_t, CaloHit>>>
+  group_hits(const CaloHitCollection& hits, const CalorimeterHitArrays& staged,
+             std::vector<algorithms::calorimetry::HitEdge>& edges) const {
+    const auto indices = algorithms::calorimetry::groupHits(staged, m_neighbours, edges);
+    std::vector<std::vector<std::pair<uint32_t, CaloHit>>> groups(indices.size());
+    for (size_t g = 0; g < indices.size(); ++g) {
+      groups[g].reserve(indices[g].size());
+      for (const auto i : indices[g]) {
+        groups[g].emplace_back(i, hits[i]);
       }
-      dfs_group(group, i, hits, visits);
     }
+    return groups;
   }
 
-  // find local maxima that above a certain threshold
-  std::vector<CaloHit>
-  find_maxima(const std::vector<std::pair<uint32_t, CaloHit>>& group,
-              bool global = false) const {
-    std::vector<CaloHit> maxima;
+  // find local maxima that above a certain threshold (the indices of the staged hits), the hits
+  // that have no more energetic neighbour
+  std::vector<uint32_t> find_maxima(const std::vector<std::pair<uint32_t, CaloHit>>& group,
+                                    const CalorimeterHitArrays& staged, const std::vector<uint8_t>& dominated,
+                                    bool global = false) const {
+    std::vector<uint32_t> maxima;
     if (group.empty()) {
       return maxima;
     }
 
     if (global) {
-      int mpos = 0;
-      for (size_t i = 0; i < group.size(); ++i) {
-        if (group[mpos].second.getEnergy() < group[i].second.getEnergy()) {
-          mpos = i;
+      uint32_t mpos = group.front().first;
+      for (const auto& [idx, hit] : group) {
+        if (staged.energy[mpos] < staged.energy[idx]) {
+          mpos = idx;
         }
       }
-      if (group[mpos].second.getEnergy() >= minClusterCenterEdep) {
-        maxima.push_back(group[mpos].second);
+      if (staged.energy[mpos] >= minClusterCenterEdep) {
+        maxima.push_back(mpos);
       }
       return maxima;
     }
 
     for (const auto& [idx, hit] : group) {
       // not a qualified center
-      if (hit.getEnergy() < minClusterCenterEdep) {
+      if (staged.energy[idx] < minClusterCenterEdep) {
         continue;
       }
-
-      bool maximum = true;
-      for (const auto& [idx2, hit2] : group) {
-        if (hit == hit2) {
-          continue;
-        }
-
-        if (is_neighbour(hit, hit2) && hit2.getEnergy() > hit.getEnergy()) {
-          maximum = false;
-          break;
-        }
-      }
-
-      if (maximum) {
-        maxima.push_back(hit);
+      if (dominated[idx] == 0) {
+        maxima.push_back(idx);
       }
     }
 
@@ -355,54 +325,68 @@ private:
     }
   }
 
-  // split a group of hits according to the local maxima
-  void split_group(std::vector<std::pair<uint32_t, CaloHit>>& group, const std::vector<CaloHit>& maxima,
-                   edm4eic::ProtoClusterCollection& proto) const {
+  // split a group of hits according to the local maxima (indices of the staged hits), the weights
+  // of the hits for all maxima are computed with the kernels over the staged group
+  std::vector<edm4eic::MutableProtoCluster> split_group(const std::vector<std::pair<uint32_t, CaloHit>>& group,
+                                                        const std::vector<uint32_t>& maxima,
+                                                        const CalorimeterHitArrays& staged) const {
+    namespace calo = algorithms::calorimetry;
     // special cases
     if (maxima.empty()) {
-      if (msgLevel(MSG::VERBOSE)) {
-        verbose() << "No maxima found, not building any clusters" << endmsg;
-      }
-      return;
+      return {};
     } else if (maxima.size() == 1) {
       edm4eic::MutableProtoCluster pcl;
-      for (auto& [idx, hit] : group) {
+      for (const auto& [idx, hit] : group) {
         pcl.addToHits(hit);
         pcl.addToWeights(1.);
       }
-      proto.push_back(pcl);
-      if (msgLevel(MSG::VERBOSE)) {
-        verbose() << "A single maximum found, added one ProtoCluster" << endmsg;
+      return {pcl};
+    }
+
+    // coordinates of the group
+    const size_t n = group.size();
+    std::vector<uint32_t> order(n);
+    std::transform(group.begin(), group.end(), order.begin(), [](const auto& h) { return h.first; });
+    const auto& [coordA, coordB] = m_neighbours.coordinates;
+    std::vector<float> ga, gb, gdimA, gdimB;
+    calo::gather(staged.*coordA, order, ga);
+    calo::gather(staged.*coordB, order, gb);
+    if (m_neighbours.dimScaled) {
+      calo::gather(staged.dimX, order, gdimA);
+      calo::gather(staged.dimY, order, gdimB);
+    }
+
+    // weights of the hits for the local maxima, weight of hit i for maximum k at k * n + i. They
+    // are computed from the log weights relative to the largest weight of each hit, as far from
+    // all maxima the exponentials of all of them underflow (a distance of ~90 ref in float)
+    std::vector<float> maxWeights(maxima.size() * n);
+    for (size_t k = 0; k < maxima.size(); ++k) {
+      const auto c      = maxima[k];
+      const float a0    = (staged.*coordA)[c];
+      const float b0    = (staged.*coordB)[c];
+      const float logE0 = std::log(std::max(staged.energy[c], std::numeric_limits<float>::min()));
+      if (m_neighbours.dimScaled) {
+        calo::scaledSplitLogWeights(ga.data(), gb.data(), gdimA.data(), gdimB.data(), n, a0, b0, staged.dimX[c],
+                                    staged.dimY[c], staged.dimX[c], logE0, &maxWeights[k * n]);
+      } else {
+        calo::splitLogWeights(ga.data(), gb.data(), n, a0, b0, staged.dimX[c], logE0, &maxWeights[k * n]);
       }
-      return;
     }
+    calo::normalizeSplitWeights(maxWeights.data(), n, maxima.size());
 
     // split between maxima
     // TODO, here we can implement iterations with profile, or even ML for better splits
     std::vector<double> weights(maxima.size(), 1.);
-    std::vector<edm4eic::MutableProtoCluster> pcls;
-    for (size_t k = 0; k < maxima.size(); ++k) {
-      pcls.emplace_back();
-    }
-
-    size_t i = 0;
-    for (const auto& [idx, hit] : group) {
-      size_t j = 0;
-      // calculate weights for local maxima
-      for (const auto& chit : maxima) {
-        double dist_ref = chit.getDimension().x;
-        double energy   = chit.getEnergy();
-        double dist     = edm4eic::magnitude(hitsDist(chit, hit));
-        weights[j]      = std::exp(-dist / dist_ref) * energy;
-        j += 1;
+    std::vector<edm4eic::MutableProtoCluster> pcls(maxima.size());
+    for (size_t i = 0; i < n; ++i) {
+      for (size_t k = 0; k < maxima.size(); ++k) {
+        weights[k] = maxWeights[k * n + i];
       }
 
-      // normalize weights
-      vec_normalize(weights);
-
-      // ignore small weights
+      // ignore small weights, but keep the largest one, so the total cannot be 0
+      const double maxWeight = *std::max_element(weights.begin(), weights.end());
       for (auto& w : weights) {
-        if (w < 0.02) {
+        if (w < 0.02 && w < maxWeight) {
           w = 0;
         }
       }
@@ -414,17 +398,11 @@ private:
         if (weight <= 1e-6) {
           continue;
         }
-        pcls[k].addToHits(hit);
+        pcls[k].addToHits(group[i].second);
         pcls[k].addToWeights(weight);
       }
-      i += 1;
-    }
-    for (auto& pcl : pcls) {
-      proto.push_back(pcl);
-    }
-    if (msgLevel(MSG::VERBOSE)) {
-      verbose() << "Multiple (" << maxima.size() << ") maxima found, added a ProtoClusters for each maximum" << endmsg;
     }
+    return pcls;
   }
 };
 
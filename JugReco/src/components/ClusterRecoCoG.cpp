@@ -9,7 +9,13 @@
  */
 
 #include <JugAlgo/Algorithm.h>
+#include <JugAlgo/ReentrantAlgorithm.h>
 #include <algorithms/calorimetry/ClusterRecoCoG.h>
 
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
 JUGALGO_DEFINE_ALGORITHM(ClusterRecoCoG, algorithms::calorimetry::ClusterRecoCoG, Jug::Reco)
+
+// Same algorithm for multi-threaded (Gaudi Hive) jobs
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+JUGALGO_DEFINE_REENTRANT_ALGORITHM(ReentrantClusterRecoCoG,
+                                   algorithms::calorimetry::ClusterRecoCoG, Jug::Reco)
@@ -29,6 +29,9 @@
 #include "JugBase/IGeoSvc.h"
 #include "JugReco/ClusterTypes.h"
 
+#include <algorithms/calorimetry/CalorimeterHitArrays.h>
+#include <algorithms/calorimetry/ImagingHitGroups.h>
+
 // Event Model related classes
 #include "edm4eic/CalorimeterHitCollection.h"
 #include "edm4eic/ProtoClusterCollection.h"
@@ -78,6 +81,11 @@ private:
   double localDistXY[2]{0,0}, layerDistEtaPhi[2]{0,0}, sectorDist{0};
   double minClusterHitEdep{0}, minClusterCenterEdep{0}, minClusterEdep{0}, minClusterNhits{0};
 
+  // the neighbour checks and thresholds of the grouping
+  algorithms::calorimetry::ImagingNeighbourConfig m_neighbourConfig;
+  // hits of the event, staged for the neighbour checks (keep their capacity between events)
+  algorithms::calorimetry::CalorimeterHitArrays m_staged;
+
 public:
   ImagingTopoCluster(const std::string& name, ISvcLocator* svcLoc) : GaudiAlgorithm(name, svcLoc) {
     declareProperty("inputHitCollection", m_inputHitCollection, "");
@@ -110,6 +118,13 @@ public:
     minClusterCenterEdep = m_minClusterCenterEdep.value() / GeV;
     minClusterEdep       = m_minClusterEdep.value() / GeV;
 
+    m_neighbourConfig.neighbourLayersRange = m_neighbourLayersRange.value();
+    m_neighbourConfig.localDistXY          = {localDistXY[0], localDistXY[1]};
+    m_neighbourConfig.layerDistEtaPhi      = {layerDistEtaPhi[0], layerDistEtaPhi[1]};
+    m_neighbourConfig.sectorDist           = sectorDist;
+    m_neighbourConfig.minHitEdep           = minClusterHitEdep;
+    m_neighbourConfig.minCenterEdep        = minClusterCenterEdep;
+
     // summarize the clustering parameters
     info() << fmt::format("Local clustering (same sector and same layer): "
                           "Local [x, y] distance between hits <= [{:.4f} mm, {:.4f} mm].",
@@ -134,23 +149,16 @@ public:
     auto& proto = *m_outputProtoClusterCollection.createAndPut();
 
     // group neighboring hits
-    std::vector<bool> visits(hits.size(), false);
-    std::vector<std::vector<std::pair<uint32_t, edm4eic::CalorimeterHit>>> groups;
-    for (size_t i = 0; i < hits.size(); ++i) {
-      if (msgLevel(MSG::DEBUG)) {
+    m_staged.stage(hits);
+    if (msgLevel(MSG::DEBUG)) {
+      for (size_t i = 0; i < hits.size(); ++i) {
         debug() << fmt::format("hit {:d}: local position = ({}, {}, {}), global position = ({}, {}, {})", i + 1,
                                hits[i].getLocal().x, hits[i].getLocal().y, hits[i].getPosition().z,
                                hits[i].getPosition().x, hits[i].getPosition().y, hits[i].getPosition().z)
                 << endmsg;
       }
-      // already in a group, or not energetic enough to form a cluster
-      if (visits[i] || hits[i].getEnergy() < minClusterCenterEdep) {
-        continue;
-      }
-      groups.emplace_back();
-      // create a new group, and group all the neighboring hits
-      dfs_group(groups.back(), i, hits, visits);
     }
+    const auto groups = algorithms::calorimetry::groupImagingHits(m_staged, m_neighbourConfig);
     if (msgLevel(MSG::DEBUG)) {
       debug() << "found " << groups.size() << " potential clusters (groups of hits)" << endmsg;
       for (size_t i = 0; i < groups.size(); ++i) {
@@ -164,68 +172,21 @@ public:
         continue;
       }
       double energy = 0.;
-      for (const auto& [idx, hit] : group) {
-        energy += hit.getEnergy();
+      for (const auto idx : group) {
+        energy += hits[idx].getEnergy();
       }
       if (energy < minClusterEdep) {
         continue;
       }
       auto pcl = proto.create();
-      for (const auto& [idx, hit] : group) {
-        pcl.addToHits(hit);
+      for (const auto idx : group) {
+        pcl.addToHits(hits[idx]);
         pcl.addToWeights(1);
       }
     }
 
     return StatusCode::SUCCESS;
   }
-
-private:
-  template <typename T> static inline T pow2(const T& x) { return x * x; }
-
-  // helper function to group hits
-  bool is_neighbor(const edm4eic::CalorimeterHit& h1, const edm4eic::CalorimeterHit& h2) const {
-    // different sectors, simple distance check
-    if (h1.getSector() != h2.getSector()) {
-      return std::sqrt(pow2(h1.getPosition().x - h2.getPosition().x) + pow2(h1.getPosition().y - h2.getPosition().y) +
-                       pow2(h1.getPosition().z - h2.getPosition().z)) <= sectorDist;
-    }
-
-    // layer check
-    int ldiff = std::abs(h1.getLayer() - h2.getLayer());
-    // same layer, check local positions
-    if (ldiff == 0) {
-      return (std::abs(h1.getLocal().x - h2.getLocal().x) <= localDistXY[0]) &&
-             (std::abs(h1.getLocal().y - h2.getLocal().y) <= localDistXY[1]);
-    } else if (ldiff <= m_neighbourLayersRange) {
-      return (std::abs(edm4eic::eta(h1.getPosition()) - edm4eic::eta(h2.getPosition())) <= layerDistEtaPhi[0]) &&
-             (std::abs(edm4eic::angleAzimuthal(h1.getPosition()) - edm4eic::angleAzimuthal(h2.getPosition())) <=
-              layerDistEtaPhi[1]);
-    }
-
-    // not in adjacent layers
-    return false;
-  }
-
-  // grouping function with Depth-First Search
-  void dfs_group(std::vector<std::pair<uint32_t, edm4eic::CalorimeterHit>>& group, int idx,
-                 const edm4eic::CalorimeterHitCollection& hits, std::vector<bool>& visits) const {
-    // not a qualified hit to participate in clustering, stop here
-    if (hits[idx].getEnergy() < minClusterHitEdep) {
-      visits[idx] = true;
-      return;
-    }
-
-    group.emplace_back(idx, hits[idx]);
-    visits[idx] = true;
-    for (size_t i = 0; i < hits.size(); ++i) {
-      // visited, or not a neighbor
-      if (visits[i] || !is_neighbor(hits[idx], hits[i])) {
-        continue;
-      }
-      dfs_group(group, i, hits, visits);
-    }
-  }
 }; // namespace Jug::Reco
 
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
@@ -25,7 +25,7 @@
 #include "DDRec/SurfaceManager.h"
 
 #include "JugBase/DataHandle.h"
-#include "JugBase/IGeoSvc.h"
+#include "JugBase/ICellGeometrySvc.h"
 
 // Event Model related classes
 #include "edm4eic/PMTHitCollection.h"
@@ -50,8 +50,9 @@ private:
   Gaudi::Property<double> m_minNpe{this, "minNpe", 0.0};
   Gaudi::Property<double> m_speMean{this, "speMean", 80.0};
   Gaudi::Property<double> m_pedMean{this, "pedMean", 200.0};
-  /// Pointer to the geometry service
-  SmartIF<IGeoSvc> m_geoSvc;
+  Gaudi::Property<std::string> m_cellGeoSvcName{this, "cellGeoServiceName", "CellGeometrySvc"};
+  /// Pointer to the cell geometry cache
+  SmartIF<ICellGeometrySvc> m_cellGeoSvc;
 
 public:
   // ill-formed: using GaudiAlgorithm::GaudiAlgorithm;
@@ -64,10 +65,9 @@ public:
     if (GaudiAlgorithm::initialize().isFailure()) {
       return StatusCode::FAILURE;
     }
-    m_geoSvc = service("GeoSvc");
-    if (!m_geoSvc) {
-      error() << "Unable to locate Geometry Service. "
-              << "Make sure you have GeoSvc and SimSvc in the right order in the configuration." << endmsg;
+    m_cellGeoSvc = service(m_cellGeoSvcName);
+    if (!m_cellGeoSvc) {
+      error() << "Unable to locate Cell Geometry Service " << m_cellGeoSvcName << endmsg;
       return StatusCode::FAILURE;
     }
     return StatusCode::SUCCESS;
@@ -85,12 +85,13 @@ public:
       if (npe >= m_minNpe) {
         float time = rh.getTimeStamp() * (static_cast<float>(m_timeStep) / ns);
         auto id    = rh.getCellID();
+        const auto cell = m_cellGeoSvc->cell(id);
         // global positions
-        auto gpos = m_geoSvc->cellIDPositionConverter()->position(id);
+        const auto& gpos = cell.position;
         // local positions
-        auto pos = m_geoSvc->cellIDPositionConverter()->findContext(id)->volumePlacement().position();
+        const auto& pos = cell.placementPosition;
         // cell dimension
-        auto dim = m_geoSvc->cellIDPositionConverter()->cellDimensions(id);
+        const auto& dim = cell.dimensions;
         hits.push_back(edm4eic::PMTHit{
             rh.getCellID(),
             npe,
@@ -26,6 +26,8 @@
 #include "edm4eic/RawCalorimeterHitCollection.h"
 #include "edm4eic/vector_utils.h"
 
+#include <algorithms/calorimetry/CalorimeterHitArrays.h>
+
 using namespace Gaudi::Units;
 
 namespace Jug::Reco {
@@ -55,6 +57,11 @@ namespace Jug::Reco {
     // Optional handle to MC hits
     std::unique_ptr<DataHandle<edm4hep::SimCalorimeterHitCollection>> m_inputMC;
 
+    // hits of the event, staged for the distance kernel, and the squared distances to the
+    // reference hit (keep their capacity between events)
+    algorithms::calorimetry::CalorimeterHitArrays m_staged;
+    std::vector<float> m_dist2;
+
   public:
     SimpleClustering(const std::string& name, ISvcLocator* svcLoc) 
       : GaudiAlgorithm(name, svcLoc) {
@@ -104,13 +111,16 @@ namespace Jug::Reco {
       double min_energy = m_minModuleEdep.value() / GeV;
 
       edm4eic::CalorimeterHit ref_hit;
-      bool have_ref = false;
+      uint32_t ref_idx = 0;
+      bool have_ref    = false;
       // Collect all our hits, and get the highest energy hit
+      m_staged.stage(hits);
       {
         uint32_t idx  = 0;
         for (const auto& h : hits) {
           if (!have_ref || h.getEnergy() > ref_hit.getEnergy()) {
             ref_hit  = h;
+            ref_idx  = idx;
             have_ref = true;
           }
           the_hits.emplace_back(idx, h);
@@ -126,8 +136,13 @@ namespace Jug::Reco {
 
         std::vector<std::pair<uint32_t, edm4eic::CalorimeterHit>> cluster_hits;
 
+        // squared distances of all hits to the reference hit
+        m_dist2.resize(m_staged.size());
+        algorithms::calorimetry::distance2(m_staged.x.data(), m_staged.y.data(), m_staged.z.data(), m_staged.size(),
+                                           m_staged.x[ref_idx], m_staged.y[ref_idx], m_staged.z[ref_idx],
+                                           m_dist2.data());
         for (const auto& [idx, h] : the_hits) {
-          if (edm4eic::magnitude(h.getPosition() - ref_hit.getPosition()) < max_dist) {
+          if (m_dist2[idx] < max_dist * max_dist) {
             cluster_hits.emplace_back(idx, h);
           } else {
             remaining_hits.emplace_back(idx, h);
@@ -163,6 +178,7 @@ namespace Jug::Reco {
           for (const auto& [idx, h] : remaining_hits) {
             if (!have_ref || h.getEnergy() > ref_hit.getEnergy()) {
               ref_hit  = h;
+              ref_idx  = idx;
               have_ref = true;
             }
           }
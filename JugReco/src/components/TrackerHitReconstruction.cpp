@@ -17,6 +17,7 @@
 #include "DDRec/SurfaceManager.h"
 
 #include "JugBase/DataHandle.h"
+#include "JugBase/ICellGeometrySvc.h"
 #include "JugBase/IGeoSvc.h"
 
 // Event Model related classes
@@ -46,6 +47,7 @@ namespace Jug::Reco {
   class TrackerHitReconstruction : public GaudiAlgorithm {
   private:
     Gaudi::Property<float> m_timeResolution{this, "timeResolution", 10}; // in ns
+    Gaudi::Property<std::string> m_cellGeoSvcName{this, "cellGeoServiceName", "CellGeometrySvc"};
     DataHandle<edm4eic::RawTrackerHitCollection> m_inputHitCollection{"inputHitCollection", Gaudi::DataHandle::Reader,
                                                                    this};
     DataHandle<edm4eic::TrackerHitCollection> m_outputHitCollection{"outputHitCollection", Gaudi::DataHandle::Writer,
@@ -53,6 +55,8 @@ namespace Jug::Reco {
 
     /// Pointer to the geometry service
     SmartIF<IGeoSvc> m_geoSvc;
+    /// Pointer to the cell geometry cache
+    SmartIF<ICellGeometrySvc> m_cellGeoSvc;
 
   public:
     //  ill-formed: using GaudiAlgorithm::GaudiAlgorithm;
@@ -71,6 +75,11 @@ namespace Jug::Reco {
                 << "Make sure you have GeoSvc and SimSvc in the right order in the configuration." << endmsg;
         return StatusCode::FAILURE;
       }
+      m_cellGeoSvc = service(m_cellGeoSvcName);
+      if (!m_cellGeoSvc) {
+        error() << "Unable to locate Cell Geometry Service " << m_cellGeoSvcName << endmsg;
+        return StatusCode::FAILURE;
+      }
       return StatusCode::SUCCESS;
     }
 
@@ -84,16 +93,17 @@ namespace Jug::Reco {
       debug() << " raw hits size : " << std::size(*rawhits) << endmsg;
       for (const auto& ahit : *rawhits) {
         // debug() << "cell ID : " << ahit.cellID() << endmsg;
-        auto pos = m_geoSvc->cellIDPositionConverter()->position(ahit.getCellID());
-        auto dim = m_geoSvc->cellIDPositionConverter()->cellDimensions(ahit.getCellID());
+        const auto cell = m_cellGeoSvc->cell(ahit.getCellID());
+        const auto& pos = cell.position;
+        const auto& dim = cell.dimensions;
 
         if (msgLevel(MSG::VERBOSE)) {
           size_t i = 0;
           for (const auto& p : {pos.x(), pos.y(), pos.z()}) {
             verbose() << "position " << i++ << " [mm]: " << p / mm << endmsg;
           }
-          verbose() << "dimension size: " << std::size(dim) << endmsg;
-          for (size_t j = 0; j < std::size(dim); ++j) {
+          verbose() << "dimension size: " << cell.nDimensions << endmsg;
+          for (size_t j = 0; j < cell.nDimensions; ++j) {
             verbose() << " - dimension " << j << " size: " << dim[j] << endmsg;
           }
         }
@@ -110,7 +120,7 @@ namespace Jug::Reco {
                              {static_cast<float>(pos.x() / mm), static_cast<float>(pos.y() / mm),
                               static_cast<float>(pos.z() / mm)},                    // mm
                              {get_variance(dim[0] / mm), get_variance(dim[1] / mm), // variance (see note above)
-                              std::size(dim) > 2 ? get_variance(dim[2] / mm) : 0.},
+                              cell.nDimensions > 2 ? get_variance(dim[2] / mm) : 0.},
                              static_cast<float>(ahit.getTimeStamp() / 1000), // ns
                              m_timeResolution,                            // in ns
                              static_cast<float>(ahit.getCharge() / 1.0e6),   // Collected energy (GeV)
@@ -49,6 +49,9 @@ struct Trajectories final {
   /// Return true if there exists no valid trajectory.
   bool empty() const { return m_trackTips.empty(); }
 
+  /// Return true if there is an underlying multi trajectory (even without tips).
+  bool hasMultiTrajectory() const { return m_multiTrajectory != nullptr; }
+
   /// Access the underlying multi trajectory.
   const MultiTrajectory& multiTrajectory() const { return *m_multiTrajectory; }
 
@@ -12,6 +12,7 @@
 #include "GaudiKernel/ToolHandle.h"
 
 #include "JugBase/DataHandle.h"
+#include "JugBase/ICellGeometrySvc.h"
 #include "JugBase/IGeoSvc.h"
 
 #include "DD4hep/DD4hepUnits.h"
@@ -48,8 +49,11 @@ private:
   DataHandle<std::list<IndexSourceLink>> m_sourceLinkStorage{"sourceLinkStorage", Gaudi::DataHandle::Writer, this};
   DataHandle<IndexSourceLinkContainer> m_outputSourceLinks{"outputSourceLinks", Gaudi::DataHandle::Writer, this};
   DataHandle<MeasurementContainer> m_outputMeasurements{"outputMeasurements", Gaudi::DataHandle::Writer, this};
+  Gaudi::Property<std::string> m_cellGeoSvcName{this, "cellGeoServiceName", "CellGeometrySvc"};
   /// Pointer to the geometry service
   SmartIF<IGeoSvc> m_geoSvc;
+  /// Pointer to the cell geometry cache
+  SmartIF<ICellGeometrySvc> m_cellGeoSvc;
 
 public:
   TrackerSourceLinker(const std::string& name, ISvcLocator* svcLoc) : GaudiAlgorithm(name, svcLoc) {
@@ -69,6 +73,11 @@ public:
               << "Make sure you have GeoSvc and SimSvc in the right order in the configuration." << endmsg;
       return StatusCode::FAILURE;
     }
+    m_cellGeoSvc = service(m_cellGeoSvcName);
+    if (!m_cellGeoSvc) {
+      error() << "Unable to locate Cell Geometry Service " << m_cellGeoSvcName << endmsg;
+      return StatusCode::FAILURE;
+    }
 
     return StatusCode::SUCCESS;
   }
@@ -99,15 +108,14 @@ public:
         debug() << "cov matrix:\n" << cov << endmsg;
       }
 
-      const auto* vol_ctx = m_geoSvc->cellIDPositionConverter()->findContext(ahit.getCellID());
-      auto vol_id = vol_ctx->identifier;
+      const auto cell   = m_cellGeoSvc->cell(ahit.getCellID());
+      const auto vol_id = cell.volumeID;
 
-      const auto is = m_geoSvc->surfaceMap().find(vol_id);
-      if (is == m_geoSvc->surfaceMap().end()) {
+      const Acts::Surface* surface = cell.surface;
+      if (surface == nullptr) {
         error() << " vol_id (" << vol_id << ")  not found in m_surfaces." << endmsg;
         continue;
       }
-      const Acts::Surface* surface = is->second;
       // variable surf_center not used anywhere;
       // auto surf_center = surface->center(Acts::GeometryContext());
 
@@ -124,8 +132,7 @@ public:
       loc[Acts::eBoundLoc1] = pos[1];
 
       if (msgLevel(MSG::DEBUG)) {
-        auto volman         = m_geoSvc->detector()->volumeManager();
-        auto alignment      = volman.lookupDetElement(vol_id).nominal();
+        auto alignment      = cell.detElement.nominal();
         auto local_position = (alignment.worldToLocal({ahit.getPosition().x / mm_conv, ahit.getPosition().y / mm_conv,
                                                        ahit.getPosition().z / mm_conv})) *
                               mm_conv;
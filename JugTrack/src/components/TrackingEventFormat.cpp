@@ -0,0 +1,602 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Whitney Armstrong, Wouter Deconinck
+
+#include "TrackingEventFormat.h"
+
+#include <array>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <variant>
+
+#include "Acts/Surfaces/PerigeeSurface.hpp"
+
+namespace Jug::Reco {
+
+namespace {
+
+  /// Index of nothing (no previous state, surface or source link)
+  constexpr uint32_t kNone = std::numeric_limits<uint32_t>::max();
+
+  /// Content of a stored track state
+  enum StateBits : uint8_t {
+    kPredicted  = 1 << 0,
+    kFiltered   = 1 << 1,
+    kSmoothed   = 1 << 2,
+    kJacobian   = 1 << 3,
+    kCalibrated = 1 << 4,
+    kSourceLink = 1 << 5
+  };
+
+  /// Append the upper triangle of a symmetric matrix
+  template <class M> void pack(const M& m, std::vector<double>& out) {
+    for (int i = 0; i < m.rows(); ++i) {
+      for (int j = i; j < m.cols(); ++j) {
+        out.push_back(m(i, j));
+      }
+    }
+  }
+
+  /// Read a symmetric matrix from its upper triangle, starting at pos
+  template <class M> void unpack(const std::vector<double>& in, size_t& pos, M&& m) {
+    for (int i = 0; i < m.rows(); ++i) {
+      for (int j = i; j < m.cols(); ++j) {
+        m(i, j) = m(j, i) = in.at(pos++);
+      }
+    }
+  }
+
+  template <class V> void append(const V& v, std::vector<double>& out) {
+    for (int i = 0; i < v.size(); ++i) {
+      out.push_back(v[i]);
+    }
+  }
+
+  template <class V> void extract(const std::vector<double>& in, size_t& pos, V&& v) {
+    for (int i = 0; i < v.size(); ++i) {
+      v[i] = in.at(pos++);
+    }
+  }
+
+  template <unsigned int N>
+  Measurement makeMeasurement(const IndexSourceLink& sourceLink, const std::vector<uint8_t>& indices,
+                              const std::vector<double>& parameters, size_t& ipar,
+                              const std::vector<double>& covariance, size_t& icov) {
+    std::array<Acts::BoundIndices, N> idx{};
+    Acts::ActsVector<N> par;
+    for (unsigned int k = 0; k < N; ++k) {
+      idx[k] = static_cast<Acts::BoundIndices>(indices.at(ipar));
+      par[k] = parameters.at(ipar++);
+    }
+    Acts::ActsSymMatrix<N> cov;
+    unpack(covariance, icov, cov);
+    return Acts::Measurement<Acts::BoundIndices, N>(sourceLink, idx, par, cov);
+  }
+
+  using MaskBits = std::underlying_type_t<Acts::TrackStatePropMask>;
+  constexpr MaskBits bits(Acts::TrackStatePropMask mask) { return static_cast<MaskBits>(mask); }
+
+} // namespace
+
+template <class T> struct TrackingEventFormat::Column {
+  std::vector<T> data;
+  /// ROOT reads into the vector this points to
+  std::vector<T>* address{&data};
+
+  void bind(TTree* tree, const std::string& name, bool write) {
+    if (write) {
+      tree->Branch(name.c_str(), &data);
+      return;
+    }
+    if (tree->GetBranch(name.c_str()) == nullptr) {
+      throw std::runtime_error("No branch " + name + " in tree " + tree->GetName());
+    }
+    tree->SetBranchAddress(name.c_str(), &address);
+  }
+};
+
+struct TrackingEventFormat::SurfaceColumns {
+  Column<uint64_t> geoID;
+  /// Position of the perigee surfaces (3 per surface)
+  Column<double> center;
+
+  SurfaceColumns(TTree* tree, bool write) {
+    geoID.bind(tree, "surfaces_geoID", write);
+    center.bind(tree, "surfaces_center", write);
+  }
+  void clear() {
+    geoID.data.clear();
+    center.data.clear();
+  }
+};
+
+struct TrackingEventFormat::SourceLinkColumns {
+  Column<uint64_t> geoID;
+  Column<uint32_t> index;
+
+  SourceLinkColumns(TTree* tree, bool write, const std::string& prefix) {
+    geoID.bind(tree, prefix + "_geoID", write);
+    index.bind(tree, prefix + "_index", write);
+  }
+  void clear() {
+    geoID.data.clear();
+    index.data.clear();
+  }
+};
+
+struct TrackingEventFormat::MeasurementColumns {
+  Column<uint32_t> sourceLink;
+  Column<uint8_t> size;
+  /// Bound indices and parameters (size per measurement)
+  Column<uint8_t> indices;
+  Column<double> parameters;
+  Column<double> covariance;
+
+  MeasurementColumns(TTree* tree, bool write, const std::string& prefix) {
+    sourceLink.bind(tree, prefix + "_sourceLink", write);
+    size.bind(tree, prefix + "_size", write);
+    indices.bind(tree, prefix + "_indices", write);
+    parameters.bind(tree, prefix + "_parameters", write);
+    covariance.bind(tree, prefix + "_covariance", write);
+  }
+  void clear() {
+    sourceLink.data.clear();
+    size.data.clear();
+    indices.data.clear();
+    parameters.data.clear();
+    covariance.data.clear();
+  }
+};
+
+struct TrackingEventFormat::ParameterColumns {
+  Column<uint32_t> surface;
+  /// eBoundSize parameters each
+  Column<double> parameters;
+  Column<uint8_t> hasCovariance;
+  Column<double> covariance;
+
+  ParameterColumns(TTree* tree, bool write, const std::string& prefix) {
+    surface.bind(tree, prefix + "_surface", write);
+    parameters.bind(tree, prefix + "_parameters", write);
+    hasCovariance.bind(tree, prefix + "_hasCovariance", write);
+    covariance.bind(tree, prefix + "_covariance", write);
+  }
+  void clear() {
+    surface.data.clear();
+    parameters.data.clear();
+    hasCovariance.data.clear();
+    covariance.data.clear();
+  }
+};
+
+struct TrackingEventFormat::TrajectoryColumns {
+  /// Per multi trajectory
+  Column<uint32_t> nStates;
+  /// Per track state
+  Column<uint32_t> previous;
+  Column<uint8_t> content;
+  Column<uint32_t> surface;
+  Column<uint32_t> sourceLink;
+  Column<double> pathLength;
+  Column<double> chi2;
+  Column<uint64_t> typeFlags;
+  /// Predicted, filtered and smoothed (as present)
+  Column<double> parameters;
+  Column<double> covariance;
+  Column<double> jacobian;
+  /// Per trajectory
+  Column<uint32_t> multiTrajectory;
+  Column<uint32_t> nTips;
+  Column<uint32_t> tips;
+  Column<uint32_t> nFitted;
+  Column<uint32_t> fittedTips;
+  ParameterColumns fitted;
+
+  TrajectoryColumns(TTree* tree, bool write, const std::string& prefix)
+      : fitted(tree, write, prefix + "_fitted") {
+    nStates.bind(tree, prefix + "_nStates", write);
+    previous.bind(tree, prefix + "_previous", write);
+    content.bind(tree, prefix + "_content", write);
+    surface.bind(tree, prefix + "_surface", write);
+    sourceLink.bind(tree, prefix + "_sourceLink", write);
+    pathLength.bind(tree, prefix + "_pathLength", write);
+    chi2.bind(tree, prefix + "_chi2", write);
+    typeFlags.bind(tree, prefix + "_typeFlags", write);
+    parameters.bind(tree, prefix + "_parameters", write);
+    covariance.bind(tree, prefix + "_covariance", write);
+    jacobian.bind(tree, prefix + "_jacobian", write);
+    multiTrajectory.bind(tree, prefix + "_multiTrajectory", write);
+    nTips.bind(tree, prefix + "_nTips", write);
+    tips.bind(tree, prefix + "_tips", write);
+    nFitted.bind(tree, prefix + "_nFitted", write);
+    fittedTips.bind(tree, prefix + "_fittedTips", write);
+  }
+  void clear() {
+    for (auto* column : {&nStates, &previous, &surface, &sourceLink, &multiTrajectory, &nTips,
+                         &tips, &nFitted, &fittedTips}) {
+      column->data.clear();
+    }
+    for (auto* column : {&pathLength, &chi2, &parameters, &covariance, &jacobian}) {
+      column->data.clear();
+    }
+    content.data.clear();
+    typeFlags.data.clear();
+    fitted.clear();
+  }
+};
+
+TrackingEventFormat::TrackingEventFormat(TTree* tree, const bool write, const Names& names)
+    : m_surfaces{std::make_unique<SurfaceColumns>(tree, write)} {
+  if (!names.sourceLinks.empty()) {
+    m_sourceLinks = std::make_unique<SourceLinkColumns>(tree, write, names.sourceLinks);
+  }
+  if (!names.measurements.empty()) {
+    m_measurements = std::make_unique<MeasurementColumns>(tree, write, names.measurements);
+  }
+  for (const auto& name : names.trajectories) {
+    m_trajectories.push_back(std::make_unique<TrajectoryColumns>(tree, write, name));
+  }
+  for (const auto& name : names.trackParameters) {
+    m_trackParameters.push_back(std::make_unique<ParameterColumns>(tree, write, name));
+  }
+}
+
+TrackingEventFormat::~TrackingEventFormat() = default;
+
+void TrackingEventFormat::clear() {
+  m_surfaces->clear();
+  m_surfaceByID.clear();
+  m_surfaceByAddress.clear();
+  if (m_sourceLinks) {
+    m_sourceLinks->clear();
+  }
+  if (m_measurements) {
+    m_measurements->clear();
+  }
+  for (auto& columns : m_trajectories) {
+    columns->clear();
+  }
+  for (auto& columns : m_trackParameters) {
+    columns->clear();
+  }
+}
+
+uint32_t TrackingEventFormat::surfaceIndex(const Acts::Surface& surface) {
+  const auto next = static_cast<uint32_t>(m_surfaces->geoID.data.size());
+  const uint64_t geoID = surface.geometryId().value();
+  if (geoID != 0) {
+    const auto [it, inserted] = m_surfaceByID.emplace(geoID, next);
+    if (inserted) {
+      m_surfaces->geoID.data.push_back(geoID);
+      m_surfaces->center.data.insert(m_surfaces->center.data.end(), {0., 0., 0.});
+    }
+    return it->second;
+  }
+  // the only surfaces that are not part of the tracking geometry are the perigee surfaces
+  // the parameters are expressed at
+  if (surface.type() != Acts::Surface::Perigee) {
+    throw std::runtime_error("Cannot store parameters on a surface without geometry identifier");
+  }
+  const auto [it, inserted] = m_surfaceByAddress.emplace(&surface, next);
+  if (inserted) {
+    m_surfaces->geoID.data.push_back(0);
+    append(surface.center(Acts::GeometryContext()), m_surfaces->center.data);
+  }
+  return it->second;
+}
+
+void TrackingEventFormat::addParameters(ParameterColumns& columns, const TrackParameters& parameters) {
+  columns.surface.data.push_back(surfaceIndex(parameters.referenceSurface()));
+  append(parameters.parameters(), columns.parameters.data);
+  const auto& covariance = parameters.covariance();
+  columns.hasCovariance.data.push_back(covariance.has_value() ? 1 : 0);
+  if (covariance) {
+    pack(*covariance, columns.covariance.data);
+  }
+}
+
+void TrackingEventFormat::addSourceLinks(const std::list<IndexSourceLink>& sourceLinks) {
+  for (const auto& sourceLink : sourceLinks) {
+    m_sourceLinks->geoID.data.push_back(sourceLink.geometryId().value());
+    m_sourceLinks->index.data.push_back(sourceLink.index());
+  }
+}
+
+void TrackingEventFormat::addMeasurements(const MeasurementContainer& measurements) {
+  auto& columns = *m_measurements;
+  for (const auto& measurement : measurements) {
+    std::visit(
+        [&columns](const auto& meas) {
+          const auto& sourceLink = static_cast<const IndexSourceLink&>(meas.sourceLink());
+          columns.sourceLink.data.push_back(sourceLink.index());
+          columns.size.data.push_back(static_cast<uint8_t>(meas.indices().size()));
+          for (const auto index : meas.indices()) {
+            columns.indices.data.push_back(static_cast<uint8_t>(index));
+          }
+          append(meas.parameters(), columns.parameters.data);
+          pack(meas.covariance(), columns.covariance.data);
+        },
+        measurement);
+  }
+}
+
+void TrackingEventFormat::addTrajectories(const size_t i, const TrajectoriesContainer& trajectories) {
+  auto& columns = *m_trajectories.at(i);
+  // several trajectories can share a multi trajectory
+  std::unordered_map<const Trajectories::MultiTrajectory*, uint32_t> stored;
+  for (const auto& traj : trajectories) {
+    // (a default constructed Trajectories has no multi trajectory, but one without tips can
+    // still have states)
+    if (!traj.hasMultiTrajectory()) {
+      columns.multiTrajectory.data.push_back(kNone);
+      columns.nTips.data.push_back(0);
+      columns.nFitted.data.push_back(0);
+      continue;
+    }
+    const auto& mj            = traj.multiTrajectory();
+    const auto [it, inserted] =
+        stored.emplace(&mj, static_cast<uint32_t>(columns.nStates.data.size()));
+    if (inserted) {
+      const auto nStates = static_cast<uint32_t>(mj.size());
+      columns.nStates.data.push_back(nStates);
+      for (uint32_t k = 0; k < nStates; ++k) {
+        const auto ts   = mj.getTrackState(k);
+        uint8_t content = 0;
+        if (ts.hasPredicted()) {
+          content |= kPredicted;
+          append(ts.predicted(), columns.parameters.data);
+          pack(ts.predictedCovariance(), columns.covariance.data);
+        }
+        if (ts.hasFiltered()) {
+          content |= kFiltered;
+          append(ts.filtered(), columns.parameters.data);
+          pack(ts.filteredCovariance(), columns.covariance.data);
+        }
+        if (ts.hasSmoothed()) {
+          content |= kSmoothed;
+          append(ts.smoothed(), columns.parameters.data);
+          pack(ts.smoothedCovariance(), columns.covariance.data);
+        }
+        if (ts.hasJacobian()) {
+          content |= kJacobian;
+          const auto& jacobian = ts.jacobian();
+          for (int r = 0; r < jacobian.rows(); ++r) {
+            for (int c = 0; c < jacobian.cols(); ++c) {
+              columns.jacobian.data.push_back(jacobian(r, c));
+            }
+          }
+        }
+        if (ts.hasCalibrated()) {
+          content |= kCalibrated;
+        }
+        uint32_t sourceLink = kNone;
+        if (ts.hasUncalibrated()) {
+          content |= kSourceLink;
+          sourceLink = static_cast<const IndexSourceLink&>(ts.uncalibrated()).index();
+        }
+        columns.content.data.push_back(content);
+        columns.sourceLink.data.push_back(sourceLink);
+        columns.previous.data.push_back(ts.previous() == Acts::MultiTrajectoryTraits::kInvalid
+                                            ? kNone
+                                            : static_cast<uint32_t>(ts.previous()));
+        columns.surface.data.push_back(ts.hasReferenceSurface() ? surfaceIndex(ts.referenceSurface())
+                                                                : kNone);
+        columns.pathLength.data.push_back(ts.pathLength());
+        columns.chi2.data.push_back(ts.chi2());
+        columns.typeFlags.data.push_back(ts.typeFlags().to_ullong());
+      }
+    }
+    columns.multiTrajectory.data.push_back(it->second);
+
+    const auto& tips = traj.tips();
+    columns.nTips.data.push_back(static_cast<uint32_t>(tips.size()));
+    uint32_t nFitted = 0;
+    for (const auto tip : tips) {
+      columns.tips.data.push_back(static_cast<uint32_t>(tip));
+      if (traj.hasTrackParameters(tip)) {
+        columns.fittedTips.data.push_back(static_cast<uint32_t>(tip));
+        addParameters(columns.fitted, traj.trackParameters(tip));
+        ++nFitted;
+      }
+    }
+    columns.nFitted.data.push_back(nFitted);
+  }
+}
+
+void TrackingEventFormat::addTrackParameters(const size_t i, const TrackParametersContainer& parameters) {
+  for (const auto& pars : parameters) {
+    addParameters(*m_trackParameters.at(i), pars);
+  }
+}
+
+void TrackingEventFormat::resolveSurfaces(const Acts::TrackingGeometry& geometry) {
+  m_resolved.clear();
+  const auto& geoIDs = m_surfaces->geoID.data;
+  const auto& center = m_surfaces->center.data;
+  for (size_t i = 0; i < geoIDs.size(); ++i) {
+    if (geoIDs[i] != 0) {
+      const auto* surface = geometry.findSurface(Acts::GeometryIdentifier(geoIDs[i]));
+      if (surface == nullptr) {
+        throw std::runtime_error("No surface with geometry identifier " +
+                                 std::to_string(geoIDs[i]) + " in the tracking geometry");
+      }
+      m_resolved.push_back(surface->getSharedPtr());
+    } else {
+      m_resolved.push_back(Acts::Surface::makeShared<Acts::PerigeeSurface>(
+          Acts::Vector3{center.at(3 * i), center.at(3 * i + 1), center.at(3 * i + 2)}));
+    }
+  }
+}
+
+TrackParameters TrackingEventFormat::parameters(const ParameterColumns& columns, const size_t i,
+                                                size_t& icov) const {
+  Acts::BoundVector values;
+  size_t ipar = i * Acts::eBoundSize;
+  extract(columns.parameters.data, ipar, values);
+  std::optional<Acts::BoundSymMatrix> covariance;
+  if (columns.hasCovariance.data.at(i) != 0) {
+    covariance = Acts::BoundSymMatrix::Zero();
+    unpack(columns.covariance.data, icov, *covariance);
+  }
+  return TrackParameters(m_resolved.at(columns.surface.data.at(i)), values, covariance);
+}
+
+const IndexSourceLink& TrackingEventFormat::sourceLink(const uint32_t index) const {
+  const auto it = m_sourceLinkByIndex.find(index);
+  if (it == m_sourceLinkByIndex.end()) {
+    throw std::runtime_error("No source link with index " + std::to_string(index));
+  }
+  return *it->second;
+}
+
+void TrackingEventFormat::restoreSourceLinks(std::list<IndexSourceLink>& sourceLinks) {
+  m_sourceLinkByIndex.clear();
+  const auto& geoIDs  = m_sourceLinks->geoID.data;
+  const auto& indices = m_sourceLinks->index.data;
+  for (size_t i = 0; i < geoIDs.size(); ++i) {
+    sourceLinks.emplace_back(Acts::GeometryIdentifier(geoIDs[i]), indices.at(i));
+    m_sourceLinkByIndex[indices[i]] = &sourceLinks.back();
+  }
+}
+
+void TrackingEventFormat::restoreMeasurements(MeasurementContainer& measurements) const {
+  const auto& columns = *m_measurements;
+  measurements.reserve(columns.size.data.size());
+  size_t ipar = 0;
+  size_t icov = 0;
+  for (size_t i = 0; i < columns.size.data.size(); ++i) {
+    const auto& sl = sourceLink(columns.sourceLink.data.at(i));
+    const auto& in = columns.indices.data;
+    const auto& p  = columns.parameters.data;
+    const auto& c  = columns.covariance.data;
+    switch (columns.size.data[i]) {
+    case 1:
+      measurements.push_back(makeMeasurement<1>(sl, in, p, ipar, c, icov));
+      break;
+    case 2:
+      measurements.push_back(makeMeasurement<2>(sl, in, p, ipar, c, icov));
+      break;
+    case 3:
+      measurements.push_back(makeMeasurement<3>(sl, in, p, ipar, c, icov));
+      break;
+    case 4:
+      measurements.push_back(makeMeasurement<4>(sl, in, p, ipar, c, icov));
+      break;
+    case 5:
+      measurements.push_back(makeMeasurement<5>(sl, in, p, ipar, c, icov));
+      break;
+    case 6:
+      measurements.push_back(makeMeasurement<6>(sl, in, p, ipar, c, icov));
+      break;
+    default:
+      throw std::runtime_error("Invalid measurement size " + std::to_string(columns.size.data[i]));
+    }
+  }
+}
+
+void TrackingEventFormat::restoreTrajectories(const size_t i, TrajectoriesContainer& trajectories,
+                                              const MeasurementContainer* measurements) const {
+  const auto& columns = *m_trajectories.at(i);
+  const std::optional<MeasurementCalibrator> calibrator =
+      (measurements != nullptr) ? std::optional<MeasurementCalibrator>{*measurements} : std::nullopt;
+
+  // the multi trajectories, with their states in the original order
+  std::vector<std::shared_ptr<Trajectories::MultiTrajectory>> multiTrajectories;
+  size_t istate = 0;
+  size_t ipar   = 0;
+  size_t icov   = 0;
+  size_t ijac   = 0;
+  for (const auto nStates : columns.nStates.data) {
+    auto mj = std::make_shared<Trajectories::MultiTrajectory>();
+    for (uint32_t k = 0; k < nStates; ++k, ++istate) {
+      const uint8_t content    = columns.content.data.at(istate);
+      const uint32_t linkIndex = columns.sourceLink.data.at(istate);
+      const bool calibrate     = (content & kCalibrated) && (content & kSourceLink) && calibrator;
+      if ((content & kCalibrated) && !calibrate) {
+        ++m_nUncalibrated;
+      }
+      MaskBits mask = bits(Acts::TrackStatePropMask::None);
+      mask |= (content & kPredicted) ? bits(Acts::TrackStatePropMask::Predicted) : 0;
+      mask |= (content & kFiltered) ? bits(Acts::TrackStatePropMask::Filtered) : 0;
+      mask |= (content & kSmoothed) ? bits(Acts::TrackStatePropMask::Smoothed) : 0;
+      mask |= (content & kJacobian) ? bits(Acts::TrackStatePropMask::Jacobian) : 0;
+      mask |= (content & kSourceLink) ? bits(Acts::TrackStatePropMask::Uncalibrated) : 0;
+      mask |= calibrate ? bits(Acts::TrackStatePropMask::Calibrated) : 0;
+
+      const uint32_t previous = columns.previous.data.at(istate);
+      const auto index        = mj->addTrackState(static_cast<Acts::TrackStatePropMask>(mask),
+                                                  previous == kNone ? Acts::MultiTrajectoryTraits::kInvalid
+                                                                    : previous);
+      if (index != k) {
+        throw std::runtime_error("Unexpected track state index " + std::to_string(index));
+      }
+      auto ts = mj->getTrackState(index);
+      if (content & kPredicted) {
+        extract(columns.parameters.data, ipar, ts.predicted());
+        unpack(columns.covariance.data, icov, ts.predictedCovariance());
+      }
+      if (content & kFiltered) {
+        extract(columns.parameters.data, ipar, ts.filtered());
+        unpack(columns.covariance.data, icov, ts.filteredCovariance());
+      }
+      if (content & kSmoothed) {
+        extract(columns.parameters.data, ipar, ts.smoothed());
+        unpack(columns.covariance.data, icov, ts.smoothedCovariance());
+      }
+      if (content & kJacobian) {
+        auto jacobian = ts.jacobian();
+        for (int r = 0; r < jacobian.rows(); ++r) {
+          for (int c = 0; c < jacobian.cols(); ++c) {
+            jacobian(r, c) = columns.jacobian.data.at(ijac++);
+          }
+        }
+      }
+      if (const uint32_t surface = columns.surface.data.at(istate); surface != kNone) {
+        ts.setReferenceSurface(m_resolved.at(surface));
+      }
+      if (content & kSourceLink) {
+        ts.setUncalibrated(sourceLink(linkIndex));
+      }
+      if (calibrate) {
+        calibrator->calibrate(Acts::GeometryContext(), ts);
+      }
+      ts.pathLength() = columns.pathLength.data.at(istate);
+      ts.chi2()       = columns.chi2.data.at(istate);
+      ts.typeFlags()  = Acts::TrackStateType(columns.typeFlags.data.at(istate));
+    }
+    multiTrajectories.push_back(std::move(mj));
+  }
+
+  size_t itip    = 0;
+  size_t ifitted = 0;
+  size_t ifcov   = 0;
+  trajectories.reserve(columns.multiTrajectory.data.size());
+  for (size_t t = 0; t < columns.multiTrajectory.data.size(); ++t) {
+    const uint32_t mj = columns.multiTrajectory.data[t];
+    if (mj == kNone) {
+      trajectories.emplace_back();
+      continue;
+    }
+    std::vector<Acts::MultiTrajectoryTraits::IndexType> tips;
+    for (uint32_t k = 0; k < columns.nTips.data.at(t); ++k) {
+      tips.push_back(columns.tips.data.at(itip++));
+    }
+    Trajectories::IndexedParameters fitted;
+    for (uint32_t k = 0; k < columns.nFitted.data.at(t); ++k, ++ifitted) {
+      fitted.emplace(columns.fittedTips.data.at(ifitted), parameters(columns.fitted, ifitted, ifcov));
+    }
+    trajectories.emplace_back(multiTrajectories.at(mj), tips, fitted);
+  }
+}
+
+void TrackingEventFormat::restoreTrackParameters(const size_t i, TrackParametersContainer& parameters) const {
+  const auto& columns = *m_trackParameters.at(i);
+  parameters.reserve(columns.surface.data.size());
+  size_t icov = 0;
+  for (size_t k = 0; k < columns.surface.data.size(); ++k) {
+    parameters.push_back(this->parameters(columns, k, icov));
+  }
+}
+
+} // namespace Jug::Reco
@@ -0,0 +1,118 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Whitney Armstrong, Wouter Deconinck
+
+#ifndef JUGGLER_JUGTRACK_TrackingEventFormat_HH
+#define JUGGLER_JUGTRACK_TrackingEventFormat_HH
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "JugTrack/IndexSourceLink.hpp"
+#include "JugTrack/Measurement.hpp"
+#include "JugTrack/Track.hpp"
+#include "JugTrack/Trajectories.hpp"
+
+#include "Acts/Geometry/TrackingGeometry.hpp"
+
+#include "TTree.h"
+
+namespace Jug::Reco {
+
+/** Columnar on-disk format of the (transient) ACTS tracking event data.
+ *
+ *  One TTree entry per event, and every column is a std::vector branch, so the
+ *  data of an event is a handful of flat arrays:
+ *   - surfaces: geometry ID of the surfaces used by the parameters below, or the
+ *     position of a perigee surface (geometry ID 0)
+ *   - source links (the storage list of TrackerSourceLinker): geometry ID and index
+ *   - measurements: source link index, bound indices, parameters and covariance
+ *   - trajectories: the track states of the multi trajectories (a multi trajectory
+ *     shared by several Trajectories is stored once), with the predicted, filtered
+ *     and smoothed parameters and covariances, jacobian, path length, chi2, type
+ *     flags and source link index, followed by the tips and the fitted parameters
+ *   - track parameters: surface, parameters and (optional) covariance
+ *  Covariances are stored as their upper triangle. The branches of a container are
+ *  prefixed with its name in the event store.
+ *
+ *  Calibrated measurements of the track states are not stored, but recreated from the
+ *  measurements when reading (as the MeasurementCalibrator does).
+ *
+ * \ingroup tracking
+ */
+class TrackingEventFormat {
+public:
+  static constexpr int kVersion = 1;
+
+  /// Names of the containers in the event store (empty: not stored)
+  struct Names {
+    std::string sourceLinks;
+    std::string measurements;
+    std::vector<std::string> trajectories;
+    std::vector<std::string> trackParameters;
+  };
+
+  /// Create the branches (write) or connect to them (read), throws if a branch is missing
+  TrackingEventFormat(TTree* tree, bool write, const Names& names);
+  ~TrackingEventFormat();
+
+  TrackingEventFormat(const TrackingEventFormat&) = delete;
+  TrackingEventFormat& operator=(const TrackingEventFormat&) = delete;
+
+  /// Writing: clear the columns, fill them and call TTree::Fill
+  void clear();
+  void addSourceLinks(const std::list<IndexSourceLink>& sourceLinks);
+  void addMeasurements(const MeasurementContainer& measurements);
+  void addTrajectories(size_t i, const TrajectoriesContainer& trajectories);
+  void addTrackParameters(size_t i, const TrackParametersContainer& parameters);
+
+  /** Reading: after TTree::GetEntry, resolve the surfaces (needed for the trajectories
+   *  and track parameters) and restore the containers. The measurements and track
+   *  states refer to the source links, which need to be restored first, and they
+   *  need to stay at the same address.
+   */
+  void resolveSurfaces(const Acts::TrackingGeometry& geometry);
+  void restoreSourceLinks(std::list<IndexSourceLink>& sourceLinks);
+  void restoreMeasurements(MeasurementContainer& measurements) const;
+  /// The measurements (if any) are needed for the calibrated measurements of the states
+  void restoreTrajectories(size_t i, TrajectoriesContainer& trajectories,
+                           const MeasurementContainer* measurements) const;
+  void restoreTrackParameters(size_t i, TrackParametersContainer& parameters) const;
+
+  /// Number of track states that lost their calibrated measurement when reading
+  size_t nUncalibrated() const { return m_nUncalibrated; }
+
+private:
+  template <class T> struct Column;
+  struct SurfaceColumns;
+  struct SourceLinkColumns;
+  struct MeasurementColumns;
+  struct ParameterColumns;
+  struct TrajectoryColumns;
+
+  uint32_t surfaceIndex(const Acts::Surface& surface);
+  void addParameters(ParameterColumns& columns, const TrackParameters& parameters);
+  TrackParameters parameters(const ParameterColumns& columns, size_t i, size_t& icov) const;
+  const IndexSourceLink& sourceLink(uint32_t index) const;
+
+  std::unique_ptr<SurfaceColumns> m_surfaces;
+  std::unique_ptr<SourceLinkColumns> m_sourceLinks;
+  std::unique_ptr<MeasurementColumns> m_measurements;
+  std::vector<std::unique_ptr<TrajectoryColumns>> m_trajectories;
+  std::vector<std::unique_ptr<ParameterColumns>> m_trackParameters;
+
+  /// Writing: index of the surfaces of this event
+  std::unordered_map<uint64_t, uint32_t> m_surfaceByID;
+  std::unordered_map<const Acts::Surface*, uint32_t> m_surfaceByAddress;
+  /// Reading: the surfaces and source links of this event
+  std::vector<std::shared_ptr<const Acts::Surface>> m_resolved;
+  std::unordered_map<Index, const IndexSourceLink*> m_sourceLinkByIndex;
+  mutable size_t m_nUncalibrated{0};
+};
+
+} // namespace Jug::Reco
+
+#endif
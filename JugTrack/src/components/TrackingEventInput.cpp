@@ -0,0 +1,187 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Whitney Armstrong, Wouter Deconinck
+
+#include <list>
+#include <memory>
+#include <stdexcept>
+
+// Gaudi
+#include "GaudiAlg/GaudiAlgorithm.h"
+#include "Gaudi/Property.h"
+
+#include "JugBase/DataHandle.h"
+#include "JugBase/IGeoSvc.h"
+#include "JugBase/PodioDataSvc.h"
+#include "JugTrack/IndexSourceLink.hpp"
+#include "JugTrack/Measurement.hpp"
+#include "JugTrack/Track.hpp"
+#include "JugTrack/Trajectories.hpp"
+
+#include "TrackingEventFormat.h"
+
+#include "TFile.h"
+#include "TList.h"
+#include "TParameter.h"
+#include "TTree.h"
+
+namespace Jug::Reco {
+
+  /** Read the ACTS tracking data written by TrackingEventOutput back into the event store,
+   *  e.g. to rerun the algorithms downstream of the track finding and fitting on the
+   *  PodioInput of the same job. Entries are read in order, starting at the first entry of the
+   *  PodioDataSvc (FirstEventEntry, plus the entry range of the worker when sharding), so the
+   *  input needs to be the same.
+   *
+   * \ingroup tracking
+   */
+  class TrackingEventInput : public GaudiAlgorithm {
+  private:
+    Gaudi::Property<std::string> m_filename{this, "filename", "tracking.root", "Name of the file to read"};
+    Gaudi::Property<std::string> m_sourceLinkStorage{
+        this, "sourceLinkStorage", "", "Source link storage (std::list<IndexSourceLink>) to read"};
+    Gaudi::Property<std::string> m_sourceLinks{
+        this, "outputSourceLinks", "", "Geometry ordered source links (from the storage) to create"};
+    Gaudi::Property<std::string> m_measurements{this, "measurements", "", "Measurements to read"};
+    Gaudi::Property<std::vector<std::string>> m_trajectories{this, "trajectories", {}, "Trajectories to read"};
+    Gaudi::Property<std::vector<std::string>> m_trackParameters{
+        this, "trackParameters", {}, "Track parameters to read"};
+
+    std::unique_ptr<DataHandle<std::list<IndexSourceLink>>> m_sourceLinkStorageHandle;
+    std::unique_ptr<DataHandle<IndexSourceLinkContainer>> m_sourceLinkHandle;
+    std::unique_ptr<DataHandle<MeasurementContainer>> m_measurementHandle;
+    std::vector<std::unique_ptr<DataHandle<TrajectoriesContainer>>> m_trajectoryHandles;
+    std::vector<std::unique_ptr<DataHandle<TrackParametersContainer>>> m_trackParameterHandles;
+
+    SmartIF<IGeoSvc> m_geoSvc;
+    std::unique_ptr<TFile> m_file;
+    /// Owned by the file
+    TTree* m_tree{nullptr};
+    std::unique_ptr<TrackingEventFormat> m_format;
+    Long64_t m_entry{0};
+
+  public:
+    TrackingEventInput(const std::string& name, ISvcLocator* svcLoc) : GaudiAlgorithm(name, svcLoc) {}
+
+    StatusCode initialize() override {
+      if (GaudiAlgorithm::initialize().isFailure()) {
+        return StatusCode::FAILURE;
+      }
+      m_geoSvc = service("GeoSvc");
+      if (!m_geoSvc) {
+        error() << "Unable to locate Geometry Service. "
+                << "Make sure you have GeoSvc and SimSvc in the right order in the configuration." << endmsg;
+        return StatusCode::FAILURE;
+      }
+      if (m_sourceLinkStorage.value().empty() &&
+          (!m_sourceLinks.value().empty() || !m_measurements.value().empty())) {
+        error() << "The source links and measurements need the sourceLinkStorage" << endmsg;
+        return StatusCode::FAILURE;
+      }
+      if (!m_sourceLinkStorage.value().empty()) {
+        m_sourceLinkStorageHandle = std::make_unique<DataHandle<std::list<IndexSourceLink>>>(
+            m_sourceLinkStorage, Gaudi::DataHandle::Writer, this);
+      }
+      if (!m_sourceLinks.value().empty()) {
+        m_sourceLinkHandle =
+            std::make_unique<DataHandle<IndexSourceLinkContainer>>(m_sourceLinks, Gaudi::DataHandle::Writer, this);
+      }
+      if (!m_measurements.value().empty()) {
+        m_measurementHandle =
+            std::make_unique<DataHandle<MeasurementContainer>>(m_measurements, Gaudi::DataHandle::Writer, this);
+      }
+      for (const auto& name : m_trajectories) {
+        m_trajectoryHandles.push_back(
+            std::make_unique<DataHandle<TrajectoriesContainer>>(name, Gaudi::DataHandle::Writer, this));
+      }
+      for (const auto& name : m_trackParameters) {
+        m_trackParameterHandles.push_back(
+            std::make_unique<DataHandle<TrackParametersContainer>>(name, Gaudi::DataHandle::Writer, this));
+      }
+
+      m_file = std::unique_ptr<TFile>(TFile::Open(m_filename.value().c_str(), "READ"));
+      if (!m_file || m_file->IsZombie()) {
+        error() << "Unable to open " << m_filename.value() << endmsg;
+        return StatusCode::FAILURE;
+      }
+      m_tree = m_file->Get<TTree>("tracking");
+      if (m_tree == nullptr) {
+        error() << "No tracking tree in " << m_filename.value() << endmsg;
+        return StatusCode::FAILURE;
+      }
+      const auto* version = dynamic_cast<TParameter<int>*>(m_tree->GetUserInfo()->FindObject("version"));
+      if (version == nullptr || version->GetVal() != TrackingEventFormat::kVersion) {
+        error() << m_filename.value() << " was written with a different tracking format version" << endmsg;
+        return StatusCode::FAILURE;
+      }
+      try {
+        m_format = std::make_unique<TrackingEventFormat>(
+            m_tree, false,
+            TrackingEventFormat::Names{m_sourceLinkStorage, m_measurements, m_trajectories, m_trackParameters});
+      } catch (const std::runtime_error& e) {
+        error() << e.what() << endmsg;
+        return StatusCode::FAILURE;
+      }
+
+      const auto* podioDataSvc = dynamic_cast<const PodioDataSvc*>(evtSvc().get());
+      if (podioDataSvc == nullptr) {
+        error() << "The entries are taken from the PodioInput, but the event store is not a PodioDataSvc"
+                << endmsg;
+        return StatusCode::FAILURE;
+      }
+      m_entry = podioDataSvc->firstEntry();
+      return StatusCode::SUCCESS;
+    }
+
+    StatusCode execute() override {
+      if (m_entry >= m_tree->GetEntries()) {
+        error() << "No entry " << m_entry << " in " << m_filename.value() << endmsg;
+        return StatusCode::FAILURE;
+      }
+      if (m_tree->GetEntry(m_entry++) <= 0) {
+        error() << "Failed to read entry " << m_entry - 1 << " of " << m_filename.value() << endmsg;
+        return StatusCode::FAILURE;
+      }
+      try {
+        m_format->resolveSurfaces(*m_geoSvc->trackingGeometry());
+        if (m_sourceLinkStorageHandle) {
+          auto* storage = m_sourceLinkStorageHandle->createAndPut();
+          m_format->restoreSourceLinks(*storage);
+          if (m_sourceLinkHandle) {
+            auto* sourceLinks = m_sourceLinkHandle->createAndPut();
+            for (const auto& sourceLink : *storage) {
+              sourceLinks->emplace(sourceLink);
+            }
+          }
+        }
+        MeasurementContainer* measurements = nullptr;
+        if (m_measurementHandle) {
+          measurements = m_measurementHandle->createAndPut();
+          m_format->restoreMeasurements(*measurements);
+        }
+        for (size_t i = 0; i < m_trajectoryHandles.size(); ++i) {
+          m_format->restoreTrajectories(i, *m_trajectoryHandles[i]->createAndPut(), measurements);
+        }
+        for (size_t i = 0; i < m_trackParameterHandles.size(); ++i) {
+          m_format->restoreTrackParameters(i, *m_trackParameterHandles[i]->createAndPut());
+        }
+      } catch (const std::exception& e) {
+        error() << e.what() << endmsg;
+        return StatusCode::FAILURE;
+      }
+      return StatusCode::SUCCESS;
+    }
+
+    StatusCode finalize() override {
+      if (m_format && m_format->nUncalibrated() > 0) {
+        warning() << m_format->nUncalibrated()
+                  << " track states were read without their calibrated measurement" << endmsg;
+      }
+      m_format.reset();
+      m_file.reset();
+      return GaudiAlgorithm::finalize();
+    }
+  };
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+  DECLARE_COMPONENT(TrackingEventInput)
+
+} // namespace Jug::Reco
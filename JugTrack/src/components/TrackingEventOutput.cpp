@@ -0,0 +1,146 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Whitney Armstrong, Wouter Deconinck
+
+#include <list>
+#include <memory>
+#include <stdexcept>
+
+// Gaudi
+#include "GaudiAlg/GaudiAlgorithm.h"
+#include "Gaudi/Property.h"
+
+#include "JugBase/DataHandle.h"
+#include "JugBase/IShardingSvc.h"
+#include "JugTrack/IndexSourceLink.hpp"
+#include "JugTrack/Measurement.hpp"
+#include "JugTrack/Track.hpp"
+#include "JugTrack/Trajectories.hpp"
+
+#include "TrackingEventFormat.h"
+
+#include "TFile.h"
+#include "TList.h"
+#include "TParameter.h"
+#include "TTree.h"
+
+namespace Jug::Reco {
+
+  /** Write the transient ACTS tracking data (source links, measurements, trajectories and
+   *  track parameters) to a ROOT file, next to the PodioOutput, so the downstream algorithms
+   *  can be rerun from it with TrackingEventInput instead of rerunning the track finding.
+   *  See TrackingEventFormat for the layout.
+   *
+   * \ingroup tracking
+   */
+  class TrackingEventOutput : public GaudiAlgorithm {
+  private:
+    Gaudi::Property<std::string> m_filename{this, "filename", "tracking.root", "Name of the file to create"};
+    Gaudi::Property<std::string> m_sourceLinkStorage{
+        this, "sourceLinkStorage", "", "Source link storage (std::list<IndexSourceLink>) to write"};
+    Gaudi::Property<std::string> m_measurements{this, "measurements", "", "Measurements to write"};
+    Gaudi::Property<std::vector<std::string>> m_trajectories{this, "trajectories", {}, "Trajectories to write"};
+    Gaudi::Property<std::vector<std::string>> m_trackParameters{
+        this, "trackParameters", {}, "Track parameters to write"};
+
+    std::unique_ptr<DataHandle<std::list<IndexSourceLink>>> m_sourceLinkHandle;
+    std::unique_ptr<DataHandle<MeasurementContainer>> m_measurementHandle;
+    std::vector<std::unique_ptr<DataHandle<TrajectoriesContainer>>> m_trajectoryHandles;
+    std::vector<std::unique_ptr<DataHandle<TrackParametersContainer>>> m_trackParameterHandles;
+
+    std::unique_ptr<TFile> m_file;
+    /// Owned by the file
+    TTree* m_tree{nullptr};
+    std::unique_ptr<TrackingEventFormat> m_format;
+
+  public:
+    TrackingEventOutput(const std::string& name, ISvcLocator* svcLoc) : GaudiAlgorithm(name, svcLoc) {}
+
+    StatusCode initialize() override {
+      if (GaudiAlgorithm::initialize().isFailure()) {
+        return StatusCode::FAILURE;
+      }
+      if (!m_trajectories.value().empty() && m_measurements.value().empty()) {
+        warning() << "Measurements are not written, the track states will be read back without "
+                  << "their calibrated measurements" << endmsg;
+      }
+      if (!m_measurements.value().empty() && m_sourceLinkStorage.value().empty()) {
+        error() << "Measurements can only be written together with their sourceLinkStorage" << endmsg;
+        return StatusCode::FAILURE;
+      }
+      if (!m_sourceLinkStorage.value().empty()) {
+        m_sourceLinkHandle = std::make_unique<DataHandle<std::list<IndexSourceLink>>>(
+            m_sourceLinkStorage, Gaudi::DataHandle::Reader, this);
+      }
+      if (!m_measurements.value().empty()) {
+        m_measurementHandle =
+            std::make_unique<DataHandle<MeasurementContainer>>(m_measurements, Gaudi::DataHandle::Reader, this);
+      }
+      for (const auto& name : m_trajectories) {
+        m_trajectoryHandles.push_back(
+            std::make_unique<DataHandle<TrajectoriesContainer>>(name, Gaudi::DataHandle::Reader, this));
+      }
+      for (const auto& name : m_trackParameters) {
+        m_trackParameterHandles.push_back(
+            std::make_unique<DataHandle<TrackParametersContainer>>(name, Gaudi::DataHandle::Reader, this));
+      }
+
+      std::string filename = m_filename;
+      if (auto shardingSvc = service<IShardingSvc>("ShardingSvc", false, true)) {
+        filename = shardingSvc->outputFile(m_filename);
+      }
+      m_file = std::unique_ptr<TFile>(TFile::Open(filename.c_str(), "RECREATE", "tracking data file"));
+      if (!m_file || m_file->IsZombie()) {
+        error() << "Unable to create " << filename << endmsg;
+        return StatusCode::FAILURE;
+      }
+      m_tree = new TTree("tracking", "ACTS tracking event data");
+      m_tree->GetUserInfo()->Add(new TParameter<int>("version", TrackingEventFormat::kVersion));
+      m_format = std::make_unique<TrackingEventFormat>(
+          m_tree, true,
+          TrackingEventFormat::Names{m_sourceLinkStorage, m_measurements, m_trajectories, m_trackParameters});
+      return StatusCode::SUCCESS;
+    }
+
+    StatusCode execute() override {
+      m_format->clear();
+      try {
+        if (m_sourceLinkHandle) {
+          m_format->addSourceLinks(*m_sourceLinkHandle->get());
+        }
+        if (m_measurementHandle) {
+          m_format->addMeasurements(*m_measurementHandle->get());
+        }
+        for (size_t i = 0; i < m_trajectoryHandles.size(); ++i) {
+          m_format->addTrajectories(i, *m_trajectoryHandles[i]->get());
+        }
+        for (size_t i = 0; i < m_trackParameterHandles.size(); ++i) {
+          m_format->addTrackParameters(i, *m_trackParameterHandles[i]->get());
+        }
+      } catch (const std::runtime_error& e) {
+        error() << e.what() << endmsg;
+        return StatusCode::FAILURE;
+      }
+      if (m_tree->Fill() < 0) {
+        error() << "Failed to fill the tracking tree" << endmsg;
+        return StatusCode::FAILURE;
+      }
+      return StatusCode::SUCCESS;
+    }
+
+    StatusCode finalize() override {
+      if (m_file) {
+        m_file->cd();
+        m_tree->Write();
+        info() << "Wrote " << m_tree->GetEntries() << " events (" << m_tree->GetZipBytes() / 1e6
+               << " MB) to " << m_file->GetName() << endmsg;
+        m_file->Close();
+        m_format.reset();
+        m_file.reset();
+      }
+      return GaudiAlgorithm::finalize();
+    }
+  };
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+  DECLARE_COMPONENT(TrackingEventOutput)
+
+} // namespace Jug::Reco
@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Sylvester Joosten
+//
+// Scaling of the hit grouping of the island clustering with the number of hits, for the grid
+// search of groupHits and the pairwise checks it replaces, on synthetic high occupancy events.
+//
+#include <benchmark/benchmark.h>
+
+#include "CalorimeterHitGroupsReference.h"
+
+using namespace algorithms::calorimetry;
+
+namespace {
+
+NeighbourConfig config() {
+  NeighbourConfig config;
+  config.dist       = {1.8, 1.8};
+  config.dimScaled  = true;
+  config.sectorDist = 50.;
+  config.minHitEdep = 0.001;
+  return config;
+}
+
+template <class GroupHits> void groupingBenchmark(benchmark::State& state, GroupHits group) {
+  const auto hits   = test::syntheticHits(state.range(0), 1);
+  const auto neighb = config();
+  std::vector<HitEdge> edges;
+  for (auto _ : state) {
+    edges.clear();
+    benchmark::DoNotOptimize(group(hits, neighb, edges));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetComplexityN(state.range(0));
+}
+
+} // namespace
+
+static void BM_GroupHits(benchmark::State& state) { groupingBenchmark(state, groupHits); }
+BENCHMARK(BM_GroupHits)->RangeMultiplier(10)->Range(100, 100000)->Complexity();
+
+// O(N^2), so only up to 10^4 hits
+static void BM_PairwiseGroupHits(benchmark::State& state) {
+  groupingBenchmark(state, test::pairwiseGroupHits);
+}
+BENCHMARK(BM_PairwiseGroupHits)->RangeMultiplier(10)->Range(100, 10000)->Complexity();
+
+BENCHMARK_MAIN();
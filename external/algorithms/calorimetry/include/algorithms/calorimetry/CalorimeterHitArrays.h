@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Sylvester Joosten, Chao Peng, Whitney Armstrong
+//
+// Calorimeter hits staged into contiguous arrays, and the distance kernels of the pairwise
+// (neighbour) loops of the clustering algorithms working on them.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <edm4eic/CalorimeterHitCollection.h>
+
+namespace algorithms::calorimetry {
+
+/** The hits of a CalorimeterHitCollection as a struct of arrays.
+ *
+ *  Element i of every array belongs to hit i of the collection. The hits are staged once per
+ *  event, so the pairwise loops of the clustering algorithms read contiguous floats instead of
+ *  going through the podio accessors, and r, eta and phi of the global position are only
+ *  computed once per hit.
+ */
+struct CalorimeterHitArrays {
+  std::vector<float> energy;
+  /// global position
+  std::vector<float> x, y, z;
+  /// local position
+  std::vector<float> localX, localY, localZ;
+  std::vector<float> dimX, dimY, dimZ;
+  /// magnitude, pseudorapidity and azimuthal angle of the global position
+  std::vector<float> r, eta, phi;
+  std::vector<int32_t> sector, layer;
+
+  CalorimeterHitArrays() = default;
+  explicit CalorimeterHitArrays(const edm4eic::CalorimeterHitCollection& hits) { stage(hits); }
+
+  /// Fill with the hits of a collection (keeps the capacity, e.g. for the next event)
+  void stage(const edm4eic::CalorimeterHitCollection& hits);
+  size_t size() const { return energy.size(); }
+};
+
+/// out[k] = in[order[k]], e.g. to have the hits of a grid cell next to each other
+template <class T>
+void gather(const std::vector<T>& in, const std::vector<uint32_t>& order, std::vector<T>& out) {
+  out.resize(order.size());
+  for (size_t k = 0; k < order.size(); ++k) {
+    out[k] = in[order[k]];
+  }
+}
+
+// Distance kernels: straight loops over n contiguous elements, without branches, so the
+// compiler vectorizes them. The results are written to mask (0 or 1) or out, for elements k < n.
+
+/// mask[k] = |a[k] - a0| <= da && |b[k] - b0| <= db
+void withinBox(const float* a, const float* b, size_t n, float a0, float b0, float da, float db,
+               uint8_t* mask);
+
+/** As withinBox, with the differences scaled by the mean size of the two hits:
+ *  mask[k] = 2 |a[k] - a0| / (sa[k] + sa0) <= da && 2 |b[k] - b0| / (sb[k] + sb0) <= db
+ */
+void withinScaledBox(const float* a, const float* b, const float* sa, const float* sb, size_t n,
+                     float a0, float b0, float sa0, float sb0, float da, float db, uint8_t* mask);
+
+/// out[k] = squared distance between (x[k], y[k], z[k]) and (x0, y0, z0)
+void distance2(const float* x, const float* y, const float* z, size_t n, float x0, float y0,
+               float z0, float* out);
+
+/** Logarithms of the weights of the hits for splitting a group between its local maxima, for a
+ *  maximum at (a0, b0) with energy exp(logE0): out[k] = logE0 - |(a[k] - a0, b[k] - b0)| / ref
+ */
+void splitLogWeights(const float* a, const float* b, size_t n, float a0, float b0, float ref,
+                     float logE0, float* out);
+
+/// As splitLogWeights, with the differences scaled as in withinScaledBox
+void scaledSplitLogWeights(const float* a, const float* b, const float* sa, const float* sb,
+                           size_t n, float a0, float b0, float sa0, float sb0, float ref,
+                           float logE0, float* out);
+
+/** Turn the log weights of n hits for m maxima (of hit i for maximum k at w[k * n + i]) into
+ *  weights normalized per hit, exp(w - max_k w) / sum_k exp(w - max_k w). Relative to the
+ *  largest weight of the hit, so they cannot all underflow to 0 far from all maxima.
+ */
+void normalizeSplitWeights(float* w, size_t n, size_t m);
+
+} // namespace algorithms::calorimetry
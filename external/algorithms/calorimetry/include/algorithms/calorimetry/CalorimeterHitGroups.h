@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Sylvester Joosten, Chao Peng
+//
+// Grouping of neighbouring calorimeter hits (the first step of the island clustering), with a
+// neighbour search over a grid instead of all pairs of hits.
+//
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <algorithms/calorimetry/CalorimeterHitArrays.h>
+
+namespace algorithms::calorimetry {
+
+/// The two (staged) coordinates the neighbour distances are differences of
+using HitCoordinates = std::array<std::vector<float> CalorimeterHitArrays::*, 2>;
+
+/** When two hits are neighbours.
+ *
+ *  Hits of the same sector are neighbours if their differences in both coordinates are within
+ *  dist (withinBox), or with dimScaled the differences scaled by the mean dimension of the two
+ *  hits (withinScaledBox, over localX/localY and dimX/dimY). Hits of different sectors are
+ *  neighbours if their global positions are within sectorDist. Hits with less than minHitEdep
+ *  are in no group.
+ */
+struct NeighbourConfig {
+  HitCoordinates coordinates{&CalorimeterHitArrays::localX, &CalorimeterHitArrays::localY};
+  std::array<double, 2> dist{0., 0.};
+  bool dimScaled{false};
+  double sectorDist{0.};
+  double minHitEdep{0.};
+};
+
+/// A pair of neighbouring hits (i < j)
+using HitEdge = std::pair<uint32_t, uint32_t>;
+
+/** Group the neighbouring hits (the connected components, with union-find).
+ *
+ *  Neighbours are only searched for in the adjacent cells of a grid, over the coordinates
+ *  within a sector, and over the global position between sectors, so the cost grows with the
+ *  number of hits times the occupancy of a cell instead of the number of pairs. The groups are
+ *  ordered by their first hit, the hits of a group in increasing order.
+ *
+ *  Every pair of neighbours found is added to edges (once, in no particular order).
+ */
+std::vector<std::vector<uint32_t>> groupHits(const CalorimeterHitArrays& hits,
+                                             const NeighbourConfig& config,
+                                             std::vector<HitEdge>& edges);
+
+} // namespace algorithms::calorimetry
@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Chao Peng, Sylvester Joosten
+//
+// Grouping of neighbouring hits of an imaging calorimeter (the topological clustering), with a
+// neighbour search over per-layer grids instead of all pairs of hits.
+//
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <algorithms/calorimetry/CalorimeterHitArrays.h>
+
+namespace algorithms::calorimetry {
+
+/** When two hits of an imaging calorimeter are neighbours.
+ *
+ *  Hits of different sectors are neighbours if their global positions are within sectorDist.
+ *  Hits of the same sector and layer are neighbours if their local (x, y) differences are within
+ *  localDistXY, hits of the same sector in layers at most neighbourLayersRange apart if their
+ *  global (eta, phi) differences are within layerDistEtaPhi. Hits with less than minHitEdep are
+ *  in no group, only hits with at least minCenterEdep start one.
+ */
+struct ImagingNeighbourConfig {
+  int neighbourLayersRange{1};
+  std::array<double, 2> localDistXY{0., 0.};
+  std::array<double, 2> layerDistEtaPhi{0., 0.};
+  double sectorDist{0.};
+  double minHitEdep{0.};
+  double minCenterEdep{0.};
+};
+
+/** Group the neighbouring hits with a depth-first search from every hit that starts a group.
+ *
+ *  The neighbours are only searched for in the adjacent cells of grids over the local (x, y) of
+ *  a layer, the global (eta, phi) of a layer and the global position. They are checked with the
+ *  arithmetic of the pairwise ImagingTopoCluster, in double precision with eta computed from the
+ *  position, and visited in increasing order. So the groups, in order of their first hit, and
+ *  the order of the hits in a group (the visiting order) are the same as with the pairwise
+ *  search.
+ */
+std::vector<std::vector<uint32_t>> groupImagingHits(const CalorimeterHitArrays& hits,
+                                                    const ImagingNeighbourConfig& config);
+
+} // namespace algorithms::calorimetry
@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Sylvester Joosten, Chao Peng, Whitney Armstrong
+
+#include <algorithms/calorimetry/CalorimeterHitArrays.h>
+
+#include <cmath>
+
+#include "edm4eic/vector_utils.h"
+
+namespace algorithms::calorimetry {
+
+void CalorimeterHitArrays::stage(const edm4eic::CalorimeterHitCollection& hits) {
+  const size_t n = hits.size();
+  for (auto* v : {&energy, &x, &y, &z, &localX, &localY, &localZ, &dimX, &dimY, &dimZ, &r, &eta,
+                  &phi}) {
+    v->resize(n);
+  }
+  sector.resize(n);
+  layer.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    const auto hit   = hits[i];
+    const auto& pos  = hit.getPosition();
+    const auto& loc  = hit.getLocal();
+    const auto& dim  = hit.getDimension();
+    energy[i]        = hit.getEnergy();
+    x[i]             = pos.x;
+    y[i]             = pos.y;
+    z[i]             = pos.z;
+    localX[i]        = loc.x;
+    localY[i]        = loc.y;
+    localZ[i]        = loc.z;
+    dimX[i]          = dim.x;
+    dimY[i]          = dim.y;
+    dimZ[i]          = dim.z;
+    r[i]             = edm4eic::magnitude(pos);
+    eta[i]           = edm4eic::eta(pos);
+    phi[i]           = edm4eic::angleAzimuthal(pos);
+    sector[i]        = hit.getSector();
+    layer[i]         = hit.getLayer();
+  }
+}
+
+void withinBox(const float* a, const float* b, const size_t n, const float a0, const float b0,
+               const float da, const float db, uint8_t* mask) {
+  for (size_t k = 0; k < n; ++k) {
+    mask[k] = static_cast<uint8_t>((std::abs(a[k] - a0) <= da) & (std::abs(b[k] - b0) <= db));
+  }
+}
+
+void withinScaledBox(const float* a, const float* b, const float* sa, const float* sb,
+                     const size_t n, const float a0, const float b0, const float sa0,
+                     const float sb0, const float da, const float db, uint8_t* mask) {
+  for (size_t k = 0; k < n; ++k) {
+    const float ra = 2 * std::abs(a[k] - a0) / (sa[k] + sa0);
+    const float rb = 2 * std::abs(b[k] - b0) / (sb[k] + sb0);
+    mask[k]        = static_cast<uint8_t>((ra <= da) & (rb <= db));
+  }
+}
+
+void distance2(const float* x, const float* y, const float* z, const size_t n, const float x0,
+               const float y0, const float z0, float* out) {
+  for (size_t k = 0; k < n; ++k) {
+    const float dx = x[k] - x0;
+    const float dy = y[k] - y0;
+    const float dz = z[k] - z0;
+    out[k]         = dx * dx + dy * dy + dz * dz;
+  }
+}
+
+} // namespace algorithms::calorimetry
@@ -0,0 +1,202 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Sylvester Joosten, Chao Peng
+
+#include <algorithms/calorimetry/CalorimeterHitGroups.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <tuple>
+
+namespace algorithms::calorimetry {
+
+namespace {
+
+// a cell of the neighbour search grid, e.g. (sector, bin, bin)
+using GridCell = std::array<int64_t, 3>;
+
+// call adjacent(k, first, last) for every entry k of the (sorted) cells, with the entries
+// [first, last) of the same and adjacent cells, where the cells need to match exactly in the
+// coordinates before firstBinned (e.g. the sector). The cells are searched once per distinct
+// cell, and per row: the adjacent bins in the last coordinate are next to each other in the
+// sorted cells.
+template <class F>
+void forAdjacentCells(const std::vector<std::pair<GridCell, uint32_t>>& cells,
+                      const size_t firstBinned, F&& adjacent) {
+  constexpr size_t lastDim = std::tuple_size_v<GridCell> - 1;
+  const auto byCell        = [](const auto& c1, const auto& c2) { return c1.first < c2.first; };
+  for (size_t begin = 0, end = 0; begin < cells.size(); begin = end) {
+    const auto& cell = cells[begin].first;
+    while (end < cells.size() && cells[end].first == cell) {
+      ++end;
+    }
+    for (int offset = 0; offset < 9; ++offset) {
+      GridCell low = cell;
+      bool skip    = false;
+      for (size_t d = 0, o = offset; d < lastDim; ++d, o /= 3) {
+        const int delta = static_cast<int>(o % 3) - 1;
+        skip            = skip || (d < firstBinned && delta != 0);
+        low[d] += delta;
+      }
+      if (skip) {
+        continue;
+      }
+      GridCell high = low;
+      low[lastDim] -= 1;
+      high[lastDim] += 1;
+      const auto first =
+          std::lower_bound(cells.begin(), cells.end(), std::make_pair(low, 0U), byCell);
+      const auto last = std::upper_bound(first, cells.end(), std::make_pair(high, 0U), byCell);
+      if (first == last) {
+        continue;
+      }
+      for (size_t k = begin; k < end; ++k) {
+        adjacent(k, first - cells.begin(), last - cells.begin());
+      }
+    }
+  }
+}
+
+// the hit indices in cell order
+std::vector<uint32_t> cellOrder(const std::vector<std::pair<GridCell, uint32_t>>& cells) {
+  std::vector<uint32_t> order(cells.size());
+  std::transform(cells.begin(), cells.end(), order.begin(), [](const auto& c) { return c.second; });
+  return order;
+}
+
+} // namespace
+
+std::vector<std::vector<uint32_t>> groupHits(const CalorimeterHitArrays& hits,
+                                             const NeighbourConfig& config,
+                                             std::vector<HitEdge>& edges) {
+  std::vector<uint32_t> parent(hits.size());
+  std::iota(parent.begin(), parent.end(), 0U);
+  const auto find = [&parent](uint32_t i) {
+    while (parent[i] != i) {
+      i = parent[i] = parent[parent[i]];
+    }
+    return i;
+  };
+  // the root is the first hit of the group
+  const auto unite = [&parent, &find](uint32_t i, uint32_t j) {
+    i                      = find(i);
+    j                      = find(j);
+    parent[std::max(i, j)] = std::min(i, j);
+  };
+
+  // not qualified hits do not participate in clustering
+  std::vector<uint32_t> qualified;
+  for (uint32_t i = 0; i < hits.size(); ++i) {
+    if (hits.energy[i] >= config.minHitEdep) {
+      qualified.push_back(i);
+    }
+  }
+
+  // grid cells (a bit) larger than the neighbour distances, so neighbours are in adjacent
+  // cells, also with the rounding of the float distances
+  const auto& [coordA, coordB] = config.coordinates;
+  const auto& ua               = hits.*coordA;
+  const auto& ub               = hits.*coordB;
+  std::array<double, 2> width  = config.dist;
+  if (config.dimScaled) {
+    // 2 * |dx| / (dimx1 + dimx2) <= dist  =>  |dx| <= dist * max(dimx)
+    std::array<double, 2> maxDim = {0., 0.};
+    for (const auto i : qualified) {
+      maxDim[0] = std::max<double>(maxDim[0], hits.dimX[i]);
+      maxDim[1] = std::max<double>(maxDim[1], hits.dimY[i]);
+    }
+    width = {width[0] * maxDim[0], width[1] * maxDim[1]};
+  }
+  const auto bin = [](const double x, const double w) {
+    return static_cast<int64_t>(std::floor(x / (w > 0. ? 1.001 * w : 1.)));
+  };
+
+  std::vector<std::pair<GridCell, uint32_t>> cells;
+  bool multipleSectors = false;
+  for (const auto i : qualified) {
+    multipleSectors = multipleSectors || hits.sector[i] != hits.sector[qualified.front()];
+    // never within the distances
+    if (!std::isfinite(ua[i]) || !std::isfinite(ub[i])) {
+      continue;
+    }
+    cells.push_back({{hits.sector[i], bin(ua[i], width[0]), bin(ub[i], width[1])}, i});
+  }
+  std::sort(cells.begin(), cells.end());
+  auto order = cellOrder(cells);
+
+  // the hits gathered in cell order, so the distances to the hits of a cell are one kernel call
+  std::vector<float> sa, sb, sdimA, sdimB;
+  gather(ua, order, sa);
+  gather(ub, order, sb);
+  if (config.dimScaled) {
+    gather(hits.dimX, order, sdimA);
+    gather(hits.dimY, order, sdimB);
+  }
+  const auto da = static_cast<float>(config.dist[0]);
+  const auto db = static_cast<float>(config.dist[1]);
+  std::vector<uint8_t> mask;
+  forAdjacentCells(cells, 1, [&](const size_t k, const size_t first, const size_t last) {
+    const size_t n = last - first;
+    mask.resize(n);
+    if (config.dimScaled) {
+      withinScaledBox(&sa[first], &sb[first], &sdimA[first], &sdimB[first], n, sa[k], sb[k],
+                      sdimA[k], sdimB[k], da, db, mask.data());
+    } else {
+      withinBox(&sa[first], &sb[first], n, sa[k], sb[k], da, db, mask.data());
+    }
+    for (size_t m = 0; m < n; ++m) {
+      if (mask[m] != 0 && order[first + m] > order[k]) {
+        unite(order[k], order[first + m]);
+        edges.emplace_back(order[k], order[first + m]);
+      }
+    }
+  });
+
+  if (multipleSectors) {
+    const double sectorDist = config.sectorDist;
+    cells.clear();
+    for (const auto i : qualified) {
+      if (!std::isfinite(hits.x[i]) || !std::isfinite(hits.y[i]) || !std::isfinite(hits.z[i])) {
+        continue;
+      }
+      cells.push_back(
+          {{bin(hits.x[i], sectorDist), bin(hits.y[i], sectorDist), bin(hits.z[i], sectorDist)},
+           i});
+    }
+    std::sort(cells.begin(), cells.end());
+    order = cellOrder(cells);
+
+    std::vector<float> sx, sy, sz, d2;
+    std::vector<int32_t> ssector;
+    gather(hits.x, order, sx);
+    gather(hits.y, order, sy);
+    gather(hits.z, order, sz);
+    gather(hits.sector, order, ssector);
+    const auto maxDist2 = static_cast<float>(sectorDist * sectorDist);
+    forAdjacentCells(cells, 0, [&](const size_t k, const size_t first, const size_t last) {
+      const size_t n = last - first;
+      d2.resize(n);
+      distance2(&sx[first], &sy[first], &sz[first], n, sx[k], sy[k], sz[k], d2.data());
+      for (size_t m = 0; m < n; ++m) {
+        if (d2[m] <= maxDist2 && ssector[first + m] != ssector[k] && order[first + m] > order[k]) {
+          unite(order[k], order[first + m]);
+          edges.emplace_back(order[k], order[first + m]);
+        }
+      }
+    });
+  }
+
+  std::vector<std::vector<uint32_t>> groups;
+  std::vector<size_t> groupIndex(hits.size());
+  for (const auto i : qualified) {
+    const auto root = find(i);
+    if (root == i) {
+      groupIndex[i] = groups.size();
+      groups.emplace_back();
+    }
+    groups[groupIndex[root]].push_back(i);
+  }
+  return groups;
+}
+
+} // namespace algorithms::calorimetry
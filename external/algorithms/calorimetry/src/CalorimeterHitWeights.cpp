@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Sylvester Joosten, Chao Peng, Whitney Armstrong
+
+// Built with -ffast-math, so the exponentials are vectorized (with the vector math library of
+// glibc), keep the other kernels out of this file: they rely on comparisons with NaN. The
+// inputs need to be finite.
+#include <algorithms/calorimetry/CalorimeterHitArrays.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace algorithms::calorimetry {
+
+void splitLogWeights(const float* a, const float* b, const size_t n, const float a0,
+                     const float b0, const float ref, const float logE0, float* out) {
+  for (size_t k = 0; k < n; ++k) {
+    const float da = a[k] - a0;
+    const float db = b[k] - b0;
+    out[k]         = logE0 - std::sqrt(da * da + db * db) / ref;
+  }
+}
+
+void scaledSplitLogWeights(const float* a, const float* b, const float* sa, const float* sb,
+                           const size_t n, const float a0, const float b0, const float sa0,
+                           const float sb0, const float ref, const float logE0, float* out) {
+  for (size_t k = 0; k < n; ++k) {
+    const float da = 2 * (a[k] - a0) / (sa[k] + sa0);
+    const float db = 2 * (b[k] - b0) / (sb[k] + sb0);
+    out[k]         = logE0 - std::sqrt(da * da + db * db) / ref;
+  }
+}
+
+void normalizeSplitWeights(float* w, const size_t n, const size_t m) {
+  std::vector<float> best(w, w + n);
+  for (size_t k = 1; k < m; ++k) {
+    for (size_t i = 0; i < n; ++i) {
+      best[i] = std::max(best[i], w[k * n + i]);
+    }
+  }
+  // the largest weight of a hit is 1 here, so the total is at least 1
+  std::vector<float> total(n, 0.);
+  for (size_t k = 0; k < m; ++k) {
+    for (size_t i = 0; i < n; ++i) {
+      w[k * n + i] = std::exp(w[k * n + i] - best[i]);
+      total[i] += w[k * n + i];
+    }
+  }
+  for (size_t k = 0; k < m; ++k) {
+    for (size_t i = 0; i < n; ++i) {
+      w[k * n + i] /= total[i];
+    }
+  }
+}
+
+} // namespace algorithms::calorimetry
@@ -149,9 +149,7 @@ edm4eic::MutableCluster ClusterRecoCoG::reconstruct(const edm4eic::ProtoCluster&
   cl.setNhits(pcl.hits_size());
 
   // no hits
-  if (aboveDebugThreshold()) {
-    debug() << "hit size = " << pcl.hits_size() << endmsg;
-  }
+  debug("hit size = {}", pcl.hits_size());
   if (pcl.hits_size() == 0) {
     return cl;
   }
@@ -167,9 +165,7 @@ edm4eic::MutableCluster ClusterRecoCoG::reconstruct(const edm4eic::ProtoCluster&
   for (unsigned i = 0; i < pcl.getHits().size(); ++i) {
     const auto& hit   = pcl.getHits()[i];
     const auto weight = pcl.getWeights()[i];
-    if (aboveDebugThreshold()) {
-      debug() << "hit energy = " << hit.getEnergy() << " hit weight: " << weight << endmsg;
-    }
+    debug("hit energy = {} hit weight: {}", hit.getEnergy(), weight);
     auto energy = hit.getEnergy() * weight;
     totalE += energy;
     if (energy > maxE) {
@@ -214,10 +210,8 @@ edm4eic::MutableCluster ClusterRecoCoG::reconstruct(const edm4eic::ProtoCluster&
       const double newR     = edm4eic::magnitude(cl.getPosition());
       const double newPhi   = edm4eic::angleAzimuthal(cl.getPosition());
       cl.setPosition(edm4eic::sphericalToVector(newR, newTheta, newPhi));
-      if (aboveDebugThreshold()) {
-        debug() << "Bound cluster position to contributing hits due to "
-                << (overflow ? "overflow" : "underflow") << endmsg;
-      }
+      debug("Bound cluster position to contributing hits due to {}",
+            overflow ? "overflow" : "underflow");
     }
   }
 
@@ -0,0 +1,223 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Chao Peng, Sylvester Joosten
+
+#include <algorithms/calorimetry/ImagingHitGroups.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+
+#include "edm4eic/vector_utils.h"
+#include "edm4hep/Vector3f.h"
+
+namespace algorithms::calorimetry {
+
+namespace {
+
+// a cell of a neighbour search grid, (sector, layer, bin, bin) or (bin, bin, bin, 0)
+using GridCell = std::array<int64_t, 4>;
+
+// hits binned into grid cells, sorted by cell
+struct HitGrid {
+  std::vector<std::pair<GridCell, uint32_t>> cells;
+
+  // call f(i) for the hits i of a cell
+  template <class F> void forCell(const GridCell& cell, F&& f) const {
+    const auto range = std::equal_range(
+        cells.begin(), cells.end(), std::make_pair(cell, 0U),
+        [](const auto& c1, const auto& c2) { return c1.first < c2.first; });
+    for (auto it = range.first; it != range.second; ++it) {
+      f(it->second);
+    }
+  }
+};
+
+// bin of coordinate x for the distance w, the bins are a bit wider than w so the rounding of the
+// differences can not put two hits within w in bins that are not adjacent
+int64_t bin(const double x, const double w) {
+  return static_cast<int64_t>(std::floor(x / (w > 0. ? 1.001 * w : 1.)));
+}
+
+class ImagingNeighbours {
+public:
+  ImagingNeighbours(const CalorimeterHitArrays& hits, const ImagingNeighbourConfig& config)
+      : m_hits{hits}, m_config{config} {
+    fill();
+  }
+
+  // neighbours of hit idx, in increasing order
+  std::vector<uint32_t> find(const uint32_t idx) const {
+    const auto& hits     = m_hits;
+    const int64_t sector = hits.sector[idx];
+    const int64_t layer  = hits.layer[idx];
+    std::vector<uint32_t> neighbours;
+    const auto check = [&](const uint32_t i) {
+      if (i != idx && areNeighbours(idx, i)) {
+        neighbours.push_back(i);
+      }
+    };
+
+    if (std::isfinite(hits.localX[idx]) && std::isfinite(hits.localY[idx])) {
+      const int64_t bx = bin(hits.localX[idx], m_config.localDistXY[0]);
+      const int64_t by = bin(hits.localY[idx], m_config.localDistXY[1]);
+      for (int offset = 0; offset < 9; ++offset) {
+        m_localGrid.forCell({sector, layer, bx + offset % 3 - 1, by + offset / 3 - 1}, check);
+      }
+    }
+    if (std::isfinite(m_eta[idx]) && std::isfinite(hits.phi[idx])) {
+      const int64_t range = m_config.neighbourLayersRange;
+      const int64_t be    = bin(m_eta[idx], m_config.layerDistEtaPhi[0]);
+      const int64_t bp    = bin(hits.phi[idx], m_config.layerDistEtaPhi[1]);
+      for (int64_t l = std::max<int64_t>(layer - range, m_minLayer);
+           l <= std::min<int64_t>(layer + range, m_maxLayer); ++l) {
+        for (int offset = 0; offset < 9 && l != layer; ++offset) {
+          m_etaPhiGrid.forCell({sector, l, be + offset % 3 - 1, bp + offset / 3 - 1}, check);
+        }
+      }
+    }
+    if (m_multipleSectors && std::isfinite(hits.x[idx]) && std::isfinite(hits.y[idx]) &&
+        std::isfinite(hits.z[idx])) {
+      const int64_t bx = bin(hits.x[idx], m_config.sectorDist);
+      const int64_t by = bin(hits.y[idx], m_config.sectorDist);
+      const int64_t bz = bin(hits.z[idx], m_config.sectorDist);
+      for (int offset = 0; offset < 27; ++offset) {
+        m_globalGrid.forCell(
+            {bx + offset % 3 - 1, by + offset / 3 % 3 - 1, bz + offset / 9 - 1, 0},
+            [&](const uint32_t i) {
+              if (hits.sector[i] != sector) {
+                check(i);
+              }
+            });
+      }
+    }
+    // the grids do not overlap, every neighbour is found once
+    std::sort(neighbours.begin(), neighbours.end());
+    return neighbours;
+  }
+
+private:
+  // the pairwise check, with the float differences of the (float) hit positions and the double
+  // eta of edm4eic::eta compared to the double distances
+  bool areNeighbours(const uint32_t i, const uint32_t j) const {
+    const auto& hits = m_hits;
+    if (hits.sector[i] != hits.sector[j]) {
+      const float dx = hits.x[i] - hits.x[j];
+      const float dy = hits.y[i] - hits.y[j];
+      const float dz = hits.z[i] - hits.z[j];
+      return std::sqrt(dx * dx + dy * dy + dz * dz) <= m_config.sectorDist;
+    }
+    const int ldiff = std::abs(hits.layer[i] - hits.layer[j]);
+    if (ldiff == 0) {
+      return std::abs(hits.localX[i] - hits.localX[j]) <= m_config.localDistXY[0] &&
+             std::abs(hits.localY[i] - hits.localY[j]) <= m_config.localDistXY[1];
+    }
+    if (ldiff <= m_config.neighbourLayersRange) {
+      return std::abs(m_eta[i] - m_eta[j]) <= m_config.layerDistEtaPhi[0] &&
+             std::abs(hits.phi[i] - hits.phi[j]) <= m_config.layerDistEtaPhi[1];
+    }
+    return false;
+  }
+
+  // bin the hits into the grids, cells are (slightly) larger than the distances so the
+  // neighbours of a hit are in the same or adjacent cells:
+  //  - local (x, y) of the same sector and layer
+  //  - global (eta, phi) of the same sector and layer, to look up the neighbour layers
+  //  - global position, if there are hits of different sectors
+  void fill() {
+    const auto& hits = m_hits;
+    m_eta.resize(hits.size());
+    for (uint32_t i = 0; i < hits.size(); ++i) {
+      // not the (float) staged eta, the double of the pairwise check
+      m_eta[i]          = edm4eic::eta(edm4hep::Vector3f{hits.x[i], hits.y[i], hits.z[i]});
+      m_minLayer        = (i == 0) ? hits.layer[i] : std::min(m_minLayer, hits.layer[i]);
+      m_maxLayer        = (i == 0) ? hits.layer[i] : std::max(m_maxLayer, hits.layer[i]);
+      m_multipleSectors = m_multipleSectors || hits.sector[i] != hits.sector[0];
+      // never within the distances
+      if (std::isfinite(hits.localX[i]) && std::isfinite(hits.localY[i])) {
+        m_localGrid.cells.push_back({{hits.sector[i], hits.layer[i],
+                                      bin(hits.localX[i], m_config.localDistXY[0]),
+                                      bin(hits.localY[i], m_config.localDistXY[1])},
+                                     i});
+      }
+      if (std::isfinite(m_eta[i]) && std::isfinite(hits.phi[i])) {
+        m_etaPhiGrid.cells.push_back({{hits.sector[i], hits.layer[i],
+                                       bin(m_eta[i], m_config.layerDistEtaPhi[0]),
+                                       bin(hits.phi[i], m_config.layerDistEtaPhi[1])},
+                                      i});
+      }
+    }
+    std::sort(m_localGrid.cells.begin(), m_localGrid.cells.end());
+    std::sort(m_etaPhiGrid.cells.begin(), m_etaPhiGrid.cells.end());
+
+    if (m_multipleSectors) {
+      for (uint32_t i = 0; i < hits.size(); ++i) {
+        if (std::isfinite(hits.x[i]) && std::isfinite(hits.y[i]) && std::isfinite(hits.z[i])) {
+          m_globalGrid.cells.push_back({{bin(hits.x[i], m_config.sectorDist),
+                                         bin(hits.y[i], m_config.sectorDist),
+                                         bin(hits.z[i], m_config.sectorDist), 0},
+                                        i});
+        }
+      }
+      std::sort(m_globalGrid.cells.begin(), m_globalGrid.cells.end());
+    }
+  }
+
+  const CalorimeterHitArrays& m_hits;
+  const ImagingNeighbourConfig& m_config;
+  std::vector<double> m_eta;
+  HitGrid m_localGrid, m_etaPhiGrid, m_globalGrid;
+  int32_t m_minLayer{0}, m_maxLayer{0};
+  bool m_multipleSectors{false};
+};
+
+} // namespace
+
+std::vector<std::vector<uint32_t>> groupImagingHits(const CalorimeterHitArrays& hits,
+                                                    const ImagingNeighbourConfig& config) {
+  const ImagingNeighbours neighbours{hits, config};
+  std::vector<std::vector<uint32_t>> groups;
+  std::vector<uint8_t> visits(hits.size(), 0);
+
+  // the depth-first search, iterative with a stack of the neighbours still to visit, in the
+  // same order as a recursion
+  struct Frame {
+    std::vector<uint32_t> neighbours;
+    size_t next{0};
+  };
+  std::vector<Frame> stack;
+  const auto visit = [&](const uint32_t i) {
+    visits[i] = 1;
+    // not a qualified hit to participate in clustering, stop here
+    if (hits.energy[i] < config.minHitEdep) {
+      return;
+    }
+    groups.back().push_back(i);
+    stack.push_back({neighbours.find(i), 0});
+  };
+
+  for (uint32_t i = 0; i < hits.size(); ++i) {
+    // already in a group, or not energetic enough to form a cluster
+    if (visits[i] != 0 || hits.energy[i] < config.minCenterEdep) {
+      continue;
+    }
+    groups.emplace_back();
+    visit(i);
+    while (!stack.empty()) {
+      auto& frame = stack.back();
+      // visited (in the meantime)
+      while (frame.next < frame.neighbours.size() && visits[frame.neighbours[frame.next]] != 0) {
+        ++frame.next;
+      }
+      if (frame.next == frame.neighbours.size()) {
+        stack.pop_back();
+        continue;
+      }
+      // invalidates frame
+      visit(frame.neighbours[frame.next++]);
+    }
+  }
+  return groups;
+}
+
+} // namespace algorithms::calorimetry
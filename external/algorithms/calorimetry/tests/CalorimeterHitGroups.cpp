@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Sylvester Joosten
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <limits>
+
+#include "CalorimeterHitGroupsReference.h"
+
+using namespace algorithms::calorimetry;
+
+namespace {
+
+std::vector<HitEdge> sorted(std::vector<HitEdge> edges) {
+  std::sort(edges.begin(), edges.end());
+  return edges;
+}
+
+// the neighbour checks of the clustering methods, in the (unitless) mm and rad
+NeighbourConfig dimScaledLocalXY() {
+  NeighbourConfig config;
+  config.dist       = {1.8, 1.8};
+  config.dimScaled  = true;
+  config.sectorDist = 50.;
+  config.minHitEdep = 0.001;
+  return config;
+}
+NeighbourConfig localXY() {
+  NeighbourConfig config;
+  config.dist       = {25., 25.};
+  config.sectorDist = 50.;
+  config.minHitEdep = 0.001;
+  return config;
+}
+NeighbourConfig globalEtaPhi() {
+  NeighbourConfig config;
+  config.coordinates = {&CalorimeterHitArrays::eta, &CalorimeterHitArrays::phi};
+  config.dist        = {0.01, 0.01};
+  config.sectorDist  = 50.;
+  return config;
+}
+
+} // namespace
+
+TEST_CASE("groupHits matches the pairwise grouping", "[calorimetry]") {
+  const std::vector<std::pair<const char*, NeighbourConfig>> configs{
+      {"dimScaledLocalDistXY", dimScaledLocalXY()},
+      {"localDistXY", localXY()},
+      {"globalDistEtaPhi", globalEtaPhi()}};
+  for (const auto& [name, config] : configs) {
+    for (const size_t n : {1, 10, 100, 1000, 3000}) {
+      for (uint32_t seed = 1; seed <= 3; ++seed) {
+        DYNAMIC_SECTION(name << " with " << n << " hits, seed " << seed) {
+          const auto hits = test::syntheticHits(n, seed);
+          std::vector<HitEdge> edges, refEdges;
+          const auto groups = groupHits(hits, config, edges);
+          CHECK(groups == test::pairwiseGroupHits(hits, config, refEdges));
+          CHECK(sorted(edges) == sorted(refEdges));
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("groupHits puts hits without finite coordinates in their own group", "[calorimetry]") {
+  auto hits         = test::syntheticHits(200, 7);
+  const auto config = localXY();
+  hits.localX[10]   = std::numeric_limits<float>::quiet_NaN();
+  hits.localY[20]   = std::numeric_limits<float>::infinity();
+  hits.x[10]        = std::numeric_limits<float>::quiet_NaN();
+  hits.x[20]        = std::numeric_limits<float>::quiet_NaN();
+  hits.energy[10]   = 1.;
+  hits.energy[20]   = 1.;
+  std::vector<HitEdge> edges, refEdges;
+  const auto groups = groupHits(hits, config, edges);
+  CHECK(groups == test::pairwiseGroupHits(hits, config, refEdges));
+  CHECK(std::count(groups.begin(), groups.end(), std::vector<uint32_t>{10}) == 1);
+  CHECK(std::count(groups.begin(), groups.end(), std::vector<uint32_t>{20}) == 1);
+}
+
+TEST_CASE("groupHits of an empty event", "[calorimetry]") {
+  std::vector<HitEdge> edges;
+  CHECK(groupHits(CalorimeterHitArrays{}, localXY(), edges).empty());
+  CHECK(edges.empty());
+}
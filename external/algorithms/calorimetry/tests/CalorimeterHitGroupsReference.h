@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Sylvester Joosten
+//
+// Synthetic calorimeter events and the pairwise (brute force) grouping, as reference for the
+// grid search of groupHits, shared by its test and benchmark.
+//
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <algorithms/calorimetry/CalorimeterHitArrays.h>
+#include <algorithms/calorimetry/CalorimeterHitGroups.h>
+
+namespace algorithms::calorimetry::test {
+
+/** A high occupancy event of n hits in 4 sectors.
+ *
+ *  The sectors are grids of square cells (cellSize, side by side along x in the global frame,
+ *  gap apart) with about half of the cells hit, at a small random offset from the cell center.
+ *  The energies are exponentially distributed (mean 20 MeV).
+ */
+inline CalorimeterHitArrays syntheticHits(const size_t n, const uint32_t seed,
+                                          const float cellSize = 20., const float gap = 10.) {
+  constexpr size_t nSectors = 4;
+  const auto side = static_cast<size_t>(std::ceil(std::sqrt(2. * n / nSectors)));
+  std::mt19937 gen{seed};
+  std::vector<size_t> cells(nSectors * side * side);
+  std::iota(cells.begin(), cells.end(), 0);
+  std::shuffle(cells.begin(), cells.end(), gen);
+  std::uniform_real_distribution<float> jitter{-0.05F * cellSize, 0.05F * cellSize};
+  std::exponential_distribution<float> energy{1. / 0.02};
+
+  CalorimeterHitArrays hits;
+  for (auto* v : {&hits.energy, &hits.x, &hits.y, &hits.z, &hits.localX, &hits.localY,
+                  &hits.localZ, &hits.dimX, &hits.dimY, &hits.dimZ, &hits.r, &hits.eta,
+                  &hits.phi}) {
+    v->resize(n);
+  }
+  hits.sector.resize(n);
+  hits.layer.assign(n, 0);
+  for (size_t i = 0; i < n; ++i) {
+    const auto sector = cells[i] / (side * side);
+    const auto ix     = cells[i] % (side * side) / side;
+    const auto iy     = cells[i] % side;
+    hits.energy[i]    = energy(gen);
+    hits.localX[i]    = (ix + 0.5F) * cellSize + jitter(gen);
+    hits.localY[i]    = (iy + 0.5F) * cellSize + jitter(gen);
+    hits.localZ[i]    = 0;
+    hits.dimX[i]      = cellSize;
+    hits.dimY[i]      = cellSize;
+    hits.dimZ[i]      = cellSize;
+    hits.x[i]         = sector * (side * cellSize + gap) + hits.localX[i];
+    hits.y[i]         = hits.localY[i];
+    hits.z[i]         = 3000.;
+    hits.r[i]         = std::hypot(hits.x[i], hits.y[i], hits.z[i]);
+    hits.eta[i]       = std::asinh(hits.z[i] / std::hypot(hits.x[i], hits.y[i]));
+    hits.phi[i]       = std::atan2(hits.y[i], hits.x[i]);
+    hits.sector[i]    = static_cast<int32_t>(sector);
+  }
+  return hits;
+}
+
+/// The neighbour check of groupHits for one pair of hits, with the same float arithmetic
+inline bool areNeighbours(const CalorimeterHitArrays& hits, const NeighbourConfig& config,
+                          const uint32_t i, const uint32_t j) {
+  if (hits.sector[i] != hits.sector[j]) {
+    const float dx = hits.x[i] - hits.x[j];
+    const float dy = hits.y[i] - hits.y[j];
+    const float dz = hits.z[i] - hits.z[j];
+    const auto maxDist2 = static_cast<float>(config.sectorDist * config.sectorDist);
+    return dx * dx + dy * dy + dz * dz <= maxDist2;
+  }
+  const auto& [coordA, coordB] = config.coordinates;
+  float da                     = std::abs((hits.*coordA)[i] - (hits.*coordA)[j]);
+  float db                     = std::abs((hits.*coordB)[i] - (hits.*coordB)[j]);
+  if (config.dimScaled) {
+    da = 2 * da / (hits.dimX[i] + hits.dimX[j]);
+    db = 2 * db / (hits.dimY[i] + hits.dimY[j]);
+  }
+  return da <= static_cast<float>(config.dist[0]) && db <= static_cast<float>(config.dist[1]);
+}
+
+/// Group the hits by checking all pairs, same order of the groups and their hits as groupHits
+inline std::vector<std::vector<uint32_t>> pairwiseGroupHits(const CalorimeterHitArrays& hits,
+                                                            const NeighbourConfig& config,
+                                                            std::vector<HitEdge>& edges) {
+  const auto n = static_cast<uint32_t>(hits.size());
+  std::vector<std::vector<uint32_t>> adjacent(n);
+  for (uint32_t i = 0; i < n; ++i) {
+    if (hits.energy[i] < config.minHitEdep) {
+      continue;
+    }
+    for (uint32_t j = i + 1; j < n; ++j) {
+      if (hits.energy[j] >= config.minHitEdep && areNeighbours(hits, config, i, j)) {
+        adjacent[i].push_back(j);
+        adjacent[j].push_back(i);
+        edges.emplace_back(i, j);
+      }
+    }
+  }
+
+  std::vector<std::vector<uint32_t>> groups;
+  std::vector<uint8_t> visited(n, 0);
+  for (uint32_t i = 0; i < n; ++i) {
+    if (visited[i] != 0 || hits.energy[i] < config.minHitEdep) {
+      continue;
+    }
+    auto& group = groups.emplace_back();
+    std::vector<uint32_t> todo{i};
+    visited[i] = 1;
+    while (!todo.empty()) {
+      const auto k = todo.back();
+      todo.pop_back();
+      group.push_back(k);
+      for (const auto j : adjacent[k]) {
+        if (visited[j] == 0) {
+          visited[j] = 1;
+          todo.push_back(j);
+        }
+      }
+    }
+    std::sort(group.begin(), group.end());
+  }
+  return groups;
+}
+
+} // namespace algorithms::calorimetry::test
@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Sylvester Joosten
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <vector>
+
+#include <algorithms/calorimetry/CalorimeterHitArrays.h>
+
+using namespace algorithms::calorimetry;
+
+namespace {
+
+// the normalized split weights of hits at a (with b = 0) for maxima at a0 with energies e0
+std::vector<float> splitWeights(const std::vector<float>& a, const std::vector<float>& a0,
+                                const std::vector<float>& e0, const float ref) {
+  const size_t n = a.size();
+  const std::vector<float> b(n, 0.);
+  std::vector<float> w(a0.size() * n);
+  for (size_t k = 0; k < a0.size(); ++k) {
+    splitLogWeights(a.data(), b.data(), n, a0[k], 0., ref, std::log(e0[k]), &w[k * n]);
+  }
+  normalizeSplitWeights(w.data(), n, a0.size());
+  return w;
+}
+
+} // namespace
+
+TEST_CASE("split weights match the normalized exponentials", "[calorimetry]") {
+  const std::vector<float> a{-30., 0., 12., 25., 40., 55.};
+  const std::vector<float> a0{0., 40.};
+  const std::vector<float> e0{0.5, 0.2};
+  const float ref = 20.;
+  const auto w    = splitWeights(a, a0, e0, ref);
+  for (size_t i = 0; i < a.size(); ++i) {
+    std::vector<double> expected(a0.size());
+    double total = 0.;
+    for (size_t k = 0; k < a0.size(); ++k) {
+      expected[k] = e0[k] * std::exp(-std::abs(a[i] - a0[k]) / ref);
+      total += expected[k];
+    }
+    for (size_t k = 0; k < a0.size(); ++k) {
+      CHECK(w[k * a.size() + i] == Approx(expected[k] / total).epsilon(1e-5));
+    }
+  }
+}
+
+TEST_CASE("split weights far from all maxima", "[calorimetry]") {
+  // exp(-d / ref) underflows for all maxima at these distances
+  const std::vector<float> a{3000., -5000.};
+  const std::vector<float> a0{0., 1000., 2000.};
+  const std::vector<float> e0{0.5, 0.2, 1.};
+  const auto w = splitWeights(a, a0, e0, 20.);
+  for (size_t i = 0; i < a.size(); ++i) {
+    float total = 0.;
+    for (size_t k = 0; k < a0.size(); ++k) {
+      CHECK(std::isfinite(w[k * a.size() + i]));
+      total += w[k * a.size() + i];
+    }
+    CHECK(total == Approx(1.));
+  }
+  // all to the nearest maximum
+  CHECK(w[2 * a.size()] == Approx(1.));
+  CHECK(w[1] == Approx(1.));
+}
@@ -0,0 +1,222 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Chao Peng, Sylvester Joosten
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <random>
+
+#include <algorithms/calorimetry/ImagingHitGroups.h>
+
+#include "edm4eic/vector_utils.h"
+#include "edm4hep/Vector3f.h"
+
+using namespace algorithms::calorimetry;
+
+namespace {
+
+/** An imaging calorimeter event of about n hits in 2 sectors and 12 layers.
+ *
+ *  The sectors are grids of square cells (cellSize, side by side along x, gap apart), the
+ *  layers cellSize apart in z, with a small random offset from the cell centers, so the local,
+ *  (eta, phi) and sector distances of many pairs are close to the thresholds.
+ */
+CalorimeterHitArrays syntheticImagingHits(const size_t n, const uint32_t seed,
+                                          const float cellSize = 10., const float gap = 5.) {
+  constexpr int nSectors = 2;
+  constexpr int nLayers  = 12;
+  const auto side        = static_cast<int>(std::ceil(std::sqrt(2. * n / nSectors / nLayers)));
+  std::mt19937 gen{seed};
+  std::uniform_int_distribution<int> sector{0, nSectors - 1}, layer{0, nLayers - 1};
+  std::uniform_int_distribution<int> cell{0, side - 1};
+  std::uniform_real_distribution<float> jitter{-0.1F * cellSize, 0.1F * cellSize};
+  std::exponential_distribution<float> energy{1. / 0.02};
+
+  CalorimeterHitArrays hits;
+  for (auto* v : {&hits.energy, &hits.x, &hits.y, &hits.z, &hits.localX, &hits.localY,
+                  &hits.localZ, &hits.dimX, &hits.dimY, &hits.dimZ, &hits.r, &hits.eta,
+                  &hits.phi}) {
+    v->resize(n);
+  }
+  hits.sector.resize(n);
+  hits.layer.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    const int s    = sector(gen);
+    const int l    = layer(gen);
+    hits.energy[i] = energy(gen);
+    hits.localX[i] = (cell(gen) + 0.5F) * cellSize + jitter(gen);
+    hits.localY[i] = (cell(gen) + 0.5F) * cellSize + jitter(gen);
+    hits.localZ[i] = 0;
+    hits.dimX[i]   = cellSize;
+    hits.dimY[i]   = cellSize;
+    hits.dimZ[i]   = cellSize;
+    hits.x[i]      = 100.F + s * (side * cellSize + gap) + hits.localX[i];
+    hits.y[i]      = hits.localY[i];
+    hits.z[i]      = 3000.F + l * cellSize + jitter(gen);
+    const edm4hep::Vector3f pos{hits.x[i], hits.y[i], hits.z[i]};
+    hits.r[i]      = edm4eic::magnitude(pos);
+    hits.eta[i]    = edm4eic::eta(pos);
+    hits.phi[i]    = edm4eic::angleAzimuthal(pos);
+    hits.sector[i] = s;
+    hits.layer[i]  = l;
+  }
+  return hits;
+}
+
+// is_neighbor of the pairwise ImagingTopoCluster, on the hit positions
+bool isNeighbour(const CalorimeterHitArrays& hits, const ImagingNeighbourConfig& config,
+                 const uint32_t i, const uint32_t j) {
+  const auto pow2 = [](const auto x) { return x * x; };
+  const edm4hep::Vector3f p1{hits.x[i], hits.y[i], hits.z[i]};
+  const edm4hep::Vector3f p2{hits.x[j], hits.y[j], hits.z[j]};
+  if (hits.sector[i] != hits.sector[j]) {
+    return std::sqrt(pow2(p1.x - p2.x) + pow2(p1.y - p2.y) + pow2(p1.z - p2.z)) <=
+           config.sectorDist;
+  }
+  const int ldiff = std::abs(hits.layer[i] - hits.layer[j]);
+  if (ldiff == 0) {
+    return (std::abs(hits.localX[i] - hits.localX[j]) <= config.localDistXY[0]) &&
+           (std::abs(hits.localY[i] - hits.localY[j]) <= config.localDistXY[1]);
+  } else if (ldiff <= config.neighbourLayersRange) {
+    return (std::abs(edm4eic::eta(p1) - edm4eic::eta(p2)) <= config.layerDistEtaPhi[0]) &&
+           (std::abs(edm4eic::angleAzimuthal(p1) - edm4eic::angleAzimuthal(p2)) <=
+            config.layerDistEtaPhi[1]);
+  }
+  return false;
+}
+
+// dfs_group of the pairwise ImagingTopoCluster
+void pairwiseGroup(const CalorimeterHitArrays& hits, const ImagingNeighbourConfig& config,
+                   std::vector<uint32_t>& group, const uint32_t idx, std::vector<bool>& visits) {
+  if (hits.energy[idx] < config.minHitEdep) {
+    visits[idx] = true;
+    return;
+  }
+  group.push_back(idx);
+  visits[idx] = true;
+  for (uint32_t i = 0; i < hits.size(); ++i) {
+    if (visits[i] || !isNeighbour(hits, config, idx, i)) {
+      continue;
+    }
+    pairwiseGroup(hits, config, group, i, visits);
+  }
+}
+
+std::vector<std::vector<uint32_t>> pairwiseGroupImagingHits(const CalorimeterHitArrays& hits,
+                                                            const ImagingNeighbourConfig& config) {
+  std::vector<bool> visits(hits.size(), false);
+  std::vector<std::vector<uint32_t>> groups;
+  for (uint32_t i = 0; i < hits.size(); ++i) {
+    if (visits[i] || hits.energy[i] < config.minCenterEdep) {
+      continue;
+    }
+    groups.emplace_back();
+    pairwiseGroup(hits, config, groups.back(), i, visits);
+  }
+  return groups;
+}
+
+// the neighbour checks of the imaging clustering, in the (unitless) mm and rad
+ImagingNeighbourConfig config(const int layersRange = 1) {
+  ImagingNeighbourConfig config;
+  config.neighbourLayersRange = layersRange;
+  config.localDistXY          = {10., 10.};
+  config.layerDistEtaPhi      = {0.003, 0.003};
+  config.sectorDist           = 12.;
+  config.minHitEdep           = 0.001;
+  config.minCenterEdep        = 0.01;
+  return config;
+}
+
+} // namespace
+
+TEST_CASE("groupImagingHits matches the pairwise grouping", "[calorimetry]") {
+  for (const int layersRange : {0, 1, 2}) {
+    for (const size_t n : {1, 10, 100, 1000, 3000}) {
+      for (uint32_t seed = 1; seed <= 3; ++seed) {
+        DYNAMIC_SECTION("layers within " << layersRange << " with " << n << " hits, seed "
+                                         << seed) {
+          const auto hits     = syntheticImagingHits(n, seed);
+          const auto neighbor = config(layersRange);
+          // same groups, and hits in the same (visiting) order
+          CHECK(groupImagingHits(hits, neighbor) == pairwiseGroupImagingHits(hits, neighbor));
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("groupImagingHits without a threshold on the hits", "[calorimetry]") {
+  const auto hits        = syntheticImagingHits(1000, 5);
+  auto neighbor          = config();
+  neighbor.minHitEdep    = 0.;
+  neighbor.minCenterEdep = 0.;
+  const auto groups      = groupImagingHits(hits, neighbor);
+  CHECK(groups == pairwiseGroupImagingHits(hits, neighbor));
+  size_t nHits = 0;
+  for (const auto& group : groups) {
+    nHits += group.size();
+  }
+  CHECK(nHits == hits.size());
+}
+
+TEST_CASE("groupImagingHits compares the eta of the positions in double precision",
+          "[calorimetry]") {
+  // two hits in neighbour layers with (double) eta differences within the distance, where the
+  // difference of the etas rounded to float is not
+  const auto neighbor = config();
+  const double dEta   = neighbor.layerDistEtaPhi[0];
+  CalorimeterHitArrays hits;
+  bool found = false;
+  for (float z = 2000.F; z < 2001.F && !found; z = std::nextafter(z, 3000.F)) {
+    const edm4hep::Vector3f p1{2000.F, 0.F, z};
+    const double eta1 = edm4eic::eta(p1);
+    const float z2    = 2000.F * std::sinh(eta1 + dEta);
+    for (int k = -20; k < 20 && !found; ++k) {
+      const edm4hep::Vector3f p2{2000.F, 0.F, z2 + k * 1e-3F};
+      const double eta2 = edm4eic::eta(p2);
+      const auto eta1F  = static_cast<float>(eta1);
+      const auto eta2F  = static_cast<float>(eta2);
+      found = std::abs(eta1 - eta2) <= dEta && std::abs(eta1F - eta2F) > static_cast<float>(dEta);
+      if (found) {
+        hits.energy = {0.1F, 0.1F};
+        hits.x      = {p1.x, p2.x};
+        hits.y      = {p1.y, p2.y};
+        hits.z      = {p1.z, p2.z};
+        hits.localX = {0.F, 100.F};
+        hits.localY = {0.F, 100.F};
+        hits.eta    = {eta1F, eta2F};
+        hits.phi    = {0.F, 0.F};
+        hits.sector = {0, 0};
+        hits.layer  = {0, 1};
+      }
+    }
+  }
+  REQUIRE(found);
+  CHECK(groupImagingHits(hits, neighbor) == std::vector<std::vector<uint32_t>>{{0, 1}});
+  CHECK(pairwiseGroupImagingHits(hits, neighbor) == std::vector<std::vector<uint32_t>>{{0, 1}});
+}
+
+TEST_CASE("groupImagingHits puts hits without finite coordinates in their own group",
+          "[calorimetry]") {
+  auto hits           = syntheticImagingHits(300, 7);
+  const auto neighbor = config();
+  hits.localX[10]     = std::numeric_limits<float>::quiet_NaN();
+  hits.x[10]          = std::numeric_limits<float>::quiet_NaN();
+  hits.localY[20]     = std::numeric_limits<float>::infinity();
+  hits.z[20]          = std::numeric_limits<float>::infinity();
+  hits.energy[10]     = 1.;
+  hits.energy[20]     = 1.;
+  const auto groups   = groupImagingHits(hits, neighbor);
+  CHECK(groups == pairwiseGroupImagingHits(hits, neighbor));
+  CHECK(std::count(groups.begin(), groups.end(), std::vector<uint32_t>{10}) == 1);
+  CHECK(std::count(groups.begin(), groups.end(), std::vector<uint32_t>{20}) == 1);
+}
+
+TEST_CASE("groupImagingHits of an empty event", "[calorimetry]") {
+  CHECK(groupImagingHits(CalorimeterHitArrays{}, config()).empty());
+}
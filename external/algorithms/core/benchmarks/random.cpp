@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Sylvester Joosten
+//
+// Contended gaussian draws: one Generator shared by all threads (a mutex per draw, and the
+// mutex of the shared engine for the cache refills) against a lock-free per-event
+// RandomStream per thread.
+//
+#include <benchmark/benchmark.h>
+
+#include <algorithms/random.h>
+
+using namespace algorithms;
+
+static void BM_GeneratorGaussian(benchmark::State& state) {
+  static const auto gen = RandomSvc::instance().generator("benchGenerator");
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(gen.gaussian(0., 1.));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GeneratorGaussian)->ThreadRange(1, 16)->UseRealTime();
+
+static void BM_StreamGaussian(benchmark::State& state) {
+  static const auto gen = RandomSvc::instance().generator("benchStream");
+  // every thread processes its own event
+  RandomSvc::context({1, static_cast<uint64_t>(state.thread_index())});
+  const auto stream = gen.stream();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(stream.gaussian(0., 1.));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StreamGaussian)->ThreadRange(1, 16)->UseRealTime();
+
+BENCHMARK_MAIN();
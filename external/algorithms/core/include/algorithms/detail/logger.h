@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace algorithms::detail {
+
+// Bounded multi-producer/multi-consumer lock-free ring buffer (after D. Vyukov). Each slot
+// carries a sequence number that tells producers and consumers whether the slot is free or
+// filled for the current lap around the buffer. Capacity is rounded up to a power of 2.
+template <class T> class RingBuffer {
+public:
+  explicit RingBuffer(const size_t capacity)
+      : m_capacity{roundUp(capacity)}
+      , m_mask{m_capacity - 1}
+      , m_slots{std::make_unique<Slot[]>(m_capacity)} {
+    for (size_t i = 0; i < m_capacity; ++i) {
+      m_slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+  RingBuffer(const RingBuffer&) = delete;
+  void operator=(const RingBuffer&) = delete;
+
+  // Returns false (and leaves value untouched) if the buffer is full
+  bool push(T&& value) {
+    size_t pos = m_head.load(std::memory_order_relaxed);
+    while (true) {
+      Slot& slot       = m_slots[pos & m_mask];
+      const size_t seq = slot.seq.load(std::memory_order_acquire);
+      const auto diff  = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          slot.value = std::move(value);
+          slot.seq.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = m_head.load(std::memory_order_relaxed);
+      }
+    }
+  }
+  // Returns false if the buffer is empty
+  bool pop(T& value) {
+    size_t pos = m_tail.load(std::memory_order_relaxed);
+    while (true) {
+      Slot& slot       = m_slots[pos & m_mask];
+      const size_t seq = slot.seq.load(std::memory_order_acquire);
+      const auto diff  = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          value = std::move(slot.value);
+          slot.seq.store(pos + m_capacity, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = m_tail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  size_t capacity() const { return m_capacity; }
+
+private:
+  struct Slot {
+    std::atomic<size_t> seq;
+    T value;
+  };
+  static size_t roundUp(const size_t n) {
+    size_t ret = 2;
+    while (ret < n) {
+      ret <<= 1;
+    }
+    return ret;
+  }
+
+  const size_t m_capacity;
+  const size_t m_mask;
+  std::unique_ptr<Slot[]> m_slots;
+  // keep producer and consumer positions on separate cache lines
+  alignas(64) std::atomic<size_t> m_head{0};
+  alignas(64) std::atomic<size_t> m_tail{0};
+};
+
+} // namespace algorithms::detail
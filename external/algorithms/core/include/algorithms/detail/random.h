@@ -1,14 +1,19 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
 #include <functional>
+#include <gsl/gsl>
+#include <limits>
+#include <string_view>
 #include <vector>
 
 namespace algorithms::detail {
 
 // Auto-refreshing cached sequence from an underlying random engine allowing for multiple instances
 // to be evaluated in parallel. Specs:
-//   - GenFunc is required to return N random numbers between 0 and
+//   - GenFunc is required to fill the provided buffer with random numbers between 0 and
 //     std::numeric_limits<uint_fast64_t>::max()
 //   - GenFunc is responsible to deal with possible simultaneous access by multiple
 //     instances of CachedBitGenerator (required to be thread-safe).
@@ -17,8 +22,9 @@ namespace algorithms::detail {
 //  Implements the uniform_random_bit_generator concept
 class CachedBitGenerator {
 public:
-  using value_type = uint_fast64_t;
-  using GenFunc    = std::function<std::vector<value_type>(size_t /* N */)>;
+  using value_type  = uint_fast64_t;
+  using result_type = value_type;
+  using GenFunc     = std::function<void(gsl::span<value_type> /* buffer */)>;
   CachedBitGenerator(const GenFunc& gen, const size_t cache_size)
       // index starts at the end of the (empty) cache to force an immediate refresh
       // on first access
@@ -31,12 +37,28 @@ public:
     return m_cache[m_index++];
   }
 
+  // Bulk access: first drains the cache, requests that do not fit in the cache are
+  // forwarded to the engine to be written directly into the buffer
+  void fill(gsl::span<value_type> buffer) {
+    const size_t ncached = std::min(buffer.size(), m_cache.size() - m_index);
+    std::copy_n(m_cache.begin() + m_index, ncached, buffer.begin());
+    m_index += ncached;
+    const auto remaining = buffer.subspan(ncached);
+    if (remaining.size() >= m_cache.size()) {
+      m_gen(remaining);
+    } else if (!remaining.empty()) {
+      refresh();
+      std::copy_n(m_cache.begin(), remaining.size(), remaining.begin());
+      m_index = remaining.size();
+    }
+  }
+
   static constexpr value_type min() { return 0; }
   static constexpr value_type max() { return std::numeric_limits<value_type>::max(); }
 
 private:
   void refresh() {
-    m_cache = m_gen(m_cache.size());
+    m_gen(m_cache);
     m_index = 0;
   }
 
@@ -45,4 +67,115 @@ private:
   size_t m_index;
 };
 
+// Philox4x64-10 counter-based bijection (Salmon et al., "Parallel random numbers: as easy
+// as 1, 2, 3", SC11). Maps a 256-bit counter and a 128-bit key onto 256 random bits
+// without any internal state, so any position of any stream can be evaluated
+// independently (and in parallel).
+class Philox4x64 {
+public:
+  using value_type   = uint64_t;
+  using counter_type = std::array<value_type, 4>;
+  using key_type     = std::array<value_type, 2>;
+
+  static constexpr size_t kRounds = 10;
+
+  static counter_type block(counter_type ctr, key_type key) {
+    for (size_t i = 0; i < kRounds; ++i) {
+      if (i > 0) {
+        key[0] += kW0;
+        key[1] += kW1;
+      }
+      ctr = round(ctr, key);
+    }
+    return ctr;
+  }
+
+private:
+  static constexpr value_type kM0 = 0xD2E7470EE14C6C93;
+  static constexpr value_type kM1 = 0xCA5A826395121157;
+  static constexpr value_type kW0 = 0x9E3779B97F4A7C15;
+  static constexpr value_type kW1 = 0xBB67AE8584CAA73B;
+
+  static counter_type round(const counter_type& ctr, const key_type& key) {
+    const unsigned __int128 p0 = static_cast<unsigned __int128>(kM0) * ctr[0];
+    const unsigned __int128 p1 = static_cast<unsigned __int128>(kM1) * ctr[2];
+    const auto hi0             = static_cast<value_type>(p0 >> 64);
+    const auto lo0             = static_cast<value_type>(p0);
+    const auto hi1             = static_cast<value_type>(p1 >> 64);
+    const auto lo1             = static_cast<value_type>(p1);
+    return {hi1 ^ ctr[1] ^ key[0], lo1, hi0 ^ ctr[3] ^ key[1], lo0};
+  }
+};
+
+// Stateless bit generator on top of Philox4x64. The key and the upper three counter words
+// identify the stream, the lowest counter word is the position within the stream.
+// No shared state: instances are cheap to create and never need to be locked, but a single
+// instance should not be used from multiple threads at the same time.
+//  Implements the uniform_random_bit_generator concept
+class CounterBitGenerator {
+public:
+  using value_type   = uint_fast64_t;
+  using result_type  = value_type;
+  using counter_type = Philox4x64::counter_type;
+  using key_type     = Philox4x64::key_type;
+
+  CounterBitGenerator(const key_type& key, const counter_type& ctr)
+      // index starts at the end of the (empty) block to force evaluation on first access
+      : m_key{key}, m_counter{ctr}, m_index{m_block.size()} {}
+
+  value_type operator()() {
+    if (m_index >= m_block.size()) {
+      m_block = Philox4x64::block(m_counter, m_key);
+      ++m_counter[0];
+      m_index = 0;
+    }
+    return m_block[m_index++];
+  }
+
+  // Bulk access: full blocks are written directly into the buffer
+  void fill(gsl::span<value_type> buffer) {
+    size_t n = 0;
+    while (n < buffer.size() && m_index < m_block.size()) {
+      buffer[n++] = m_block[m_index++];
+    }
+    for (; n + m_block.size() <= buffer.size(); n += m_block.size()) {
+      const auto block = Philox4x64::block(m_counter, m_key);
+      ++m_counter[0];
+      std::copy(block.begin(), block.end(), buffer.begin() + n);
+    }
+    while (n < buffer.size()) {
+      buffer[n++] = (*this)();
+    }
+  }
+
+  static constexpr value_type min() { return 0; }
+  static constexpr value_type max() { return std::numeric_limits<value_type>::max(); }
+
+private:
+  const key_type m_key;
+  counter_type m_counter;
+  counter_type m_block{};
+  size_t m_index;
+};
+
+// Map 64 random bits onto a double in [0, 1), using the upper 53 bits
+constexpr double canonical(const uint64_t bits) { return (bits >> 11) * 0x1.0p-53; }
+
+// 64-bit FNV-1a hash, used to turn algorithm names into stable stream keys
+constexpr uint64_t fnv1a(std::string_view s) {
+  uint64_t h = 0xCBF29CE484222325;
+  for (const char c : s) {
+    h ^= static_cast<uint8_t>(c);
+    h *= 0x100000001B3;
+  }
+  return h;
+}
+
+// Lock that does nothing, used for generators that are only ever accessed from a single
+// thread
+struct NullMutex {
+  void lock() {}
+  void unlock() {}
+};
+
 } // namespace algorithms::detail
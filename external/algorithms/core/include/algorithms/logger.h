@@ -5,19 +5,27 @@
 // use ::action(void(LogLevel, std::string_view, std::string_view)) to register
 // a logger.
 //
+// Optionally (property "async"), messages are queued in a lock-free ring buffer and handed
+// to the log action from a background thread, so callers never block on I/O.
+//
 // Also provides the LoggerMixin and LoggedService base classes
 //
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include <ios>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <ostream>
 #include <sstream>
 #include <string>
+#include <thread>
 
+#include <algorithms/detail/logger.h>
 #include <algorithms/error.h>
 #include <algorithms/service.h>
 #include <fmt/format.h>
@@ -54,21 +62,89 @@ constexpr std::string_view logLevelName(LogLevel level) {
 }
 
 // Note: the log action is responsible for dealing with concurrent calls
-//       the default LogAction is a thread-safe example
+//       the default LogAction is a thread-safe example. In async mode the log action is
+//       only ever called from the background thread (or from the calling thread as
+//       fallback when the queue is full).
 class LogSvc : public Service<LogSvc> {
 public:
   using LogAction = std::function<void(LogLevel, std::string_view, std::string_view)>;
   void defaultLevel(const LogLevel l) { m_level.set(detail::upcast_type_t<LogLevel>(l)); }
   LogLevel defaultLevel() const { return m_level; }
   void init() {
-    ; // do nothing by default, as we are already initialized
+    startSink(); // nothing else to do by default, as we are already initialized
+  }
+  void init(LogAction a) {
+    m_action = a;
+    startSink();
   }
-  void init(LogAction a) { m_action = a; }
   void report(const LogLevel l, std::string_view caller, std::string_view msg) const {
+    if (m_running.load(std::memory_order_relaxed)) {
+      // counted, so stop() waits for the reports that still see the sink running
+      const Reporting reporting{m_reporting};
+      if (m_running.load() && m_sink->push({l, std::string(caller), std::string(msg)})) {
+        return;
+      }
+    }
     m_action(l, caller, msg);
   }
+  // Stop the asynchronous sink (if running), after handing all queued messages to the log
+  // action. Should be called by the framework before the log action becomes invalid.
+  void stop() {
+    if (!m_running.exchange(false)) {
+      return;
+    }
+    // a report that saw the sink running may still be pushing, its message would be lost
+    while (m_reporting.load(std::memory_order_acquire) != 0) {
+      std::this_thread::yield();
+    }
+    m_worker.join();
+    drain();
+  }
+  ~LogSvc() { stop(); }
 
 private:
+  struct Entry {
+    LogLevel level;
+    std::string caller;
+    std::string msg;
+  };
+  // number of reports in the section that pushes to the sink
+  class Reporting {
+  public:
+    explicit Reporting(std::atomic<size_t>& count) : m_count{count} { m_count.fetch_add(1); }
+    Reporting(const Reporting&) = delete;
+    void operator=(const Reporting&) = delete;
+    ~Reporting() { m_count.fetch_sub(1, std::memory_order_release); }
+
+  private:
+    std::atomic<size_t>& m_count;
+  };
+
+  void startSink() {
+    if (!m_async || m_running) {
+      return;
+    }
+    m_sink    = std::make_unique<detail::RingBuffer<Entry>>(m_queueSize);
+    m_running = true;
+    m_worker  = std::thread([this]() {
+      while (m_running.load(std::memory_order_acquire)) {
+        if (!drain()) {
+          std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+      }
+    });
+  }
+  // hand all queued messages to the log action, returns false if there was nothing to do
+  bool drain() {
+    Entry e;
+    bool ret = false;
+    while (m_sink->pop(e)) {
+      m_action(e.level, e.caller, e.msg);
+      ret = true;
+    }
+    return ret;
+  }
+
   LogAction makeDefaultAction() {
     return [](const LogLevel l, std::string_view caller, std::string_view msg) {
       static std::mutex m;
@@ -79,8 +155,16 @@ private:
 
   Property<LogLevel> m_level{this, "defaultLevel", LogLevel::kInfo,
                              "Default log level for the LogSvc"};
+  Property<bool> m_async{this, "async", false,
+                         "Queue messages and report them from a background thread"};
+  Property<size_t> m_queueSize{this, "queueSize", 8192, "Message queue size in async mode"};
   LogAction m_action = makeDefaultAction();
 
+  std::unique_ptr<detail::RingBuffer<Entry>> m_sink;
+  std::atomic<bool> m_running{false};
+  mutable std::atomic<size_t> m_reporting{0};
+  std::thread m_worker;
+
   ALGORITHMS_DEFINE_SERVICE(LogSvc)
 };
 
@@ -184,19 +268,48 @@ protected:
   detail::LoggerStream& debug() const { return m_debug; }
   detail::LoggerStream& trace() const { return m_trace; }
 
-  void critical(std::string_view msg) { report<LogLevel::kCritical>(msg); }
-  void error(std::string_view msg) { report<LogLevel::kError>(msg); }
-  void warning(std::string_view msg) { report<LogLevel::kWarning>(msg); }
-  void info(std::string_view msg) { report<LogLevel::kInfo>(msg); }
-  void debug(std::string_view msg) { report<LogLevel::kDebug>(msg); }
-  void trace(std::string_view msg) { report<LogLevel::kTrace>(msg); }
+  void critical(std::string_view msg) const { report<LogLevel::kCritical>(msg); }
+  void error(std::string_view msg) const { report<LogLevel::kError>(msg); }
+  void warning(std::string_view msg) const { report<LogLevel::kWarning>(msg); }
+  void info(std::string_view msg) const { report<LogLevel::kInfo>(msg); }
+  void debug(std::string_view msg) const { report<LogLevel::kDebug>(msg); }
+  void trace(std::string_view msg) const { report<LogLevel::kTrace>(msg); }
 
-  bool aboveCriticalThreshold() const { return m_level >= LogLevel::kCritical; }
-  bool aboveErrorThreshold() const { return m_level >= LogLevel::kError; }
-  bool aboveWarningThreshold() const { return m_level >= LogLevel::kWarning; }
-  bool aboveInfoThreshold() const { return m_level >= LogLevel::kInfo; }
-  bool aboveDebugThreshold() const { return m_level >= LogLevel::kDebug; }
-  bool aboveTraceThreshold() const { return m_level >= LogLevel::kTrace; }
+  // fmt-style logging, e.g. debug("hit {} at {}", id, pos). The level is checked once
+  // and the message is only formatted if it will be reported, so disabled statements
+  // cost no more than an integer compare.
+  template <class Arg, class... Args>
+  void critical(fmt::format_string<Arg, Args...> fmt, Arg&& arg, Args&&... args) const {
+    report<LogLevel::kCritical>(fmt, std::forward<Arg>(arg), std::forward<Args>(args)...);
+  }
+  template <class Arg, class... Args>
+  void error(fmt::format_string<Arg, Args...> fmt, Arg&& arg, Args&&... args) const {
+    report<LogLevel::kError>(fmt, std::forward<Arg>(arg), std::forward<Args>(args)...);
+  }
+  template <class Arg, class... Args>
+  void warning(fmt::format_string<Arg, Args...> fmt, Arg&& arg, Args&&... args) const {
+    report<LogLevel::kWarning>(fmt, std::forward<Arg>(arg), std::forward<Args>(args)...);
+  }
+  template <class Arg, class... Args>
+  void info(fmt::format_string<Arg, Args...> fmt, Arg&& arg, Args&&... args) const {
+    report<LogLevel::kInfo>(fmt, std::forward<Arg>(arg), std::forward<Args>(args)...);
+  }
+  template <class Arg, class... Args>
+  void debug(fmt::format_string<Arg, Args...> fmt, Arg&& arg, Args&&... args) const {
+    report<LogLevel::kDebug>(fmt, std::forward<Arg>(arg), std::forward<Args>(args)...);
+  }
+  template <class Arg, class... Args>
+  void trace(fmt::format_string<Arg, Args...> fmt, Arg&& arg, Args&&... args) const {
+    report<LogLevel::kTrace>(fmt, std::forward<Arg>(arg), std::forward<Args>(args)...);
+  }
+
+  // Is a message at this level going to be reported?
+  bool aboveCriticalThreshold() const { return LogLevel::kCritical >= m_level; }
+  bool aboveErrorThreshold() const { return LogLevel::kError >= m_level; }
+  bool aboveWarningThreshold() const { return LogLevel::kWarning >= m_level; }
+  bool aboveInfoThreshold() const { return LogLevel::kInfo >= m_level; }
+  bool aboveDebugThreshold() const { return LogLevel::kDebug >= m_level; }
+  bool aboveTraceThreshold() const { return LogLevel::kTrace >= m_level; }
 
   // LoggerMixin also provides nice error raising
   // ErrorTypes needs to derive from Error, and needs to have a constructor that takes two
@@ -213,11 +326,17 @@ protected:
   }
 
 private:
-  template <LogLevel l> void report(std::string_view msg) {
+  template <LogLevel l> void report(std::string_view msg) const {
     if (l >= m_level) {
       m_logger.report(l, m_caller, msg);
     }
   }
+  template <LogLevel l, class... Args>
+  void report(fmt::format_string<Args...> fmt, Args&&... args) const {
+    if (l >= m_level) {
+      m_logger.report(l, m_caller, fmt::format(fmt, std::forward<Args>(args)...));
+    }
+  }
 
   const std::string m_caller;
   LogLevel m_level;
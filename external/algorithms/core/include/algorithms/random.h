@@ -1,9 +1,14 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <cstdint>
 #include <functional>
+#include <gsl/gsl>
 #include <mutex>
 #include <random>
+#include <string_view>
 
 #include <algorithms/detail/random.h>
 #include <algorithms/logger.h>
@@ -12,49 +17,151 @@
 namespace algorithms {
 
 // Random Engine callback function:
-//   - Signature: std::function<std::vector<value_type>(size_t N)> --> generates a vector
-//     of N numbers
-//   - RandomEngineCB is required to return N random numbers between 0 and
+//   - Signature: std::function<void(gsl::span<value_type>)> --> fills the buffer with
+//     random numbers
+//   - RandomEngineCB is required to fill the buffer with random numbers between 0 and
 //     std::numeric_limits<uint_fast64_t>::max()
 //   - RandomEngineCB is responsible to deal with possible simultaneous access by multiple
 //     Generator instances (required to be thread-safe).
 using RandomEngineCB = detail::CachedBitGenerator::GenFunc;
 
+namespace detail {
+  // Distribution front-end on top of a uniform random bit generator. All draws are
+  // guarded by Mutex, which can be a NullMutex for generators that are confined to a
+  // single thread.
+  // The fill_* members sample a full buffer at once under a single lock. Raw bits are
+  // staged in fixed-size chunks and transformed in tight loops that write straight into
+  // the caller's buffer.
+  template <class BitGenerator, class Mutex> class BasicGenerator {
+  public:
+    using bits_type = typename BitGenerator::value_type;
+
+    template <class... Args>
+    explicit BasicGenerator(Args&&... args) : m_gen{std::forward<Args>(args)...} {}
+
+    template <class Int = int> Int uniform_int(const Int min, const Int max) const {
+      std::uniform_int_distribution<Int> d{min, max};
+      std::lock_guard<Mutex> lock{m_mutex};
+      return d(m_gen);
+    }
+    template <class Float = double> Float uniform_double(const Float min, const Float max) const {
+      std::uniform_real_distribution<Float> d{min, max};
+      std::lock_guard<Mutex> lock{m_mutex};
+      return d(m_gen);
+    }
+    template <class Int = int> Int poisson(const Int mean) const {
+      std::poisson_distribution<Int> d(mean);
+      std::lock_guard<Mutex> lock{m_mutex};
+      return d(m_gen);
+    }
+    template <class Float = double> Float exponential(const Float lambda) const {
+      std::exponential_distribution<Float> d{lambda};
+      std::lock_guard<Mutex> lock{m_mutex};
+      return d(m_gen);
+    }
+    template <class Float = double> Float gaussian(const Float mu, const Float sigma) const {
+      std::normal_distribution<Float> d{mu, sigma};
+      std::lock_guard<Mutex> lock{m_mutex};
+      return d(m_gen);
+    }
+
+    template <class Float = double>
+    void fill_uniform(gsl::span<Float> out, const Float min, const Float max) const {
+      const double width = max - min;
+      std::array<bits_type, kChunkSize> bits;
+      std::lock_guard<Mutex> lock{m_mutex};
+      for (size_t offset = 0; offset < out.size(); offset += kChunkSize) {
+        const size_t n = std::min(kChunkSize, out.size() - offset);
+        m_gen.fill({bits.data(), n});
+        for (size_t i = 0; i < n; ++i) {
+          out[offset + i] = static_cast<Float>(min + width * canonical(bits[i]));
+        }
+      }
+    }
+    // Box-Muller transform, each pair of uniform numbers yields two gaussian numbers
+    template <class Float = double>
+    void fill_gaussian(gsl::span<Float> out, const Float mu, const Float sigma) const {
+      constexpr double kTwoPi = 2. * M_PI;
+      std::array<bits_type, kChunkSize> bits;
+      std::lock_guard<Mutex> lock{m_mutex};
+      for (size_t offset = 0; offset < out.size(); offset += kChunkSize) {
+        const size_t n      = std::min(kChunkSize, out.size() - offset);
+        const size_t npairs = (n + 1) / 2;
+        m_gen.fill({bits.data(), 2 * npairs});
+        Float* chunk = out.data() + offset;
+        for (size_t i = 0; i < n / 2; ++i) {
+          // 1 - u to avoid log(0)
+          const double r   = std::sqrt(-2. * std::log(1. - canonical(bits[2 * i])));
+          const double phi = kTwoPi * canonical(bits[2 * i + 1]);
+          chunk[2 * i]     = static_cast<Float>(mu + sigma * r * std::cos(phi));
+          chunk[2 * i + 1] = static_cast<Float>(mu + sigma * r * std::sin(phi));
+        }
+        // odd chunk length: the second number of the last pair is discarded
+        if (n % 2) {
+          const double r   = std::sqrt(-2. * std::log(1. - canonical(bits[n - 1])));
+          const double phi = kTwoPi * canonical(bits[n]);
+          chunk[n - 1]     = static_cast<Float>(mu + sigma * r * std::cos(phi));
+        }
+      }
+    }
+    template <class Int = int> void fill_poisson(gsl::span<Int> out, const double mean) const {
+      std::poisson_distribution<Int> d(mean);
+      std::lock_guard<Mutex> lock{m_mutex};
+      for (auto& x : out) {
+        x = d(m_gen);
+      }
+    }
+
+  private:
+    static constexpr size_t kChunkSize = 256;
+
+    mutable BitGenerator m_gen;
+    mutable Mutex m_mutex;
+  };
+} // namespace detail
+
+// Event identification used to key the counter-based random streams. Set by the calling
+// framework for the current thread before an algorithm is executed.
+struct RandomContext {
+  uint64_t run   = 0;
+  uint64_t event = 0;
+};
+namespace detail {
+  inline RandomContext& currentRandomContext() {
+    static thread_local RandomContext ctx;
+    return ctx;
+  }
+} // namespace detail
+
+// Lock-free random stream keyed by (seed, run, event, algorithm, stream index). The
+// sequence only depends on its key, so results are bit-identical independent of the
+// number of threads or events in flight. Meant to be created locally in ::process()
+// (not thread-safe itself).
+using RandomStream = detail::BasicGenerator<detail::CounterBitGenerator, detail::NullMutex>;
+
 // thread-safe generator front-end. Requires that the underlying random engine used by
 // the RandomSvc is thread-safe.
-class Generator {
+// Also acts as factory for the lock-free per-event RandomStreams, which should be
+// preferred in multi-threaded running.
+class Generator : public detail::BasicGenerator<detail::CachedBitGenerator, std::mutex> {
 public:
-  Generator(const RandomEngineCB& gen, const size_t cache_size) : m_gen{gen, cache_size} {}
+  Generator(const RandomEngineCB& gen, const size_t cache_size, const uint64_t& seed,
+            std::string_view name)
+      : BasicGenerator{gen, cache_size}, m_seed{seed}, m_name_key{detail::fnv1a(name)} {}
 
-  template <class Int = int> Int uniform_int(const Int min, const Int max) const {
-    std::uniform_int_distribution<Int> d{min, max};
-    std::lock_guard<std::mutex> lock{m_mutex};
-    return d(m_gen);
-  }
-  template <class Float = double> Float uniform_double(const Float min, const Float max) const {
-    std::uniform_real_distribution<Float> d{min, max};
-    std::lock_guard<std::mutex> lock{m_mutex};
-    return d(m_gen);
-  }
-  template <class Int = int> Int poisson(const Int mean) const {
-    std::poisson_distribution<Int> d{mean};
-    std::lock_guard<std::mutex> lock{m_mutex};
-    return d(m_gen);
-  }
-  template <class Float = double> Float exponential(const Float lambda) const {
-    std::exponential_distribution<Float> d{lambda};
-    std::lock_guard<std::mutex> lock{m_mutex};
-    return d(m_gen);
-  }
-  template <class Float = double> Float gaussian(const Float mu, const Float sigma) const {
-    std::normal_distribution<Float> d{mu, sigma};
-    std::lock_guard<std::mutex> lock{m_mutex};
-    return d(m_gen);
+  // Get the random stream for the current event (as set by RandomSvc::context()). Repeated
+  // calls during the same event return the same sequence, use a different index to get
+  // independent streams.
+  RandomStream stream(const uint64_t index = 0) const {
+    const auto& ctx = detail::currentRandomContext();
+    return RandomStream{detail::CounterBitGenerator::key_type{m_seed, m_name_key},
+                        detail::CounterBitGenerator::counter_type{0, ctx.event, ctx.run, index}};
   }
 
 private:
-  mutable detail::CachedBitGenerator m_gen;
-  mutable std::mutex m_mutex;
+  // reference to the RandomSvc seed, as the seed can still be set after construction
+  const uint64_t& m_seed;
+  const uint64_t m_name_key;
 };
 
 // Random service that creates multiple Generators that are linked to a single random
@@ -65,7 +172,15 @@ class RandomSvc : public LoggedService<RandomSvc> {
 public:
   using value_type = detail::CachedBitGenerator::value_type;
 
-  Generator generator() { return {m_gen, m_cache_size}; }
+  // Name should be unique for each caller (e.g. the algorithm instance name) to get
+  // independent counter-based streams
+  Generator generator(std::string_view name = "") {
+    return {m_gen, m_cache_size, m_stream_seed, name};
+  }
+
+  // Event context for the counter-based streams on the current thread
+  static void context(const RandomContext& ctx) { detail::currentRandomContext() = ctx; }
+  static const RandomContext& context() { return detail::currentRandomContext(); }
 // FIXME fix the CMake setup so these are properly found in Gaudi
 #if 0 
   void init();
@@ -74,7 +189,8 @@ public:
   void init() {
     if (m_seed.hasValue()) {
       info() << "Custom random seed requested: " << m_seed << endmsg;
-      m_gen = createEngine(m_seed);
+      m_gen         = createEngine(m_seed);
+      m_stream_seed = m_seed;
     }
   }
   void init(const RandomEngineCB& gen) {
@@ -91,19 +207,19 @@ private:
   RandomEngineCB createEngine(const size_t seed = 1);
 #endif
   RandomEngineCB createEngine(const size_t seed = 1) {
-    return [=](const size_t size) {
+    return [=](gsl::span<value_type> buffer) {
       static std::mutex m;
       static std::mt19937_64 gen{seed};
       std::lock_guard<std::mutex> lock{m};
-      std::vector<value_type> ret(size);
-      std::generate(ret.begin(), ret.end(), gen);
-      return ret;
+      // std::ref as std::generate takes the generator by value
+      std::generate(buffer.begin(), buffer.end(), std::ref(gen));
     };
   }
   // end of FIXME
 
 private:
   RandomEngineCB m_gen{createEngine()};
+  uint64_t m_stream_seed{1};
   Property<size_t> m_seed{this, "seed", "Random seed for the internal random engine"};
   Property<size_t> m_cache_size{this, "cacheSize", 1024, "Cache size for each generator instance"};
   std::mutex m_mutex;
@@ -118,6 +118,7 @@ public:
     // Label initialization as complete
     m_init = true;
   }
+  bool initialized() const { return m_init; }
   // Single service init (meant to be called for stragglers after general init)
   template <class Svc> void initSingle() {
     std::string_view name = Svc::kName;
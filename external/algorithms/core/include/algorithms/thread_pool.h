@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Sylvester Joosten
+//
+// Minimal fixed-size thread pool with a single FIFO task queue.
+//
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace algorithms {
+
+class ThreadPool {
+public:
+  using Task = std::function<void()>;
+
+  // nthreads == 0 selects the number of hardware threads
+  explicit ThreadPool(size_t nthreads = 0);
+  ~ThreadPool();
+  ThreadPool(const ThreadPool&) = delete;
+  void operator=(const ThreadPool&) = delete;
+
+  void submit(Task task);
+  // Run f(0), ..., f(n - 1) on the pool and wait for them, the first exception is rethrown.
+  // Not to be called from a task of the same pool (it could wait for itself).
+  void run(size_t n, const std::function<void(size_t)>& f);
+  size_t size() const { return m_workers.size(); }
+
+private:
+  void work();
+
+  std::vector<std::thread> m_workers;
+  std::deque<Task> m_tasks;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  bool m_stop = false;
+};
+
+} // namespace algorithms
@@ -20,13 +20,12 @@ void RandomSvc::init(const RandomEngineCB& gen) {
   }
 }
 RandomEngineCB RandomSvc::createEngine(const size_t seed) {
-  return [=](const size_t size) {
+  return [=](gsl::span<value_type> buffer) {
     static std::mutex m;
     static std::mt19937_64 gen{seed};
     std::lock_guard<std::mutex> lock{m};
-    std::vector<value_type> ret{size};
-    std::generate(ret.begin(), ret.end(), gen);
-    return ret;
+    // std::ref as std::generate takes the generator by value
+    std::generate(buffer.begin(), buffer.end(), std::ref(gen));
   };
 }
 #endif
@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Sylvester Joosten
+
+#include <algorithm>
+#include <exception>
+
+#include <algorithms/thread_pool.h>
+
+namespace algorithms {
+
+ThreadPool::ThreadPool(size_t nthreads) {
+  if (nthreads == 0) {
+    nthreads = std::max(1U, std::thread::hardware_concurrency());
+  }
+  m_workers.reserve(nthreads);
+  for (size_t i = 0; i < nthreads; ++i) {
+    m_workers.emplace_back([this]() { work(); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_stop = true;
+  }
+  m_cv.notify_all();
+  for (auto& w : m_workers) {
+    w.join();
+  }
+}
+
+void ThreadPool::submit(Task task) {
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_tasks.push_back(std::move(task));
+  }
+  m_cv.notify_one();
+}
+
+void ThreadPool::run(const size_t n, const std::function<void(size_t)>& f) {
+  std::mutex mutex;
+  std::condition_variable done;
+  size_t remaining = n;
+  std::exception_ptr error;
+  for (size_t i = 0; i < n; ++i) {
+    submit([&, i]() {
+      std::exception_ptr e;
+      try {
+        f(i);
+      } catch (...) {
+        e = std::current_exception();
+      }
+      std::lock_guard<std::mutex> lock{mutex};
+      if (e && !error) {
+        error = e;
+      }
+      if (--remaining == 0) {
+        done.notify_one();
+      }
+    });
+  }
+  std::unique_lock<std::mutex> lock{mutex};
+  done.wait(lock, [&]() { return remaining == 0; });
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void ThreadPool::work() {
+  while (true) {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock{m_mutex};
+      m_cv.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+      // finish all queued work before stopping
+      if (m_tasks.empty()) {
+        return;
+      }
+      task = std::move(m_tasks.front());
+      m_tasks.pop_front();
+    }
+    task();
+  }
+}
+
+} // namespace algorithms
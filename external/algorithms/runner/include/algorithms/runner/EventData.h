@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Sylvester Joosten
+//
+// Per-event collection store for the standalone runner. Collections read from file are
+// owned by the podio::EventStore that was used to read them, collections produced by the
+// algorithms are owned by the EventData directly.
+//
+// Multiple algorithms of the same event can run concurrently, so lookups and insertions
+// are synchronized. Collections are only inserted once they are complete (after the
+// producing algorithm finished), and are never modified afterwards.
+//
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+#include <podio/CollectionBase.h>
+#include <podio/EventStore.h>
+
+#include <algorithms/detail/demangle.h>
+#include <algorithms/error.h>
+
+namespace algorithms::runner {
+
+class DataError : public Error {
+public:
+  DataError(std::string_view msg) : Error{msg, "algorithms::runner::DataError"} {}
+};
+
+class EventData {
+public:
+  explicit EventData(const size_t entry) : m_entry{entry} {}
+  EventData(const EventData&) = delete;
+  void operator=(const EventData&) = delete;
+
+  size_t entry() const { return m_entry; }
+
+  bool has(std::string_view name) const {
+    std::shared_lock<std::shared_mutex> lock{m_mutex};
+    return m_collections.count(name) != 0;
+  }
+  template <class T> const T* get(std::string_view name) const {
+    const podio::CollectionBase* coll = nullptr;
+    {
+      std::shared_lock<std::shared_mutex> lock{m_mutex};
+      auto it = m_collections.find(name);
+      if (it == m_collections.end()) {
+        throw DataError(fmt::format("Collection {} not available in event {}", name, m_entry));
+      }
+      coll = it->second;
+    }
+    const auto* ret = dynamic_cast<const T*>(coll);
+    if (!ret) {
+      throw DataError(fmt::format("Collection {} in event {} is not of type {}", name, m_entry,
+                                  algorithms::detail::demangledName<T>()));
+    }
+    return ret;
+  }
+
+  // Take ownership of a newly produced collection
+  void put(std::string_view name, std::unique_ptr<podio::CollectionBase> coll) {
+    std::unique_lock<std::shared_mutex> lock{m_mutex};
+    insert(name, coll.get());
+    m_owned.push_back(std::move(coll));
+  }
+  // Register a collection owned by our podio::EventStore (i.e. read from file)
+  void link(std::string_view name, podio::CollectionBase* coll) {
+    std::unique_lock<std::shared_mutex> lock{m_mutex};
+    insert(name, coll);
+  }
+
+  // All collections in this event, by name
+  const std::map<std::string, podio::CollectionBase*, std::less<>>& collections() const {
+    return m_collections;
+  }
+
+  // Store used to read the input collections of this event (owns those collections)
+  podio::EventStore& provider() { return m_provider; }
+
+private:
+  void insert(std::string_view name, podio::CollectionBase* coll) {
+    if (!m_collections.emplace(name, coll).second) {
+      throw DataError(fmt::format("Collection {} already present in event {}", name, m_entry));
+    }
+  }
+
+  const size_t m_entry;
+  podio::EventStore m_provider;
+  std::vector<std::unique_ptr<podio::CollectionBase>> m_owned;
+  std::map<std::string, podio::CollectionBase*, std::less<>> m_collections;
+  mutable std::shared_mutex m_mutex;
+};
+
+} // namespace algorithms::runner
@@ -0,0 +1,240 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Sylvester Joosten
+//
+// Standalone multithreaded event loop for algorithms, without any framework dependency.
+//
+// Algorithms are added with a mapping of their data arguments (the input/output names
+// declared by the algorithm) onto collection names:
+//
+//   runner::EventLoop loop{{/* threads */ 8, /* events in flight */ 16}};
+//   auto& reco = loop.add<calorimetry::ClusterRecoCoG>(
+//       "EcalBarrelClusters", {{"inputProtoClusterCollection", {"EcalBarrelProtoClusters"}}},
+//       {{"outputClusterCollection", {"EcalBarrelClusters"}}});
+//   reco.setProperty("samplingFraction", 0.03);
+//   loop.init();
+//   runner::PodioSource source{{"input.root"}};
+//   loop.run(source);
+//
+// At init() a data-flow graph is built from the collection names. Collections that are
+// not produced by any algorithm are read from the event source. Algorithms only depend
+// on the producers of their inputs, so independent algorithms of the same event run
+// concurrently, as do different events (up to eventsInFlight). Algorithm::process() is
+// const, and algorithms are required to be reentrant.
+//
+// An optional EventSink is called for every event after all algorithms are done, in
+// entry order and never concurrently.
+//
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+#include <podio/CollectionBase.h>
+
+#include <algorithms/algorithm.h>
+#include <algorithms/logger.h>
+#include <algorithms/random.h>
+#include <algorithms/type_traits.h>
+
+#include <algorithms/runner/EventData.h>
+#include <algorithms/runner/EventSource.h>
+
+namespace algorithms::runner {
+
+class ConfigError : public Error {
+public:
+  ConfigError(std::string_view msg) : Error{msg, "algorithms::runner::ConfigError"} {}
+};
+
+namespace detail {
+  using Names = std::vector<std::string>;
+
+  // Check the configured names for a data argument of type T
+  template <class T>
+  void checkNames(std::string_view algo, std::string_view arg, const Names& names) {
+    if constexpr (is_optional_v<T>) {
+      if (names.size() > 1) {
+        throw ConfigError(fmt::format("{}: optional argument {} takes at most one collection",
+                                      algo, arg));
+      }
+    } else if constexpr (!is_vector_v<T>) {
+      if (names.size() != 1) {
+        throw ConfigError(fmt::format("{}: argument {} requires exactly one collection", algo,
+                                      arg));
+      }
+    }
+  }
+
+  // Translate the {argument name --> collection names} map into an array of names for each
+  // argument, in the order of the algorithm signature
+  template <class Data, size_t... I>
+  auto resolveNames(std::string_view algo, const typename Data::key_type& args,
+                    const std::map<std::string, Names>& config, std::index_sequence<I...>) {
+    std::array<Names, Data::kSize> ret;
+    for (const auto& [arg, names] : config) {
+      if (std::find(args.begin(), args.end(), arg) == args.end()) {
+        throw ConfigError(fmt::format("{}: unknown data argument {}", algo, arg));
+      }
+    }
+    ((ret[I] = config.count(args[I]) ? config.at(args[I]) : Names{}), ...);
+    (checkNames<std::tuple_element_t<I, typename Data::data_type>>(algo, args[I], ret[I]), ...);
+    return ret;
+  }
+
+  template <class T> input_type_t<T> getInput(const EventData& event, const Names& names) {
+    using data_type = data_type_t<T>;
+    if constexpr (is_vector_v<T>) {
+      std::vector<gsl::not_null<const data_type*>> ret;
+      for (const auto& name : names) {
+        ret.emplace_back(event.get<data_type>(name));
+      }
+      return ret;
+    } else if constexpr (is_optional_v<T>) {
+      return names.empty() ? nullptr : event.get<data_type>(names[0]);
+    } else {
+      return event.get<data_type>(names[0]);
+    }
+  }
+  template <class Data, size_t... I>
+  typename Data::value_type getInputs(const EventData& event,
+                                      const std::array<Names, Data::kSize>& names,
+                                      std::index_sequence<I...>) {
+    return {getInput<std::tuple_element_t<I, typename Data::data_type>>(event, names[I])...};
+  }
+
+  // Create new output collections. Ownership is transferred to `owned`, in the same order
+  // as the names appear in the output name array.
+  template <class T>
+  output_type_t<T> makeOutput(const Names& names,
+                              std::vector<std::unique_ptr<podio::CollectionBase>>& owned) {
+    using data_type   = data_type_t<T>;
+    const auto create = [&owned]() {
+      auto coll = std::make_unique<data_type>();
+      auto* ptr = coll.get();
+      owned.push_back(std::move(coll));
+      return ptr;
+    };
+    if constexpr (is_vector_v<T>) {
+      std::vector<gsl::not_null<data_type*>> ret;
+      for (size_t i = 0; i < names.size(); ++i) {
+        ret.emplace_back(create());
+      }
+      return ret;
+    } else if constexpr (is_optional_v<T>) {
+      return names.empty() ? nullptr : create();
+    } else {
+      return create();
+    }
+  }
+  template <class Data, size_t... I>
+  typename Data::value_type makeOutputs(const std::array<Names, Data::kSize>& names,
+                                        std::vector<std::unique_ptr<podio::CollectionBase>>& owned,
+                                        std::index_sequence<I...>) {
+    // braced initialization guarantees left-to-right evaluation
+    return {makeOutput<std::tuple_element_t<I, typename Data::data_type>>(names[I], owned)...};
+  }
+
+  template <size_t N> Names flatten(const std::array<Names, N>& names) {
+    Names ret;
+    for (const auto& n : names) {
+      ret.insert(ret.end(), n.begin(), n.end());
+    }
+    return ret;
+  }
+} // namespace detail
+
+struct EventLoopConfig {
+  size_t threads        = 0; // 0: number of hardware threads
+  size_t eventsInFlight = 0; // 0: twice the number of threads
+};
+
+class EventLoop : public LoggerMixin {
+public:
+  using Config    = EventLoopConfig;
+  using DataNames = std::map<std::string, std::vector<std::string>>;
+  using EventSink = std::function<void(const EventData&)>;
+
+  explicit EventLoop(const Config& cfg = {}) : LoggerMixin("EventLoop"), m_config{cfg} {}
+
+  // Add an algorithm of type Algo, returns a reference to the algorithm so it can be
+  // configured before init()
+  template <class Algo>
+  Algo& add(std::string_view name, const DataNames& inputs, const DataNames& outputs) {
+    using input_type  = typename Algo::input_type;
+    using output_type = typename Algo::output_type;
+    if (m_initialized) {
+      raise<ConfigError>("Cannot add algorithms after init()");
+    }
+
+    auto algo       = std::make_shared<Algo>(name);
+    const auto in   = detail::resolveNames<input_type>(
+        name, algo->inputNames(), inputs, std::make_index_sequence<input_type::kSize>());
+    const auto out  = detail::resolveNames<output_type>(
+        name, algo->outputNames(), outputs, std::make_index_sequence<output_type::kSize>());
+    const auto outs = detail::flatten(out);
+
+    Node node;
+    node.name    = name;
+    node.inputs  = detail::flatten(in);
+    node.outputs = outs;
+    node.init    = [algo]() {
+      algo->validate();
+      algo->init();
+    };
+    node.execute = [algo = algo.get(), in, out, outs](EventData& event) {
+      const auto input = detail::getInputs<input_type>(
+          event, in, std::make_index_sequence<input_type::kSize>());
+      std::vector<std::unique_ptr<podio::CollectionBase>> owned;
+      const auto output = detail::makeOutputs<output_type>(
+          out, owned, std::make_index_sequence<output_type::kSize>());
+      algo->process(input, output);
+      // only publish the outputs once they are complete
+      for (size_t i = 0; i < owned.size(); ++i) {
+        event.put(outs[i], std::move(owned[i]));
+      }
+    };
+    node.algo = algo;
+    m_nodes.push_back(std::move(node));
+    return *algo;
+  }
+
+  // Initialize the services and algorithms, and build the data-flow graph
+  void init();
+
+  // Process nevents entries starting at firstEntry (nevents == 0: all remaining entries)
+  void run(EventSource& source, size_t nevents = 0, size_t firstEntry = 0,
+           const EventSink& sink = {});
+
+  // Collections that need to be provided by the event source
+  const std::vector<std::string>& externalInputs() const { return m_externalInputs; }
+
+private:
+  struct Node {
+    std::string name;
+    std::vector<std::string> inputs;
+    std::vector<std::string> outputs;
+    std::function<void()> init;
+    std::function<void(EventData&)> execute;
+    std::shared_ptr<void> algo; // keeps the algorithm alive
+    // filled in by init()
+    std::vector<size_t> consumers;
+    size_t nProducers = 0;
+  };
+  struct EventState;
+
+  const Config m_config;
+  std::vector<Node> m_nodes;
+  std::vector<std::string> m_externalInputs;
+  bool m_initialized = false;
+};
+
+} // namespace algorithms::runner
@@ -0,0 +1,40 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Sylvester Joosten
+//
+// Event sources for the standalone runner. Sources are only ever called from the thread
+// driving the event loop, so they do not need to be thread-safe.
+//
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <podio/ROOTReader.h>
+
+#include <algorithms/runner/EventData.h>
+
+namespace algorithms::runner {
+
+class EventSource {
+public:
+  virtual ~EventSource() = default;
+  // Total number of entries available
+  virtual size_t entries() const = 0;
+  // Read the requested collections for event.entry() into the event
+  virtual void read(EventData& event, const std::vector<std::string>& names) = 0;
+};
+
+// Source reading collections from podio ROOT files
+class PodioSource : public EventSource {
+public:
+  explicit PodioSource(const std::vector<std::string>& files);
+
+  size_t entries() const final { return m_entries; }
+  void read(EventData& event, const std::vector<std::string>& names) final;
+
+private:
+  podio::ROOTReader m_reader;
+  size_t m_entries;
+};
+
+} // namespace algorithms::runner
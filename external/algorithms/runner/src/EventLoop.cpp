@@ -0,0 +1,225 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Sylvester Joosten
+
+#include <algorithms/runner/EventLoop.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <set>
+
+#include <algorithms/service.h>
+#include <algorithms/thread_pool.h>
+
+namespace algorithms::runner {
+
+// Book-keeping for an event in flight
+struct EventLoop::EventState {
+  EventState(const size_t entry, const std::vector<Node>& nodes)
+      : data{entry}, pending(nodes.size()), remaining{nodes.size()} {
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      pending[i] = nodes[i].nProducers;
+    }
+  }
+  EventData data;
+  // number of producers each algorithm is still waiting for
+  std::vector<std::atomic<size_t>> pending;
+  // number of algorithms that still need to finish
+  std::atomic<size_t> remaining;
+  bool complete = false;
+};
+
+void EventLoop::init() {
+  if (m_initialized) {
+    return;
+  }
+  info("Initializing {} algorithms", m_nodes.size());
+
+  // Services first, as the algorithms may need them during their own init(). Custom
+  // service initializers (e.g. for the GeoSvc) need to be set before this point.
+  if (!ServiceSvc::instance().initialized()) {
+    ServiceSvc::instance().init();
+  }
+
+  // Build the data-flow graph: every collection has at most one producer, everything
+  // that is not produced by an algorithm comes from the event source
+  std::map<std::string, size_t> producers;
+  for (size_t i = 0; i < m_nodes.size(); ++i) {
+    for (const auto& name : m_nodes[i].outputs) {
+      if (!producers.emplace(name, i).second) {
+        raise<ConfigError>(fmt::format("Collection {} produced by both {} and {}", name,
+                                       m_nodes[producers.at(name)].name, m_nodes[i].name));
+      }
+    }
+  }
+  std::set<std::string> external;
+  for (size_t i = 0; i < m_nodes.size(); ++i) {
+    std::set<size_t> deps;
+    for (const auto& name : m_nodes[i].inputs) {
+      const auto it = producers.find(name);
+      if (it == producers.end()) {
+        external.insert(name);
+      } else {
+        deps.insert(it->second);
+      }
+    }
+    for (const auto p : deps) {
+      m_nodes[p].consumers.push_back(i);
+    }
+    m_nodes[i].nProducers = deps.size();
+  }
+  m_externalInputs.assign(external.begin(), external.end());
+
+  // Make sure the graph has no cycles (Kahn's algorithm)
+  std::vector<size_t> pending(m_nodes.size());
+  std::vector<size_t> ready;
+  for (size_t i = 0; i < m_nodes.size(); ++i) {
+    pending[i] = m_nodes[i].nProducers;
+    if (pending[i] == 0) {
+      ready.push_back(i);
+    }
+  }
+  size_t nsorted = 0;
+  while (!ready.empty()) {
+    const size_t i = ready.back();
+    ready.pop_back();
+    ++nsorted;
+    for (const auto c : m_nodes[i].consumers) {
+      if (--pending[c] == 0) {
+        ready.push_back(c);
+      }
+    }
+  }
+  if (nsorted != m_nodes.size()) {
+    raise<ConfigError>("Data-flow graph contains a cycle");
+  }
+
+  for (const auto& node : m_nodes) {
+    debug("Initializing {} ({} inputs, {} outputs, {} consumers)", node.name, node.inputs.size(),
+          node.outputs.size(), node.consumers.size());
+    node.init();
+  }
+  info("Event source needs to provide {} collections: {}", m_externalInputs.size(),
+       fmt::join(m_externalInputs, ", "));
+  m_initialized = true;
+}
+
+void EventLoop::run(EventSource& source, size_t nevents, size_t firstEntry,
+                    const EventSink& sink) {
+  if (!m_initialized) {
+    raise<ConfigError>("EventLoop::run() called before init()");
+  }
+  const size_t available = source.entries() > firstEntry ? source.entries() - firstEntry : 0;
+  const size_t lastEntry =
+      firstEntry + ((nevents == 0) ? available : std::min(nevents, available));
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::map<size_t, std::unique_ptr<EventState>> active;
+  size_t inFlight = 0;
+  size_t nextOut  = firstEntry;
+  std::exception_ptr error;
+  std::atomic<bool> failed{false};
+
+  const auto fail = [&]() {
+    std::lock_guard<std::mutex> lock{mutex};
+    if (!error) {
+      error = std::current_exception();
+    }
+    failed = true;
+  };
+  // Mark an event as done, and hand all finished events to the sink in entry order
+  const auto finish = [&](EventState* state) {
+    std::lock_guard<std::mutex> lock{mutex};
+    state->complete = true;
+    for (auto it = active.find(nextOut); it != active.end() && it->second->complete;
+         it = active.find(nextOut)) {
+      if (sink && !failed) {
+        try {
+          sink(it->second->data);
+        } catch (...) {
+          if (!error) {
+            error = std::current_exception();
+          }
+          failed = true;
+        }
+      }
+      active.erase(it);
+      ++nextOut;
+      --inFlight;
+    }
+    cv.notify_all();
+  };
+
+  // Declared after the shared state, so the workers are joined before it goes out of scope
+  ThreadPool pool{m_config.threads};
+  const size_t maxInFlight = m_config.eventsInFlight ? m_config.eventsInFlight : 2 * pool.size();
+  info("Processing {} events on {} threads ({} events in flight)", lastEntry - firstEntry,
+       pool.size(), maxInFlight);
+
+  // Run algorithm i for an event, and schedule all consumers that became ready
+  std::function<void(EventState*, size_t)> schedule = [&](EventState* state, const size_t i) {
+    pool.submit([&, state, i]() {
+      if (!failed) {
+        try {
+          RandomSvc::context({0, state->data.entry()});
+          m_nodes[i].execute(state->data);
+        } catch (...) {
+          fail();
+        }
+      }
+      // keep going on failure, so the event still drains properly
+      for (const auto c : m_nodes[i].consumers) {
+        if (--state->pending[c] == 0) {
+          schedule(state, c);
+        }
+      }
+      if (--state->remaining == 0) {
+        finish(state);
+      }
+    });
+  };
+
+  for (size_t entry = firstEntry; entry < lastEntry && !failed; ++entry) {
+    {
+      std::unique_lock<std::mutex> lock{mutex};
+      cv.wait(lock, [&]() { return inFlight < maxInFlight; });
+      ++inFlight;
+    }
+    auto state = std::make_unique<EventState>(entry, m_nodes);
+    try {
+      // reading is serial, processing is not
+      source.read(state->data, m_externalInputs);
+    } catch (...) {
+      fail();
+      std::lock_guard<std::mutex> lock{mutex};
+      --inFlight;
+      break;
+    }
+    EventState* ptr = state.get();
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+      active.emplace(entry, std::move(state));
+    }
+    if (m_nodes.empty()) {
+      finish(ptr);
+    }
+    for (size_t i = 0; i < m_nodes.size(); ++i) {
+      if (m_nodes[i].nProducers == 0) {
+        schedule(ptr, i);
+      }
+    }
+  }
+  {
+    std::unique_lock<std::mutex> lock{mutex};
+    cv.wait(lock, [&]() { return inFlight == 0; });
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  info("Processed {} events", nextOut - firstEntry);
+}
+
+} // namespace algorithms::runner
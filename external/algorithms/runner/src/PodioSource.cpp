@@ -0,0 +1,40 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2022 Sylvester Joosten
+
+#include <algorithms/runner/EventSource.h>
+
+#include <fmt/format.h>
+
+namespace algorithms::runner {
+
+PodioSource::PodioSource(const std::vector<std::string>& files) {
+  m_reader.openFiles(files);
+  m_entries = m_reader.getEntries();
+}
+
+// Collections are read through a podio::EventStore that is private to the event, so the
+// event owns its input collections and several events can be processed at the same time.
+// References to other collections are resolved while reading, so the event does not
+// need the reader afterwards.
+void PodioSource::read(EventData& event, const std::vector<std::string>& names) {
+  m_reader.goToEvent(event.entry());
+  auto& provider = event.provider();
+  provider.setReader(&m_reader);
+  const auto ids = m_reader.getCollectionIDTable();
+  for (const auto& name : names) {
+    if (!ids->present(name)) {
+      throw DataError(fmt::format("Collection {} not found in input", name));
+    }
+    podio::CollectionBase* coll = nullptr;
+    if (!provider.get(ids->collectionID(name), coll) || !coll) {
+      throw DataError(fmt::format("Unable to read collection {} for event {}", name,
+                                  event.entry()));
+    }
+    if (!coll->isSubsetCollection()) {
+      coll->prepareAfterRead();
+    }
+    event.link(name, coll);
+  }
+}
+
+} // namespace algorithms::runner
@@ -4,6 +4,7 @@
 #include <algorithms/truth/MC2SmearedParticle.h>
 
 #include <cmath>
+#include <vector>
 #include <edm4eic/vector_utils.h>
 
 namespace algorithms::truth {
@@ -17,7 +18,13 @@ void MC2SmearedParticle::process(const MC2SmearedParticle::Input& input,
   const auto [parts] = input;
   auto [out_parts]   = output;
 
+  // draw the smearing factors for all particles at once
+  std::vector<double> smearing(parts->size());
+  m_rng.stream().fill_gaussian<double>(smearing, 1., m_smearing);
+
+  size_t ipart = 0;
   for (const auto& p : *parts) {
+    const double smear = smearing[ipart++];
     if (p.getGeneratorStatus() > 1) {
       if (aboveDebugThreshold()) {
         debug() << "ignoring particle with generatorStatus = " << p.getGeneratorStatus() << endmsg;
@@ -30,7 +37,7 @@ void MC2SmearedParticle::process(const MC2SmearedParticle::Input& input,
     // for now.
     const auto pvec     = p.getMomentum();
     const auto pgen     = std::hypot(pvec.x, pvec.y, pvec.z);
-    const auto momentum = pgen * m_rng.gaussian<double>(0., m_smearing);
+    const auto momentum = pgen * smear;
     // make sure we keep energy consistent
     using MomType = decltype(edm4eic::ReconstructedParticle().getMomentum().x);
     const MomType energy =